@@ -0,0 +1,149 @@
+/** @file ai.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief computer opponent that plays the other half of the court in single player mode
+ */
+
+
+#include "ai.h"
+#include "progmem.h"
+#include "landing_table.h"
+
+#define AIM_MISS 3 //columns the AI is off by when it errs
+#define SERVE_DELAY 250 //ticks the AI gives the player to serve first
+#define RANDOM_SEED 0xACE1
+
+
+/** Per-level behaviour, ticks are pacer ticks */
+typedef struct {
+    uint8_t reaction; //ticks before the paddle starts moving
+    uint8_t move_interval; //ticks between paddle moves
+    uint8_t error; //chance out of 256 of heading for the wrong column
+} AiLevel;
+
+
+static const AiLevel levels[] PROGMEM = {
+    {120, 50, 77}, //AI_EASY
+    {60, 30, 38}, //AI_NORMAL
+    {20, 15, 13} //AI_HARD
+};
+
+
+/** Return the next value of the xorshift generator:
+    @param ai pointer to ai struct */
+static uint16_t next_random (Ai* ai)
+{
+    uint16_t x = ai->random;
+    x ^= x << 7;
+    x ^= x >> 9;
+    x ^= x << 8;
+    ai->random = x;
+    return x;
+}
+
+
+/** Initialise the AI:
+    @param ai pointer to struct being initialised
+    @param level one of AI_EASY, AI_NORMAL or AI_HARD */
+void ai_init (Ai* ai, uint8_t level)
+{
+    paddle_init(&ai->paddle);
+    ball_init(&ai->ball, 0, HEIGHT, STRAIGHT, UP, OFF_SCREEN);
+    ai->target = ai->paddle.pos;
+    ai->reaction = 0;
+    ai->move_counter = 0;
+    ai->serve_counter = 0;
+    ai->level = level;
+    ai->random = RANDOM_SEED;
+}
+
+
+/** Advance the random generator, called every tick of the start menu so the
+    player's timing seeds the AI:
+    @param ai pointer to ai struct */
+void ai_stir (Ai* ai)
+{
+    next_random(ai);
+}
+
+
+/** Take the ball as it leaves the player's screen, in place of transmit_ball:
+    @param ai pointer to ai struct
+    @param ball the player's ball, just gone off screen or dead */
+void ai_receive (Ai* ai, Ball* ball)
+{
+    AiLevel level;
+    flash_read_block(&level, &levels[ai->level], sizeof(level));
+    if (ball->dead) {
+        return;
+    }
+    // mirrored exactly as transmit_ball and receive_ball do between two kits
+    ball_init(&ai->ball, RIGHT_WALL - ball->x, HEIGHT - 1, -ball->direction_x, DOWN, ON_SCREEN);
+    ball_set_speed(&ai->ball, ball->speed);
+
+    int8_t target = landing_table_read(LANDING_TABLE_INDEX(ai->ball.x, ai->ball.direction_x));
+    if ((uint8_t) next_random(ai) < level.error) {
+        target += target > RIGHT_WALL / 2 ? -AIM_MISS : AIM_MISS;
+    } else {
+        target += (int8_t) (next_random(ai) % PADDLE_WIDTH) - 1; //meet it with any part of the paddle
+    }
+    if (target < PADDLE_LIMIT_LEFT) {
+        target = PADDLE_LIMIT_LEFT;
+    } else if (target > PADDLE_LIMIT_RIGHT) {
+        target = PADDLE_LIMIT_RIGHT;
+    }
+    ai->target = target;
+    ai->reaction = level.reaction;
+    ai->move_counter = 0;
+    ai->serve_counter = 0;
+}
+
+
+/** Play one tick on the AI's half, in place of receive_ball. When the AI's
+    ball comes back or dies, the player's ball is set up as receive_ball would:
+    @param ai pointer to ai struct
+    @param ball the player's ball, off screen */
+void ai_update (Ai* ai, Ball* ball)
+{
+    if (ai->reaction) {
+        ai->reaction--;
+    } else if (++ai->move_counter >= flash_read_byte(&levels[ai->level].move_interval)) {
+        ai->move_counter = 0;
+        if (ai->paddle.pos < ai->target) {
+            paddle_move_right(&ai->paddle);
+        } else if (ai->paddle.pos > ai->target) {
+            paddle_move_left(&ai->paddle);
+        }
+    }
+
+    if (!ai->ball.on_screen || !ball_tick(&ai->ball)) {
+        return;
+    }
+    update_location(&ai->ball, ai->paddle.pos);
+    if (ai->ball.dead) {
+        ball->dead = DEAD;
+    } else if (!ai->ball.on_screen) {
+        ball->x = RIGHT_WALL - ai->ball.x;
+        ball->direction_x = -ai->ball.direction_x;
+        ball->y = HEIGHT - 1;
+        ball->direction_y = DOWN;
+        ball->on_screen = ON_SCREEN;
+        ball_set_speed(ball, ai->ball.speed);
+    }
+}
+
+
+/** Count a tick waiting for a round to start:
+    @param ai pointer to ai struct
+    @return 1 if the AI has served, in which case the round begins with the ball on its half */
+uint8_t ai_serve (Ai* ai)
+{
+    if (++ai->serve_counter < SERVE_DELAY) {
+        return 0;
+    }
+    ai->serve_counter = 0;
+    ball_init(&ai->ball, ai->paddle.pos, GROUND + 1, STRAIGHT, UP, ON_SCREEN);
+    ai->reaction = 0;
+    ai->target = ai->paddle.pos;
+    return 1;
+}
@@ -0,0 +1,72 @@
+/** @file ai.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief computer opponent that plays the other half of the court in single player mode
+ */
+
+
+#ifndef AI_H
+#define AI_H
+
+#include "system.h"
+#include "ball.h"
+#include "paddle.h"
+
+#define AI_EASY 0
+#define AI_NORMAL 1
+#define AI_HARD 2
+
+#ifndef AI_LEVEL
+#define AI_LEVEL AI_NORMAL //difficulty used when single player is chosen from the start menu
+#endif
+
+
+/** Define data associated with the computer opponent */
+typedef struct ai_s Ai;
+
+
+/** Ai structure*/
+struct ai_s {
+    Ball ball; //the ball while it is on the AI's half, in the AI's own coordinates
+    Paddle paddle;
+    uint8_t target; //column the paddle is heading for
+    uint8_t reaction; //ticks left before the AI starts moving after the ball arrives
+    uint8_t move_counter; //ticks since the paddle last moved
+    uint8_t serve_counter; //ticks waited for the player to serve
+    uint8_t level;
+    uint16_t random; //xorshift state
+};
+
+
+/** Initialise the AI:
+    @param ai pointer to struct being initialised
+    @param level one of AI_EASY, AI_NORMAL or AI_HARD */
+void ai_init (Ai* ai, uint8_t level);
+
+
+/** Advance the random generator, called every tick of the start menu so the
+    player's timing seeds the AI:
+    @param ai pointer to ai struct */
+void ai_stir (Ai* ai);
+
+
+/** Take the ball as it leaves the player's screen, in place of transmit_ball:
+    @param ai pointer to ai struct
+    @param ball the player's ball, just gone off screen or dead */
+void ai_receive (Ai* ai, Ball* ball);
+
+
+/** Play one tick on the AI's half, in place of receive_ball. When the AI's
+    ball comes back or dies, the player's ball is set up as receive_ball would:
+    @param ai pointer to ai struct
+    @param ball the player's ball, off screen */
+void ai_update (Ai* ai, Ball* ball);
+
+
+/** Count a tick waiting for a round to start:
+    @param ai pointer to ai struct
+    @return 1 if the AI has served, in which case the round begins with the ball on its half */
+uint8_t ai_serve (Ai* ai);
+
+
+#endif
@@ -7,8 +7,50 @@
 
 
 #include "ball.h"
+#ifdef BALL_TABLE
+#include "ball_table.h"
+#endif
 
+#define MIN_PERIOD ((uint16_t) BALL_MIN_RATE << BALL_FRACTION_BITS)
 
+
+/** Work out the step period one speed level faster, no shorter than the cap. Worst
+    case is one 32 bit multiply, around 60 cycles on the AVR:
+    @param period Q8.8 step period now
+    @return the faster period*/
+uint16_t ball_faster_period (uint16_t period)
+{
+    period -= (uint32_t) period * BALL_ACCEL >> BALL_FRACTION_BITS;
+    return period < MIN_PERIOD ? MIN_PERIOD : period;
+}
+
+
+/** Work out the step period of a speed level, walking up from serve speed so both kits
+    land on exactly the same period:
+    @param speed speed level, as carried in a handoff frame
+    @return Q8.8 step period*/
+uint16_t ball_speed_period (uint8_t speed)
+{
+    uint16_t period = BALL_SERVE_PERIOD;
+    for (uint8_t i = 0; i < speed && i < BALL_SPEED_MAX; i++) {
+        period = ball_faster_period(period);
+    }
+    return period;
+}
+
+
+/** Move ball one speed level faster, unless it is already at the cap:
+    @param ball pointer to ball struct */
+static void speed_up (Ball* ball)
+{
+    if (ball->speed < BALL_SPEED_MAX) {
+        ball->speed++;
+        ball->period = ball_faster_period(ball->period);
+    }
+}
+
+
+#ifndef BALL_TABLE
 /** Return true if ball has hit the paddle:
     @param ball pointer to ball struct 
     @param paddle x coordinate of centre of paddle
@@ -94,6 +136,7 @@ static void update_y (Ball* ball, uint8_t hit_paddle)
         ball->y += ball->direction_y;
     }
 }
+#endif
 
 
 /** Initialise ball structure:
@@ -111,10 +154,59 @@ void ball_init (Ball* ball, uint8_t x, uint8_t y, int8_t x_dir, int8_t y_dir, ui
     ball->direction_y = y_dir;
     ball->on_screen = on_screen;
     ball->dead = ALIVE; //set ball to not be dead initially
+    ball->speed = 0;
+    ball->period = BALL_SERVE_PERIOD;
+    ball->timer = 0;
 }
 
 
-/** Update location of ball:
+/** Set the speed of a ball handed over from another kit, restarting its step timer:
+    @param ball pointer to ball struct
+    @param speed speed level, as carried in the handoff frame*/
+void ball_set_speed (Ball* ball, uint8_t speed)
+{
+    ball->speed = speed < BALL_SPEED_MAX ? speed : BALL_SPEED_MAX;
+    ball->period = ball_speed_period(ball->speed);
+    ball->timer = 0;
+}
+
+
+/** Count one pacer tick of the ball's step timer. The fraction left over after
+    a step carries into the next, so periods between whole ticks average out:
+    @param ball pointer to ball struct
+    @return 1 if the ball is due to step this tick, else 0*/
+uint8_t ball_tick (Ball* ball)
+{
+    ball->timer += 1 << BALL_FRACTION_BITS;
+    if (ball->timer < ball->period) {
+        return 0;
+    }
+    ball->timer -= ball->period;
+    return 1;
+}
+
+
+#ifdef BALL_TABLE
+/** Update location of ball with a single lookup in the precomputed table:
+    @param ball pointer to ball struct, on screen and alive
+    @param paddle x coordinate of centre of paddle*/
+void update_location (Ball* ball, uint8_t paddle)
+{
+    uint16_t next = ball_table_read(BALL_TABLE_INDEX(ball, paddle));
+    uint8_t falling = ball->direction_y == DOWN;
+    ball->x = next >> BALL_TABLE_X_SHIFT & BALL_TABLE_FIELD_MASK;
+    ball->y = next >> BALL_TABLE_Y_SHIFT & BALL_TABLE_FIELD_MASK;
+    ball->direction_x = (int8_t) (next >> BALL_TABLE_DX_SHIFT & BALL_TABLE_DX_MASK) - 1;
+    ball->direction_y = next >> BALL_TABLE_UP_SHIFT & 1 ? UP : DOWN;
+    ball->dead = next >> BALL_TABLE_DEAD_SHIFT & 1;
+    ball->on_screen = ball->y < HEIGHT;
+    if (falling && ball->direction_y == UP) {
+        //only the paddle turns a ball back up
+        speed_up(ball);
+    }
+}
+#else
+/** Update location of ball, speeding it up if it hits the paddle:
     @param ball pointer to ball struct 
     @param paddle x coordinate of centre of paddle*/
 void update_location (Ball* ball, uint8_t paddle)
@@ -122,10 +214,14 @@ void update_location (Ball* ball, uint8_t paddle)
     uint8_t hit_paddle = has_hit_paddle(ball, paddle);
     update_x(ball, hit_paddle, paddle);
     update_y(ball, hit_paddle);
+    if (hit_paddle) {
+        speed_up(ball);
+    }
     if (has_gone_off_screen(ball)) {
         ball->on_screen = OFF_SCREEN;
     }
 }
+#endif
 
 
 /** Return bitmap array representing both ball and paddle:
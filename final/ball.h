@@ -10,6 +10,7 @@
 #define BALL_H
 
 #include "system.h"
+#include "timing.h"
 
 #define LEFT_WALL 0
 #define RIGHT_WALL 6
@@ -26,6 +27,15 @@
 #define OFF_SCREEN 0
 #define PADDLE_COL 4
 #define BLANK 0x00
+#ifndef BALL_ACCEL
+#define BALL_ACCEL 16 //step period shrinks by BALL_ACCEL/256 on every paddle hit, 6.25%
+#endif
+#ifndef BALL_MIN_RATE
+#define BALL_MIN_RATE 40 //speed cap: fewest pacer ticks between steps
+#endif
+#define BALL_SPEED_MAX 15 //speed levels are sent in one symbol
+#define BALL_FRACTION_BITS 8 //step periods and timers are Q8.8 pacer ticks
+#define BALL_SERVE_PERIOD ((uint16_t) (BALL_RATE + 1) << BALL_FRACTION_BITS) //steps on the tick after BALL_RATE, as the old tick counter did
 
 
 /** Define data associated with ball */
@@ -40,6 +50,9 @@ struct ball_s {
     int8_t direction_y; //1 for up, -1 for down
     uint8_t on_screen; //1 if on screen, 0 if on opponent's screen
     uint8_t dead; //1 if game lost, 0 if still in play
+    uint8_t speed; //paddle hits this rally, up to BALL_SPEED_MAX
+    uint16_t period; //Q8.8 pacer ticks per step at this speed
+    uint16_t timer; //Q8.8 pacer ticks since the last step
 };
 
 
@@ -53,7 +66,34 @@ struct ball_s {
 void ball_init (Ball* ball, uint8_t x, uint8_t y, int8_t x_dir, int8_t y_dir, uint8_t on_screen);
 
 
-/** Update location of ball:
+/** Work out the step period one speed level faster, no shorter than the cap. Worst
+    case is one 32 bit multiply, around 60 cycles on the AVR:
+    @param period Q8.8 step period now
+    @return the faster period*/
+uint16_t ball_faster_period (uint16_t period);
+
+
+/** Work out the step period of a speed level, walking up from serve speed so both kits
+    land on exactly the same period:
+    @param speed speed level, as carried in a handoff frame
+    @return Q8.8 step period*/
+uint16_t ball_speed_period (uint8_t speed);
+
+
+/** Set the speed of a ball handed over from another kit, restarting its step timer:
+    @param ball pointer to ball struct
+    @param speed speed level, as carried in the handoff frame*/
+void ball_set_speed (Ball* ball, uint8_t speed);
+
+
+/** Count one pacer tick of the ball's step timer. Costs one 16 bit add and
+    compare, plus a 16 bit subtract on a step:
+    @param ball pointer to ball struct
+    @return 1 if the ball is due to step this tick, else 0*/
+uint8_t ball_tick (Ball* ball);
+
+
+/** Update location of ball, speeding it up if it hits the paddle:
     @param ball pointer to struct being initialised
     @param paddle x coordinate of centre of paddle*/
 void update_location (Ball* ball, uint8_t paddle);
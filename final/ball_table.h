@@ -0,0 +1,51 @@
+/** @file ball_table.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief precomputed next-state table for update_location, stored in flash
+ */
+
+
+#ifndef BALL_TABLE_H
+#define BALL_TABLE_H
+
+#include "system.h"
+#include "ball.h"
+#include "progmem.h"
+
+#define ball_table_read(index) flash_read_word(&ball_table[index])
+
+#define BALL_TABLE_COLUMNS (RIGHT_WALL + 1)
+#define BALL_TABLE_PADDLES (RIGHT_WALL + 3) //paddle 0 to RIGHT_WALL + 1, then one entry for out of reach
+#define BALL_TABLE_DIRECTIONS 6 //three x directions times two y directions
+#define BALL_TABLE_SIZE (BALL_TABLE_PADDLES * HEIGHT * BALL_TABLE_COLUMNS * BALL_TABLE_DIRECTIONS)
+
+// fields of a table entry
+#define BALL_TABLE_X_SHIFT 0
+#define BALL_TABLE_Y_SHIFT 3
+#define BALL_TABLE_DX_SHIFT 6 //direction_x + 1
+#define BALL_TABLE_UP_SHIFT 8 //1 if direction_y is UP
+#define BALL_TABLE_DEAD_SHIFT 9
+#define BALL_TABLE_FIELD_MASK 7
+#define BALL_TABLE_DX_MASK 3
+
+
+/* The table holds the ball after one update_location for every ball on screen
+ * and alive (x 0-6, y 0-4, three x and two y directions) and every paddle
+ * position. Paddles beyond RIGHT_WALL + 1 cannot touch any column, so they
+ * share the last entry. A ball whose y reaches HEIGHT has gone off screen.
+ * ball_table.c is generated from the branching update_location by
+ * sim/ball_table_gen and sim/ball_table_check proves the two agree on every
+ * input in that domain. */
+
+
+/** Index of the entry for a ball and paddle position */
+#define BALL_TABLE_INDEX(ball, paddle) \
+    (((((paddle) < BALL_TABLE_PADDLES - 1 ? (paddle) : BALL_TABLE_PADDLES - 1) * HEIGHT + (ball)->y) \
+      * BALL_TABLE_COLUMNS + (ball)->x) * BALL_TABLE_DIRECTIONS \
+     + ((ball)->direction_x + 1) * 2 + ((ball)->direction_y == UP))
+
+
+extern const uint16_t ball_table[BALL_TABLE_SIZE] PROGMEM;
+
+
+#endif
@@ -0,0 +1,182 @@
+/** @file balls.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief multi-ball mode: several balls kept as parallel arrays, each on its own step timer
+ */
+
+
+#include "balls.h"
+#include "progmem.h"
+
+#define LAUNCH_SPREAD 3 //balls served per row, one in each x direction
+
+
+// LED column bit for each x coordinate, as get_bitmap computes it
+static const uint8_t column_masks[RIGHT_WALL + 1] PROGMEM = {
+    1 << (RIGHT_WALL - 0), 1 << (RIGHT_WALL - 1), 1 << (RIGHT_WALL - 2), 1 << (RIGHT_WALL - 3),
+    1 << (RIGHT_WALL - 4), 1 << (RIGHT_WALL - 5), 1 << (RIGHT_WALL - 6)
+};
+
+// x direction of each ball served in a row: straight first, then left and right
+static const int8_t launch_directions[LAUNCH_SPREAD] PROGMEM = {STRAIGHT, LEFT, RIGHT};
+
+
+/** Initialise a set of balls, all on the opponent's screen:
+    @param balls pointer to struct being initialised
+    @param count number of balls in play, at most BALLS_MAX */
+void balls_init (Balls* balls, uint8_t count)
+{
+    balls->count = count;
+    balls->on_screen = 0;
+    balls->dead = 0;
+}
+
+
+/** Serve every ball from the paddle, spread across directions and rows so no two follow the same path:
+    @param balls pointer to balls struct
+    @param paddle x coordinate of centre of paddle */
+void balls_launch (Balls* balls, uint8_t paddle)
+{
+    for (uint8_t i = 0; i < balls->count; i++) {
+        balls->x[i] = paddle;
+        balls->y[i] = GROUND + 1 + i / LAUNCH_SPREAD;
+        balls->direction_x[i] = (int8_t) flash_read_byte(&launch_directions[i % LAUNCH_SPREAD]);
+        balls->direction_y[i] = UP;
+        balls->speed[i] = 0;
+        balls->period[i] = BALL_SERVE_PERIOD;
+        balls->timer[i] = 0;
+    }
+    balls->on_screen = (1 << balls->count) - 1;
+    balls->dead = 0;
+}
+
+
+/** Count one pacer tick of the step timer of every ball on screen, as ball_tick does
+    for one. Costs a 16 bit add and compare per ball, plus a subtract for each due:
+    @param balls pointer to balls struct
+    @return mask of the balls due to step this tick */
+uint8_t balls_tick (Balls* balls)
+{
+    uint8_t due = 0;
+    for (uint8_t i = 0; i < balls->count; i++) {
+        uint8_t bit = 1 << i;
+        if (!(balls->on_screen & bit)) {
+            continue;
+        }
+        balls->timer[i] += 1 << BALL_FRACTION_BITS;
+        if (balls->timer[i] >= balls->period[i]) {
+            balls->timer[i] -= balls->period[i];
+            due |= bit;
+        }
+    }
+    return due;
+}
+
+
+/** Move the given balls one step, with the same rules as update_location, speeding
+    up each one that hits the paddle:
+    @param balls pointer to balls struct
+    @param paddle x coordinate of centre of paddle
+    @param due mask of the balls to move, those on screen whose timers ran out
+    @return mask of the balls that went off screen this step */
+uint8_t balls_step (Balls* balls, uint8_t paddle, uint8_t due)
+{
+    uint8_t leaving = 0;
+    for (uint8_t i = 0; i < balls->count; i++) {
+        uint8_t bit = 1 << i;
+        if (!(due & balls->on_screen & bit)) {
+            continue;
+        }
+        uint8_t x = balls->x[i];
+        uint8_t y = balls->y[i];
+        int8_t direction_x = balls->direction_x[i];
+        int8_t direction_y = balls->direction_y[i];
+        uint8_t hit_paddle = y == GROUND + 1 && direction_y == DOWN
+                             && (x == paddle || x - 1 == paddle || x + 1 == paddle);
+
+        if (x == LEFT_WALL && direction_x == LEFT) {
+            direction_x = RIGHT;
+            x++;
+        } else if (x == RIGHT_WALL && direction_x == RIGHT) {
+            direction_x = LEFT;
+            x--;
+        } else if (hit_paddle) {
+            //bounce off the left, centre or right of the paddle
+            direction_x = STRAIGHT;
+            if (x == paddle - 1 && x != LEFT_WALL) {
+                x--;
+                direction_x = LEFT;
+            } else if (x != paddle && x != RIGHT_WALL) {
+                x++;
+                direction_x = RIGHT;
+            }
+        } else {
+            x += direction_x;
+        }
+
+        if (y == GROUND && direction_y == DOWN) {
+            balls->dead |= bit;
+        } else if (hit_paddle) {
+            y++;
+            direction_y = UP;
+            if (balls->speed[i] < BALL_SPEED_MAX) {
+                balls->speed[i]++;
+                balls->period[i] = ball_faster_period(balls->period[i]);
+            }
+        } else {
+            y += direction_y;
+        }
+
+        balls->x[i] = x;
+        balls->y[i] = y;
+        balls->direction_x[i] = direction_x;
+        balls->direction_y[i] = direction_y;
+        if (y >= HEIGHT) {
+            balls->on_screen &= ~bit;
+            leaving |= bit;
+        }
+    }
+    return leaving;
+}
+
+
+/** Place a ball arriving from the opponent in a free slot, its step timer restarted:
+    @param balls pointer to balls struct
+    @param x x coordinate it enters at
+    @param direction_x its horizontal direction
+    @param speed its speed level, as carried in the frame */
+void balls_receive (Balls* balls, uint8_t x, int8_t direction_x, uint8_t speed)
+{
+    for (uint8_t i = 0; i < balls->count; i++) {
+        uint8_t bit = 1 << i;
+        if (!(balls->on_screen & bit)) {
+            balls->x[i] = x;
+            balls->y[i] = HEIGHT - 1;
+            balls->direction_x[i] = direction_x;
+            balls->direction_y[i] = DOWN;
+            balls->speed[i] = speed < BALL_SPEED_MAX ? speed : BALL_SPEED_MAX;
+            balls->period[i] = ball_speed_period(balls->speed[i]);
+            balls->timer[i] = 0;
+            balls->on_screen |= bit;
+            return;
+        }
+    }
+}
+
+
+/** Draw every ball on screen into the bitmap, keeping the paddle:
+    @param bitmap current bitmap array to update with the ball locations
+    @param balls pointer to balls struct */
+void balls_get_bitmap (uint8_t bitmap[], const Balls* balls)
+{
+    uint8_t paddle = bitmap[PADDLE_COL];
+    for (uint8_t i = 0; i < HEIGHT; i++) {
+        bitmap[i] = BLANK;
+    }
+    for (uint8_t i = 0; i < balls->count; i++) {
+        if (balls->on_screen & (1 << i)) {
+            bitmap[HEIGHT - 1 - balls->y[i]] |= flash_read_byte(&column_masks[balls->x[i]]);
+        }
+    }
+    bitmap[PADDLE_COL] |= paddle; //keep paddle bits
+}
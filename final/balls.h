@@ -0,0 +1,86 @@
+/** @file balls.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief multi-ball mode: several balls kept as parallel arrays, each on its own step timer
+ */
+
+
+#ifndef BALLS_H
+#define BALLS_H
+
+#include "system.h"
+#include "ball.h"
+
+#define BALLS_MAX 8 //one bit per ball in the on_screen and dead masks
+
+#ifndef MULTI_BALLS
+#define MULTI_BALLS 3 //balls served at the start of a multi-ball round
+#endif
+
+#if MULTI_BALLS < 1 || MULTI_BALLS > BALLS_MAX
+#error "MULTI_BALLS must be between 1 and BALLS_MAX"
+#endif
+
+
+/** Define data associated with a set of balls */
+typedef struct balls_s Balls;
+
+
+/** Balls structure, ball i is index i of each array and bit i of each mask */
+struct balls_s {
+    uint8_t x[BALLS_MAX];
+    uint8_t y[BALLS_MAX];
+    int8_t direction_x[BALLS_MAX]; //-1 for left, 0 for straight, 1 for right
+    int8_t direction_y[BALLS_MAX]; //1 for up, -1 for down
+    uint8_t speed[BALLS_MAX]; //paddle hits since the serve, up to BALL_SPEED_MAX, as Ball's
+    uint16_t period[BALLS_MAX]; //Q8.8 pacer ticks per step at this speed
+    uint16_t timer[BALLS_MAX]; //Q8.8 pacer ticks since the last step
+    uint8_t on_screen; //bit i set if ball i is on this kit's screen
+    uint8_t dead; //bit i set if ball i has hit the ground
+    uint8_t count; //number of balls in play, using slots 0 to count - 1
+};
+
+
+/** Initialise a set of balls, all on the opponent's screen:
+    @param balls pointer to struct being initialised
+    @param count number of balls in play, at most BALLS_MAX */
+void balls_init (Balls* balls, uint8_t count);
+
+
+/** Serve every ball from the paddle, spread across directions and rows so no two follow the same path:
+    @param balls pointer to balls struct
+    @param paddle x coordinate of centre of paddle */
+void balls_launch (Balls* balls, uint8_t paddle);
+
+
+/** Count one pacer tick of the step timer of every ball on screen, as ball_tick does
+    for one. Costs a 16 bit add and compare per ball, plus a subtract for each due:
+    @param balls pointer to balls struct
+    @return mask of the balls due to step this tick */
+uint8_t balls_tick (Balls* balls);
+
+
+/** Move the given balls one step, with the same rules as update_location, speeding
+    up each one that hits the paddle:
+    @param balls pointer to balls struct
+    @param paddle x coordinate of centre of paddle
+    @param due mask of the balls to move, those on screen whose timers ran out
+    @return mask of the balls that went off screen this step */
+uint8_t balls_step (Balls* balls, uint8_t paddle, uint8_t due);
+
+
+/** Place a ball arriving from the opponent in a free slot, its step timer restarted:
+    @param balls pointer to balls struct
+    @param x x coordinate it enters at
+    @param direction_x its horizontal direction
+    @param speed its speed level, as carried in the frame */
+void balls_receive (Balls* balls, uint8_t x, int8_t direction_x, uint8_t speed);
+
+
+/** Draw every ball on screen into the bitmap, keeping the paddle:
+    @param bitmap current bitmap array to update with the ball locations
+    @param balls pointer to balls struct */
+void balls_get_bitmap (uint8_t bitmap[], const Balls* balls);
+
+
+#endif
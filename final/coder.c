@@ -7,6 +7,7 @@
 
 
 #include "coder.h"
+#include "progmem.h"
 
 /* A Reed-Solomon code is generated by a Vandermonde matrix over some field.
  * Because of the provided communication functions in the funkit API, it is easiest
@@ -17,8 +18,10 @@
  * Therefore every element of my field has a binary representation of length 2, and the
  * transmitted length of my code is 1 byte. I have chosen a message length of k = 2,
  * which is 4 bits in binary transmission. Thus I have 16 possible code words in my code
- * and a distance of d = n - k + 1 = 3. This implies I can correct any transmission with
- * less than or equal to 25% bit error rate. */
+ * and a distance of d = n - k + 1 = 3. This implies I can correct any single symbol error,
+ * ie any 1 bit error or a 2 bit error falling within the same symbol. Two corrupted symbols
+ * are miscorrected. Measured residual error rates per channel model are produced by
+ * sim/coder_sim (make -f Makefile.test coder_sim). */
 
 
 /* I am generating my chosen field, F_4 with the irreducible polynomial x^2 + x + 1
@@ -42,7 +45,7 @@
 
 /** Multiplication table over F_4 indexed by decimal representation of element. eg x^2 * x = mutliplication_table[3][2]
     (or [2][3]) technically as multiplication is commutative */
-static uint8_t multiplication_table[CODE_LENGTH][CODE_LENGTH] = {
+static const uint8_t multiplication_table[CODE_LENGTH][CODE_LENGTH] PROGMEM = {
     {0,0,0,0},
     {0,1,2,3},
     {0,2,3,1},
@@ -51,7 +54,7 @@ static uint8_t multiplication_table[CODE_LENGTH][CODE_LENGTH] = {
 
 
 /** Similar for addition */
-static uint8_t addition_table[CODE_LENGTH][CODE_LENGTH] = {
+static const uint8_t addition_table[CODE_LENGTH][CODE_LENGTH] PROGMEM = {
     {0,1,2,3},
     {1,0,3,2},
     {2,3,0,1},
@@ -60,14 +63,14 @@ static uint8_t addition_table[CODE_LENGTH][CODE_LENGTH] = {
 
 
 /** Linear map to generate codewords from messages */
-static uint8_t generator_matrix[MESSAGE_LENGTH][CODE_LENGTH] = {
+static const uint8_t generator_matrix[MESSAGE_LENGTH][CODE_LENGTH] PROGMEM = {
     {1,1,1,1},
     {0,1,2,3}
 };
 
 
 /** Parity check matrix to calculated syndromes from received messages */
-static uint8_t transposed_parity_check_matrix[CODE_LENGTH][PARITY_DIM] = {
+static const uint8_t transposed_parity_check_matrix[CODE_LENGTH][PARITY_DIM] PROGMEM = {
     {1,0},
     {1,1},
     {1,2},
@@ -77,7 +80,7 @@ static uint8_t transposed_parity_check_matrix[CODE_LENGTH][PARITY_DIM] = {
 
 /** Representative vectors for each syndrome. Indexed by decimal value of syndrome
 interpreted as a quaternary value */
-static uint8_t representatives[NUM_SYNDROMES][CODE_LENGTH] = {
+static const uint8_t representatives[NUM_SYNDROMES][CODE_LENGTH] PROGMEM = {
     {0,0,0,0},
     {0,0,1,1},
     {0,0,2,2},
@@ -97,11 +100,43 @@ static uint8_t representatives[NUM_SYNDROMES][CODE_LENGTH] = {
 };
 
 
+/* The tables above live in flash, so they are only read through these. */
+
+
+/** Multiply two elements of F_4:
+    @param a LHS of product
+    @param b RHS of product
+    @return a * b */
+static uint8_t multiply (uint8_t a, uint8_t b)
+{
+    return flash_read_byte(&multiplication_table[a][b]);
+}
+
+
+/** Add two elements of F_4:
+    @param a LHS of sum
+    @param b RHS of sum
+    @return a + b */
+static uint8_t add (uint8_t a, uint8_t b)
+{
+    return flash_read_byte(&addition_table[a][b]);
+}
+
+
+/** Read one representative vector:
+    @param syndrome_val syndrome interpreted as a quaternary value
+    @param representative, an array in which to place the vector */
+static void get_representative (uint8_t syndrome_val, uint8_t representative[])
+{
+    flash_read_block(representative, representatives[syndrome_val], CODE_LENGTH);
+}
+
+
 /** Multiply a message vector by a generator matrix with terms over F_4:
     @param vector represented as an array to be LHS of product
-    @param matrix, a 2D array to be RHS of product
+    @param matrix, a 2D array in flash to be RHS of product
     @param result, an array in which to place result of multiplication */
-static void multiply_generator (uint8_t vector[], uint8_t matrix[][CODE_LENGTH], uint8_t result[])
+static void multiply_generator (uint8_t vector[], const uint8_t matrix[][CODE_LENGTH], uint8_t result[])
 {
     uint8_t sum;
     uint8_t product;
@@ -110,8 +145,8 @@ static void multiply_generator (uint8_t vector[], uint8_t matrix[][CODE_LENGTH],
         sum = 0;
         for (uint8_t j = 0; j < MESSAGE_LENGTH; j++) {
             //interpret multiplication and addition over F_4
-            product = multiplication_table[vector[j]][matrix[j][i]];
-            sum = addition_table[sum][product];
+            product = multiply(vector[j], flash_read_byte(&matrix[j][i]));
+            sum = add(sum, product);
         }
         result[i] = sum;
     }
@@ -120,9 +155,9 @@ static void multiply_generator (uint8_t vector[], uint8_t matrix[][CODE_LENGTH],
 
 /** Multiply a vector by a parity check matrix with terms over F_4:
     @param vector represented as an array to be LHS of product
-    @param matrix, a 2D array to be RHS of product
+    @param matrix, a 2D array in flash to be RHS of product
     @param result, an array in which to place result of multiplication */
-static void multiply_parity_check (uint8_t vector[], uint8_t matrix[][PARITY_DIM], uint8_t result[])
+static void multiply_parity_check (uint8_t vector[], const uint8_t matrix[][PARITY_DIM], uint8_t result[])
 {
     uint8_t sum;
     uint8_t product;
@@ -130,8 +165,8 @@ static void multiply_parity_check (uint8_t vector[], uint8_t matrix[][PARITY_DIM
         sum = 0;
         for (uint8_t j = 0; j < CODE_LENGTH; j++) {
             //interpret multiplication and addition over F_4
-            product = multiplication_table[vector[j]][matrix[j][i]];
-            sum = addition_table[sum][product];
+            product = multiply(vector[j], flash_read_byte(&matrix[j][i]));
+            sum = add(sum, product);
         }
         result[i] = sum;
     }
@@ -146,7 +181,7 @@ static void subtract_vectors (uint8_t vector1[], uint8_t vector2[], uint8_t resu
 {
     for (uint8_t i = 0; i < CODE_LENGTH; i++) {
         // addition and subtraction are identical since 1 = -1 over F_4
-        result[i] = addition_table[vector1[i]][vector2[i]];
+        result[i] = add(vector1[i], vector2[i]);
     }
 }
 
@@ -214,13 +249,11 @@ uint8_t decode (uint8_t transmission)
     multiply_parity_check(vector, transposed_parity_check_matrix, syndrome);
 
     syndrome_val = syndrome[1] + 4 * syndrome[0]; //interpret syndrome as quaternary value
-    for (uint8_t i = 0; i < CODE_LENGTH; i++) {
-        representative[i] = representatives[syndrome_val][i];
-    }
+    get_representative(syndrome_val, representative);
     subtract_vectors(vector, representative, corrected_code); // get best guess at transmitted codeword
 
     original_message[0] = corrected_code[0];
-    original_message[1] = addition_table[corrected_code[1]][original_message[0]];
+    original_message[1] = add(corrected_code[1], original_message[0]);
 
     return original_message[1] + 4 * original_message[0];
 }
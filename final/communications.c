@@ -7,9 +7,11 @@
 
 
 #include "communications.h"
+#include "recorder.h"
+#include "tracer.h"
 
 
-/** transmit relevant ball information:
+/** transmit relevant ball information: coordinate, direction and speed level
     @param ball struct containing ball data*/
 void transmit_ball (Ball* ball)
 {
@@ -22,11 +24,17 @@ void transmit_ball (Ball* ball)
         uint8_t encoded_x_coord = encode(x_coord + COORD_OFFSET);
         uint8_t encoded_x_dir = encode(x_dir + DIR_OFFSET);
 
+        TRACE_EVENT(TRACE_TX_BALL, x_coord);
+        RECORD_BYTE(RECORD_TX, encoded_x_coord);
         ir_uart_putc(encoded_x_coord);
+        RECORD_BYTE(RECORD_TX, encoded_x_dir);
         ir_uart_putc(encoded_x_dir);
+        send_symbol(ball->speed); //so the ball carries on at the same speed over there
 
     } else { //ball just died, only need to transmit deadness
         uint8_t encoded_message = encode(DEAD_BALL);
+        TRACE_EVENT(TRACE_TX_DEAD, 0);
+        RECORD_BYTE(RECORD_TX, encoded_message);
         ir_uart_putc(encoded_message);
     }
 }
@@ -37,21 +45,26 @@ void transmit_ball (Ball* ball)
 void inform_start (uint8_t mode)
 {
     uint8_t val = encode(mode);
+    TRACE_EVENT(TRACE_TX_START, mode);
+    RECORD_BYTE(RECORD_TX, val);
     ir_uart_putc(val);
 }
 
 
 /** Receive relevant ball information from other device
-    @param ball struct containing ball data*/
-void receive_ball (Ball* ball)
+    @param ball struct containing ball data
+    @return BALL_FIRED_EVENT if the other kit has served, with its digest still to read, else 0*/
+uint8_t receive_ball (Ball* ball)
 {
     uint8_t encoded_x_coord;
     uint8_t encoded_x_dir;
     if (ir_uart_read_ready_p()) {
         encoded_x_coord = ir_uart_getc();
+        RECORD_BYTE(RECORD_RX, encoded_x_coord);
         uint8_t x_coord = decode(encoded_x_coord) - COORD_OFFSET;
         if (x_coord <= RIGHT_WALL) { //we are receiving a transmission of ball location
             encoded_x_dir = ir_uart_getc();
+            RECORD_BYTE(RECORD_RX, encoded_x_dir);
             int8_t x_dir = decode(encoded_x_dir) - DIR_OFFSET;
 
             ball->x = x_coord;
@@ -66,10 +79,127 @@ void receive_ball (Ball* ball)
             ball->y = HEIGHT - 1;
             ball->direction_y = DOWN;
 
-            //set to on screen
+            //set to on screen, at the speed it left the other kit
             ball->on_screen = 1;
+            ball_set_speed(ball, read_symbol());
+            TRACE_EVENT(TRACE_RX_BALL, x_coord);
         } else if (x_coord + COORD_OFFSET == DEAD_BALL) { //we are being told the ball is dead
+            TRACE_EVENT(TRACE_RX_DEAD, 0);
             ball->dead = 1;
+        } else if (x_coord + COORD_OFFSET == BALL_FIRED_EVENT) { //a new round, we missed the end of the last one
+            return BALL_FIRED_EVENT;
+        }
+    }
+    return 0;
+}
+
+
+/** Write one encoded symbol, logging it in record mode
+    @param message value between 0 and 15*/
+void send_symbol (uint8_t message)
+{
+    uint8_t encoded = encode(message);
+    RECORD_BYTE(RECORD_TX, encoded);
+    ir_uart_putc(encoded);
+}
+
+
+/** Read and decode one symbol, waiting for it if needed
+    @return the decoded value*/
+uint8_t read_symbol (void)
+{
+    uint8_t encoded = ir_uart_getc();
+    RECORD_BYTE(RECORD_RX, encoded);
+    return decode(encoded);
+}
+
+
+/** Tell the other kit a ball has been served, with a digest of the match state as this kit sees it
+    @param digest one byte digest, sent high nibble first*/
+void transmit_round_start (uint8_t digest)
+{
+    uint8_t high = digest >> 4;
+    uint8_t low = digest & 0x0f;
+    TRACE_EVENT(TRACE_TX_ROUND, digest);
+    send_symbol(BALL_FIRED_EVENT);
+    send_symbol(high);
+    send_symbol(low);
+    send_symbol(high ^ low ^ DIGEST_CHECK);
+}
+
+
+/** Read the digest that follows BALL_FIRED_EVENT, waiting for it if needed
+    @param digest where to place the one byte digest
+    @return 1 if its check symbol matches, else 0*/
+uint8_t receive_digest (uint8_t* digest)
+{
+    uint8_t high = read_symbol();
+    uint8_t low = read_symbol();
+    uint8_t check = read_symbol();
+    *digest = high << 4 | low;
+    TRACE_EVENT(TRACE_RX_ROUND, *digest);
+    return check == (high ^ low ^ DIGEST_CHECK);
+}
+
+
+/** Transmit every ball that just left the screen in one frame, or that a ball has died:
+    @param balls struct containing ball data
+    @param leaving mask of the balls that went off screen*/
+void transmit_balls (const Balls* balls, uint8_t leaving)
+{
+    if (balls->dead) {
+        TRACE_EVENT(TRACE_TX_DEAD, 0);
+        send_symbol(DEAD_BALL);
+        return;
+    }
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < balls->count; i++) {
+        count += (leaving >> i) & 1;
+    }
+    TRACE_EVENT(TRACE_TX_BALLS, count);
+    send_symbol(BALL_BATCH_EVENT);
+    send_symbol(count);
+    for (uint8_t i = 0; i < balls->count; i++) {
+        if (leaving & (1 << i)) {
+            // mirrored as in transmit_ball
+            send_symbol(RIGHT_WALL - balls->x[i] + COORD_OFFSET);
+            send_symbol(-balls->direction_x[i] + DIR_OFFSET);
+            send_symbol(balls->speed[i]); //as transmit_ball, so it carries on at the same speed
+        }
+    }
+}
+
+
+/** Receive a multi-ball frame or dead ball message from other device, if one has arrived
+    @param balls struct containing ball data
+    @return BALL_FIRED_EVENT if the other kit has served, with its digest still to read, else 0*/
+uint8_t receive_balls (Balls* balls)
+{
+    if (!ir_uart_read_ready_p()) {
+        return 0;
+    }
+    uint8_t message = read_symbol();
+    if (message == DEAD_BALL) {
+        TRACE_EVENT(TRACE_RX_DEAD, 0);
+        balls->dead = 1;
+    } else if (message == BALL_BATCH_EVENT) {
+        uint8_t count = read_symbol();
+        TRACE_EVENT(TRACE_RX_BALLS, count);
+        for (uint8_t i = 0; i < count && i < BALLS_MAX; i++) {
+            uint8_t x_coord = read_symbol() - COORD_OFFSET;
+            int8_t x_dir = read_symbol() - DIR_OFFSET;
+            uint8_t speed = read_symbol();
+            if (x_coord > RIGHT_WALL) {
+                x_coord = RIGHT_WALL; //corrupted beyond repair, keep the ball in play anyway
+            }
+            if (x_dir < LEFT || x_dir > RIGHT) {
+                //transmission got messed up, default to straight down
+                x_dir = STRAIGHT;
+            }
+            balls_receive(balls, x_coord, x_dir, speed);
         }
+    } else if (message == BALL_FIRED_EVENT) {
+        return BALL_FIRED_EVENT;
     }
+    return 0;
 }
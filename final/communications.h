@@ -12,13 +12,17 @@
 #include "coder.h"
 #include "ir_uart.h"
 #include "ball.h"
+#include "balls.h"
 
 #define COORD_OFFSET 1
 #define DIR_OFFSET 2
 #define DEAD_BALL 15 //transmission value for when ball has died
+#define BALL_BATCH_EVENT 13 //starts a multi-ball frame: count, then coordinate, direction and speed of each ball
+#define BALL_FIRED_EVENT 12 //a round has been served, followed by the server's digest as two symbols and a check symbol
+#define DIGEST_CHECK 0x0a //mixed into the check symbol so a run of zero symbols does not pass
 
 
-/** transmit relevant ball information:
+/** transmit relevant ball information: coordinate, direction and speed level
     @param ball struct containing ball data*/
 void transmit_ball (Ball* ball);
 
@@ -29,8 +33,42 @@ void inform_start (uint8_t mode);
 
 
 /** Receive relevant ball information from other device
-    @param ball struct containing ball data*/
-void receive_ball (Ball* ball);
+    @param ball struct containing ball data
+    @return BALL_FIRED_EVENT if the other kit has served, with its digest still to read, else 0*/
+uint8_t receive_ball (Ball* ball);
+
+
+/** Tell the other kit a ball has been served, with a digest of the match state as this kit sees it
+    @param digest one byte digest, sent high nibble first*/
+void transmit_round_start (uint8_t digest);
+
+
+/** Read the digest that follows BALL_FIRED_EVENT, waiting for it if needed
+    @param digest where to place the one byte digest
+    @return 1 if its check symbol matches, else 0*/
+uint8_t receive_digest (uint8_t* digest);
+
+
+/** Write one encoded symbol, logging it in record mode
+    @param message value between 0 and 15*/
+void send_symbol (uint8_t message);
+
+
+/** Read and decode one symbol, waiting for it if needed
+    @return the decoded value*/
+uint8_t read_symbol (void);
+
+
+/** Transmit every ball that just left the screen in one frame, or that a ball has died:
+    @param balls struct containing ball data
+    @param leaving mask of the balls that went off screen*/
+void transmit_balls (const Balls* balls, uint8_t leaving);
+
+
+/** Receive a multi-ball frame or dead ball message from other device, if one has arrived
+    @param balls struct containing ball data
+    @return BALL_FIRED_EVENT if the other kit has served, with its digest still to read, else 0*/
+uint8_t receive_balls (Balls* balls);
 
 
 #endif
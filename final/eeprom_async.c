@@ -0,0 +1,103 @@
+/** @file eeprom_async.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief EEPROM writes that run a byte at a time from the EEPROM-ready interrupt, so the pacer loop never waits
+ */
+
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+#include <util/atomic.h>
+#include <string.h>
+#include "eeprom_async.h"
+
+
+/** A block being written, or waiting its turn */
+typedef struct {
+    uint16_t address;
+    uint8_t data[EEPROM_ASYNC_MAX];
+    uint8_t length; //0 if there is nothing to write
+    uint8_t index; //next byte to write
+} Block;
+
+
+static volatile Block current;
+static volatile Block queued;
+
+
+/** Write the next byte that differs from what the EEPROM holds, or move on to
+    the queued block, or stop once everything is written. Runs each time the
+    EEPROM is ready for another byte */
+ISR(EE_READY_vect)
+{
+    while (current.index < current.length) {
+        EEAR = current.address + current.index;
+        EECR |= _BV(EERE);
+        uint8_t value = current.data[current.index++];
+        if (EEDR != value) {
+            EEDR = value;
+            EECR |= _BV(EEMPE);
+            EECR |= _BV(EEPE); //within four cycles of EEMPE, the interrupt fires again once it is done
+            return;
+        }
+    }
+    if (queued.length) {
+        current = queued;
+        queued.length = 0;
+    } else {
+        current.length = 0;
+        EECR &= ~_BV(EERIE);
+    }
+}
+
+
+/** Enable interrupts so queued writes can run */
+void eeprom_async_init (void)
+{
+    sei();
+}
+
+
+/** Read from EEPROM, first waiting for any writes to finish:
+    @param address first byte to read
+    @param data where to place the bytes
+    @param length number of bytes */
+void eeprom_async_read (uint16_t address, uint8_t data[], uint8_t length)
+{
+    while (eeprom_async_busy()) {
+        continue;
+    }
+    eeprom_read_block(data, (const void*) address, length);
+}
+
+
+/** Start writing a block to EEPROM and return at once:
+    @param address first byte to write
+    @param data bytes to write, copied before returning
+    @param length number of bytes, at most EEPROM_ASYNC_MAX
+    @return 1 if the write was started or queued, 0 if a write is already queued */
+uint8_t eeprom_async_write (uint16_t address, const uint8_t data[], uint8_t length)
+{
+    uint8_t accepted = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        volatile Block* block = current.length ? &queued : &current;
+        if (!block->length) {
+            block->address = address;
+            memcpy((void*) block->data, data, length);
+            block->index = 0;
+            block->length = length;
+            EECR |= _BV(EERIE); //fires as soon as the EEPROM is idle
+            accepted = 1;
+        }
+    }
+    return accepted;
+}
+
+
+/** Check whether writes are still in progress:
+    @return 1 if any bytes are left to write, else 0 */
+uint8_t eeprom_async_busy (void)
+{
+    return current.length != 0;
+}
@@ -0,0 +1,48 @@
+/** @file eeprom_async.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief EEPROM writes that run a byte at a time from the EEPROM-ready interrupt, so the pacer loop never waits
+ */
+
+
+#ifndef EEPROM_ASYNC_H
+#define EEPROM_ASYNC_H
+
+#include "system.h"
+
+#define EEPROM_SIZE 1024 //bytes of EEPROM on the ATmega32U2
+#define EEPROM_ASYNC_MAX 16 //longest single write
+
+
+/* A byte write takes about 3.4 ms, two pacer ticks, so a block is handed to
+ * the EEPROM-ready interrupt, which writes one byte each time the last one
+ * finishes. Bytes that already hold the value are skipped to save wear. One
+ * more block can queue behind the one being written. The simulator provides
+ * its own version with an EEPROM per virtual kit. */
+
+
+/** Enable interrupts so queued writes can run */
+void eeprom_async_init (void);
+
+
+/** Read from EEPROM, first waiting for any writes to finish:
+    @param address first byte to read
+    @param data where to place the bytes
+    @param length number of bytes */
+void eeprom_async_read (uint16_t address, uint8_t data[], uint8_t length);
+
+
+/** Start writing a block to EEPROM and return at once:
+    @param address first byte to write
+    @param data bytes to write, copied before returning
+    @param length number of bytes, at most EEPROM_ASYNC_MAX
+    @return 1 if the write was started or queued, 0 if a write is already queued */
+uint8_t eeprom_async_write (uint16_t address, const uint8_t data[], uint8_t length);
+
+
+/** Check whether writes are still in progress:
+    @return 1 if any bytes are left to write, else 0 */
+uint8_t eeprom_async_busy (void);
+
+
+#endif
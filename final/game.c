@@ -15,35 +15,27 @@
 #include "ir_uart.h"
 #include "pong_display.h"
 #include "communications.h"
+#include "game.h"
+#include "recorder.h"
+#include "tracer.h"
+#include "ai.h"
+#include "balls.h"
+#include "ring.h"
+#include "lockstep.h"
+#include "stats_log.h"
+#include "progmem.h"
+#include "timing.h"
 
 #define HEIGHT 5
-#define BALL_RATE 100
-#define DISPLAY_RATE 250
-#define DISPLAY_CYCLES 10
-#define MESSAGE_RATE 10
 #define WINNING_SCORE '3'
-#define START_MENU 0
-#define PADDLE_MODE 1
-#define PLAY_MODE 2
-#define DISPLAY_SCORE_MODE 3
-#define GAME_OVER_MODE 4
 #define INITIAL_COUNTER_VALUE 0
 #define INITIAL_SCORE '0'
 #define GAME_START_EVENT 10
-#define BALL_FIRED_EVENT 12
+#define MULTI_BALL_START_EVENT 11
 #define STARTING_MODE 2
 #define RECEIVING_MODE 1
-
-
-typedef struct {
-    char score;
-    char opponent_score;
-    uint8_t game_mode; //game modes: START_MENU = 0, PADDLE_MODE = 1, PLAY_MODE = 2, DISPLAY_SCORE_MODE = 3, GAME_OVER_MODE = 4
-    uint8_t ball_counter;
-    uint8_t column_counter;
-    uint8_t display_counter;
-    uint8_t display_cycle; //to count number of passed clock cycles
-} Game;
+#define DIGEST_ROUND_MASK 0x0f //round numbers are kept modulo 16, the low nibble of the digest
+#define DIGEST_SCORE_MASK 0x03 //scores never pass 3, two bits each
 
 
 /** Display scrolling PONG text and wait for user to signal they wish to begin game:
@@ -52,20 +44,56 @@ static void run_start_menu (Game* game)
 {
     // scroll the start of game text until one player starts paddle screen
     tinygl_update();
+    ai_stir(&game->ai);
     // Check for navswitch presses
     navswitch_update();
+    RECORD_NAVSWITCH();
 
     // Check for a push
     if (navswitch_push_event_p(NAVSWITCH_PUSH)) {
         inform_start(GAME_START_EVENT); //tell other controller a game has been started
         game->game_mode = PADDLE_MODE;
+    } else if (navswitch_push_event_p(NAVSWITCH_WEST)) {
+        inform_start(MULTI_BALL_START_EVENT); //both kits play multi-ball
+        game->multi_ball = 1;
+        game->game_mode = PADDLE_MODE;
+    } else if (navswitch_push_event_p(NAVSWITCH_NORTH)) {
+        // form a ring with every kit in range, this one is address 0
+        ring_start(&game->ring);
+        game->ring_mode = 1;
+        game->game_mode = PADDLE_MODE;
+        return;
+    } else if (navswitch_push_event_p(NAVSWITCH_SOUTH)) {
+        // both kits run the whole court and send each other only paddle inputs
+        lockstep_start(&game->lockstep);
+        game->lockstep_mode = 1;
+        game->game_mode = PADDLE_MODE;
+        return;
+    } else if (navswitch_push_event_p(NAVSWITCH_EAST)) {
+        // play against the AI instead, nothing is sent over IR
+        game->single_player = 1;
+        game->game_mode = PADDLE_MODE;
+        return;
     }
     // Check if the other fun kit pressed start
     if (ir_uart_read_ready_p()) {
         uint8_t val = ir_uart_getc();
+        RECORD_BYTE(RECORD_RX, val);
         uint8_t decoded_val = decode(val);
+        TRACE_EVENT(TRACE_RX_START, decoded_val);
         if (decoded_val == GAME_START_EVENT) { //we are receiving a transmission, not noise
             game->game_mode = PADDLE_MODE;
+        } else if (decoded_val == MULTI_BALL_START_EVENT) {
+            game->multi_ball = 1;
+            game->game_mode = PADDLE_MODE;
+        } else if (decoded_val == RING_JOIN_EVENT) {
+            ring_join(&game->ring);
+            game->ring_mode = 1;
+            game->game_mode = PADDLE_MODE;
+        } else if (decoded_val == LOCKSTEP_START_EVENT) {
+            lockstep_join(&game->lockstep);
+            game->lockstep_mode = 1;
+            game->game_mode = PADDLE_MODE;
         }
     }
 }
@@ -77,6 +105,7 @@ static void move_paddle (Paddle* paddle)
 {
     // Check for navswitch presses
     navswitch_update();
+    RECORD_NAVSWITCH();
 
     //Check for a left push
     if (navswitch_push_event_p(NAVSWITCH_SOUTH)) {
@@ -90,10 +119,11 @@ static void move_paddle (Paddle* paddle)
 
 
 /** Initialise the attributes of the ball struct based on position of paddle on launch:
+    @param game a pointer to the game object, whose balls are set up too in multi-ball mode
     @param ball a pointer to the ball object
     @param paddle a pointer to the paddle object
     @param game state, an int indicating whether current player or opponent is starting */
-static void initialise_ball (Ball* ball, Paddle* paddle, uint8_t game_state)
+static void initialise_ball (Game* game, Ball* ball, Paddle* paddle, uint8_t game_state)
 {
     if (game_state == RECEIVING_MODE) {
         //other player is starting. Initialise ball to be offscreen and wait for transmission
@@ -103,6 +133,55 @@ static void initialise_ball (Ball* ball, Paddle* paddle, uint8_t game_state)
         uint8_t paddle_loc = get_paddle_location(paddle);
         ball_init(ball, paddle_loc, 1, 0, UP, ON_SCREEN);
     }
+    if (game->multi_ball) {
+        balls_init(&game->balls, MULTI_BALLS);
+        if (game_state != RECEIVING_MODE) {
+            balls_launch(&game->balls, get_paddle_location(paddle));
+        }
+    }
+}
+
+
+/** Pack the match state as one kit sees it into a one byte digest:
+    @param score that kit's score
+    @param opponent_score the other kit's score
+    @param round round number
+    @return score in bits 6-7, opponent score in bits 4-5 and round in bits 0-3 */
+static uint8_t round_digest (char score, char opponent_score, uint8_t round)
+{
+    return (score - INITIAL_SCORE) << 6 | (opponent_score - INITIAL_SCORE) << 4 | (round & DIGEST_ROUND_MASK);
+}
+
+
+/** Begin a round the other kit has served, reading its digest and checking it against our own state.
+    A kit that misses a dead ball message is left waiting in play mode and cannot serve,
+    so on a mismatch the server's state is taken as the true one:
+    @param game a pointer to the game object */
+static void start_received_round (Game* game)
+{
+    uint8_t digest;
+    uint8_t valid = receive_digest(&digest); //the server's digest, from its side of the court
+    game->round = (game->round + 1) & DIGEST_ROUND_MASK;
+    if (valid && digest != round_digest(game->opponent_score, game->score, game->round)) {
+        game->score = INITIAL_SCORE + ((digest >> 4) & DIGEST_SCORE_MASK);
+        game->opponent_score = INITIAL_SCORE + (digest >> 6);
+        game->round = digest & DIGEST_ROUND_MASK;
+        game->resyncs++;
+    }
+    game->game_mode = PLAY_MODE;
+}
+
+
+/** Show the scores once any kit on the ring has dropped the ball:
+    @param game a pointer to the game object
+    @param ball a pointer to the ball object */
+static void end_ring_round (Game* game, Ball* ball)
+{
+    game->score = INITIAL_SCORE + game->ring.scores[game->ring.address];
+    game->opponent_score = INITIAL_SCORE + ring_best_other(&game->ring); //the leader among the other kits
+    ball_init(ball, 0, HEIGHT, STRAIGHT, UP, OFF_SCREEN);
+    game->game_mode = DISPLAY_SCORE_MODE;
+    tinygl_clear(); //clear previous score to prevent delay
 }
 
 
@@ -120,26 +199,96 @@ static void run_paddle_only (Ball* ball, Paddle* paddle, Game* game, uint8_t bit
     get_paddle_bitmap(paddle, bitmap);
     game->column_counter = update_display(bitmap, game->column_counter);
 
+    if (game->ring_mode) {
+        // only the kit that dropped the last ball serves, the others wait for it to reach them
+        if (navswitch_push_event_p(NAVSWITCH_PUSH) && ring_may_serve(&game->ring)) {
+            game->game_mode = PLAY_MODE;
+            initialise_ball(game, ball, paddle, STARTING_MODE);
+            return;
+        }
+        uint8_t event = ring_poll(&game->ring, ball);
+        if (event == RING_BALL) {
+            game->game_mode = PLAY_MODE;
+        } else if (event == RING_ROUND_OVER) {
+            end_ring_round(game, ball);
+        }
+        return;
+    }
+
     // Check for a push
     if (navswitch_push_event_p(NAVSWITCH_PUSH)) {
         // release the kraken
-        inform_start(BALL_FIRED_EVENT); //tell other controller a ball has been released
+        game->round = (game->round + 1) & DIGEST_ROUND_MASK;
+        if (!game->single_player) {
+            //tell other controller a ball has been released, and how we see the match
+            transmit_round_start(round_digest(game->score, game->opponent_score, game->round));
+        }
         game->game_mode = PLAY_MODE;
-        initialise_ball(ball, paddle, STARTING_MODE);
+        initialise_ball(game, ball, paddle, STARTING_MODE);
+    } else if (game->single_player) {
+        // give the player a moment to serve, then the AI serves
+        if (ai_serve(&game->ai)) {
+            game->game_mode = PLAY_MODE;
+            initialise_ball(game, ball, paddle, RECEIVING_MODE);
+        }
+        return;
     }
 
      // Check if the other fun kit pressed start
     if (ir_uart_read_ready_p()) {
         uint8_t val = ir_uart_getc();
+        RECORD_BYTE(RECORD_RX, val);
         uint8_t decoded_val = decode(val);
         if (decoded_val == BALL_FIRED_EVENT) { //we are receiving a transmission, not noise
-            game->game_mode = PLAY_MODE;
-            initialise_ball(ball, paddle, RECEIVING_MODE);
+            initialise_ball(game, ball, paddle, RECEIVING_MODE);
+            start_received_round(game);
         }
     }
 }
 
 
+/** Hand the ball to the opponent as it leaves the screen or dies:
+    @param game a pointer to the game object
+    @param ball a pointer to the ball object */
+static void send_ball (Game* game, Ball* ball)
+{
+    if (game->single_player) {
+        ai_receive(&game->ai, ball);
+    } else {
+        transmit_ball(ball);
+    }
+}
+
+
+/** Check whether the opponent has sent the ball back or missed it:
+    @param game a pointer to the game object
+    @param ball a pointer to the ball object
+    @return BALL_FIRED_EVENT if the opponent has served a new round, else 0 */
+static uint8_t fetch_ball (Game* game, Ball* ball)
+{
+    if (game->single_player) {
+        //the AI's ball keeps its own step timer
+        ai_update(&game->ai, ball);
+        return 0;
+    }
+    return receive_ball(ball);
+}
+
+
+/** Move the ball one step, counting a paddle return for the stats log:
+    @param game a pointer to the game object
+    @param ball a pointer to the ball object
+    @param paddle a pointer to the paddle object */
+static void step_ball (Game* game, Ball* ball, Paddle* paddle)
+{
+    int8_t falling = ball->direction_y == DOWN;
+    update_location(ball, get_paddle_location(paddle));
+    if (falling && ball->direction_y == UP) {
+        stats_log_return(&game->stats);
+    }
+}
+
+
 /** Run the game logic during a round - ball and paddle movement, waiting for a game loss event:
     @param paddle a pointer to the paddle object
     @param ball a pointer to the ball object
@@ -151,37 +300,127 @@ static void play_round (Paddle* paddle, Ball* ball, Game* game, uint8_t bitmap[]
     get_paddle_bitmap(paddle, bitmap);
     get_bitmap(bitmap, ball);
     game->column_counter = update_display(bitmap, game->column_counter);
-    game->ball_counter++;
 
-    //if the ball is on screen and the timer is right, update location
-    if (ball->on_screen && game->ball_counter > BALL_RATE) {
-        game->ball_counter = 0;
-        update_location(ball, get_paddle_location(paddle));
+    //if the ball is on screen and its timer is due, update location
+    if (ball->on_screen && ball_tick(ball)) {
+        step_ball(game, ball, paddle);
         if (!ball->on_screen) {
             //if ball just moved off screen, transmit relevant info
-            transmit_ball(ball);
+            send_ball(game, ball);
         } else if (ball->dead) {
             //just lost the round
-            transmit_ball(ball);
+            send_ball(game, ball);
             game->opponent_score++;
             game->game_mode = DISPLAY_SCORE_MODE;
             tinygl_clear(); //clear previous score to prevent delay
         }
     } else if (!ball->on_screen) {
         //listen constantly for transmissions while the ball is offscreen
-        receive_ball(ball);
-        if (ball->dead) {
+        if (fetch_ball(game, ball) == BALL_FIRED_EVENT) {
+            //our dead ball message was lost or theirs never came, and they have served again
+            initialise_ball(game, ball, paddle, RECEIVING_MODE);
+            start_received_round(game);
+        } else if (ball->dead) {
             game->score++;
             game->game_mode = DISPLAY_SCORE_MODE;
             tinygl_clear(); //clear previous score to prevent delay
-        } else if (ball->on_screen) {
-            //reset ball timer
-            game->ball_counter = 0;
         }
     }
 }
 
 
+/** Run a ring round: the ball is routed to another kit as it leaves, and any kit dropping it ends the round:
+    @param paddle a pointer to the paddle object
+    @param ball a pointer to the ball object
+    @param game a pointer to the game object
+    @param bitmap, an array indicating the current ledmat display */
+static void play_ring_round (Paddle* paddle, Ball* ball, Game* game, uint8_t bitmap[])
+{
+    move_paddle(paddle);
+    get_paddle_bitmap(paddle, bitmap);
+    get_bitmap(bitmap, ball);
+    game->column_counter = update_display(bitmap, game->column_counter);
+
+    if (ball->on_screen && ball_tick(ball)) {
+        step_ball(game, ball, paddle);
+        if (!ball->on_screen || ball->dead) {
+            //send it on to its target, or tell every kit we dropped it
+            ring_send_ball(&game->ring, ball);
+        }
+        if (ball->dead) {
+            end_ring_round(game, ball);
+        }
+    } else if (!ball->on_screen) {
+        //listen constantly while the ball is elsewhere, passing on frames for other kits
+        if (ring_poll(&game->ring, ball) == RING_ROUND_OVER) {
+            end_ring_round(game, ball);
+        }
+    }
+}
+
+
+/** Run a multi-ball round: each ball steps on its own timer and the first one to hit the ground ends it:
+    @param paddle a pointer to the paddle object
+    @param game a pointer to the game object
+    @param bitmap, an array indicating the current ledmat display */
+static void play_multi_round (Paddle* paddle, Game* game, uint8_t bitmap[])
+{
+    Balls* balls = &game->balls;
+    move_paddle(paddle);
+    get_paddle_bitmap(paddle, bitmap);
+    balls_get_bitmap(bitmap, balls);
+    game->column_counter = update_display(bitmap, game->column_counter);
+
+    uint8_t due = balls_tick(balls);
+    if (due) {
+        uint8_t leaving = balls_step(balls, get_paddle_location(paddle), due);
+        if (balls->dead) {
+            //just lost the round, the other balls go with it
+            transmit_balls(balls, leaving);
+            game->opponent_score++;
+            game->game_mode = DISPLAY_SCORE_MODE;
+            tinygl_clear(); //clear previous score to prevent delay
+            return;
+        } else if (leaving) {
+            //everything that left this step goes in one frame
+            transmit_balls(balls, leaving);
+        }
+    }
+
+    //balls can arrive while others are still on screen
+    if (receive_balls(balls) == BALL_FIRED_EVENT) {
+        //we missed the end of the last round, and they have served again
+        balls_init(balls, MULTI_BALLS);
+        start_received_round(game);
+    } else if (balls->dead) {
+        game->score++;
+        game->game_mode = DISPLAY_SCORE_MODE;
+        tinygl_clear(); //clear previous score to prevent delay
+    }
+}
+
+
+/** Leave the score display, to keep playing or move to a win/loss screen if relevant:
+    @param game a pointer to the game object */
+static void leave_score_display (Game* game)
+{
+    game->display_counter = 0;
+    game->display_cycle = 0;
+    if (game->score == WINNING_SCORE) {
+        // have won the game, scroll winning text
+        game->game_mode = GAME_OVER_MODE;
+        scroll_text(PSTR("WINNER :) "));
+    } else if (game->opponent_score == WINNING_SCORE) {
+        // have lost the game, scroll losing text
+        game->game_mode = GAME_OVER_MODE;
+        scroll_text(PSTR("LOSER :( "));
+    } else {
+        // return to game play
+        game->game_mode = PADDLE_MODE;
+    }
+}
+
+
 /** Display the updated score for some amount of time and then update game state to
     keep playing or move to a win/loss screen if relevant:
     @param game a pointer to the game object */
@@ -193,21 +432,52 @@ static void check_display_timeout (Game* game)
     }
     if (game->display_cycle > DISPLAY_CYCLES) {
         // have waited intended number of timer cycles
-        game->display_counter = 0;
-        game->display_cycle = 0;
-        if (game->score == WINNING_SCORE) {
-            // have won the game, scroll winning text
-            game->game_mode = GAME_OVER_MODE;
-            scroll_text("WINNER :) ");
-        } else if (game->opponent_score == WINNING_SCORE) {
-            // have lost the game, scroll losing text
-            game->game_mode = GAME_OVER_MODE;
-            scroll_text("LOSER :( ");
-        } else {
-            // return to game play
-            game->game_mode = PADDLE_MODE;
+        leave_score_display(game);
+    }
+}
+
+
+/** Run a tick of a lockstep game, see lockstep.h. The mode follows the confirmed court, so
+    points are only scored once both kits' inputs for them are in, while the ball and
+    paddle are drawn from the shown court:
+    @param paddle a pointer to the paddle object, this kit's input
+    @param ball a pointer to the ball object, set to the shown ball
+    @param game a pointer to the game object
+    @param bitmap, an array indicating the current ledmat display */
+static void play_lockstep (Paddle* paddle, Ball* ball, Game* game, uint8_t bitmap[])
+{
+    Lockstep* lockstep = &game->lockstep;
+    uint8_t serve = 0;
+    if (game->game_mode != DISPLAY_SCORE_MODE) {
+        move_paddle(paddle);
+        serve = game->game_mode == PADDLE_MODE && navswitch_push_event_p(NAVSWITCH_PUSH);
+    }
+    if (lockstep_update(lockstep, get_paddle_location(paddle), serve) == LOCKSTEP_RETURN) {
+        stats_log_return(&game->stats);
+    }
+    lockstep_get_ball(lockstep, ball);
+    game->score = INITIAL_SCORE + lockstep->state.points[lockstep->side];
+    game->opponent_score = INITIAL_SCORE + lockstep->state.points[!lockstep->side];
+
+    uint8_t phase = lockstep->state.phase;
+    if (phase == LOCKSTEP_POINT) {
+        if (game->game_mode != DISPLAY_SCORE_MODE) {
+            game->game_mode = DISPLAY_SCORE_MODE;
+            tinygl_clear(); //clear previous score to prevent delay
         }
+        return;
     }
+    if (game->game_mode == DISPLAY_SCORE_MODE || phase == LOCKSTEP_OVER) {
+        leave_score_display(game);
+        return;
+    }
+    // our own serve shows before the other kit's input for its turn is in
+    uint8_t rally = phase == LOCKSTEP_RALLY || lockstep->shown.phase == LOCKSTEP_RALLY;
+    game->game_mode = rally ? PLAY_MODE : PADDLE_MODE;
+    Paddle shown = {lockstep->shown.paddles[lockstep->side]};
+    get_paddle_bitmap(&shown, bitmap);
+    get_bitmap(bitmap, ball);
+    game->column_counter = update_display(bitmap, game->column_counter);
 }
 
 
@@ -219,6 +489,130 @@ static void initialise (void)
     navswitch_init();
     ir_uart_init();
     init_led_matrix();
+    RECORD_INIT();
+    TRACE_INIT();
+}
+
+
+/** Reset game, paddle and display state ready for the start menu:
+    @param game a pointer to the game object
+    @param paddle a pointer to the paddle object
+    @param bitmap, an array indicating the current ledmat display */
+void game_init (Game* game, Paddle* paddle, uint8_t bitmap[])
+{
+    for (uint8_t i = 0; i < HEIGHT; i++) {
+        bitmap[i] = BLANK;
+    }
+    paddle_init(paddle);
+
+    game->score = INITIAL_SCORE;
+    game->opponent_score = INITIAL_SCORE;
+    game->game_mode = START_MENU;
+    game->column_counter = INITIAL_COUNTER_VALUE;
+    game->display_counter = INITIAL_COUNTER_VALUE;
+    game->display_cycle = INITIAL_COUNTER_VALUE;
+    game->round = 0;
+    game->resyncs = 0;
+    game->single_player = 0;
+    ai_init(&game->ai, AI_LEVEL);
+    game->multi_ball = 0;
+    balls_init(&game->balls, 0);
+    game->ring_mode = 0;
+    ring_init(&game->ring);
+    game->lockstep_mode = 0;
+    lockstep_init(&game->lockstep);
+    stats_log_init(&game->stats);
+
+    //set scroll text for main menu
+    scroll_text(PSTR("PONG: PUSH TO START "));
+    RECORD_SNAPSHOT_OF(game, paddle, 0, 0); //the ball is not set up until the first serve
+}
+
+
+/** Run one pacer tick of the game in its current mode:
+    @param game a pointer to the game object
+    @param ball a pointer to the ball object
+    @param paddle a pointer to the paddle object
+    @param bitmap, an array indicating the current ledmat display */
+void game_update (Game* game, Ball* ball, Paddle* paddle, uint8_t bitmap[])
+{
+    uint8_t previous_mode = game->game_mode;
+    RECORD_TICK();
+    TRACE_TICK();
+
+    switch(game->game_mode) {
+        case START_MENU :
+            run_start_menu(game);
+            break;
+
+        case PADDLE_MODE :
+            tinygl_clear();
+            if (game->lockstep_mode) {
+                play_lockstep(paddle, ball, game, bitmap);
+            } else {
+                run_paddle_only(ball, paddle, game, bitmap);
+            }
+            break;
+
+        case PLAY_MODE :
+            if (game->lockstep_mode) {
+                play_lockstep(paddle, ball, game, bitmap);
+            } else if (game->ring_mode) {
+                play_ring_round(paddle, ball, game, bitmap);
+            } else if (game->multi_ball) {
+                play_multi_round(paddle, game, bitmap);
+            } else {
+                play_round(paddle, ball, game, bitmap);
+            }
+            break;
+
+        case DISPLAY_SCORE_MODE :
+            game->display_counter++;
+            display_character(game->score);
+            if (game->lockstep_mode) {
+                play_lockstep(paddle, ball, game, bitmap); //the court keeps running, and says when the score is done
+            } else {
+                check_display_timeout(game); //check if score displayed for long enough to return to game play
+            }
+            break;
+
+        case GAME_OVER_MODE :
+            tinygl_update();
+            if (game->lockstep_mode) {
+                lockstep_finish(&game->lockstep); //the other kit may still need our last inputs
+            }
+#if defined(RECORD) || defined(TRACE)
+            navswitch_update();
+#endif
+#ifdef RECORD
+            // push west to send the log out over IR for capture
+            if (navswitch_push_event_p(NAVSWITCH_WEST)) {
+                record_dump(ir_uart_putc);
+            }
+#endif
+#ifdef TRACE
+            // push south to send the trace out the same way
+            if (navswitch_push_event_p(NAVSWITCH_SOUTH)) {
+                trace_dump(ir_uart_putc);
+            }
+#endif
+            break;
+    }
+
+    if (game->game_mode != previous_mode) {
+        RECORD_BYTE(RECORD_MODE, game->game_mode);
+        TRACE_EVENT(TRACE_MODE, game->game_mode);
+        if (game->game_mode == PADDLE_MODE) {
+            // each round starts from a snapshot so a replay can begin there
+            RECORD_SNAPSHOT_OF(game, paddle, ball->speed, ball->timer >> BALL_FRACTION_BITS);
+        } else if (game->game_mode == DISPLAY_SCORE_MODE) {
+            stats_log_rally_over(&game->stats);
+        } else if (game->game_mode == GAME_OVER_MODE) {
+            // the record is written from the EEPROM interrupt while the result scrolls
+            stats_log_game_over(&game->stats, game->score == WINNING_SCORE,
+                                game->resyncs + game->ring.gaps + game->ring.duplicates + game->lockstep.resyncs);
+        }
+    }
 }
 
 
@@ -226,49 +620,15 @@ int main (void)
 {
     // initialise game play variables and structs
     initialise();
-    uint8_t bitmap[HEIGHT] = {0};
+    uint8_t bitmap[HEIGHT];
     Paddle paddle;
-    paddle_init(&paddle);
     Ball ball;
-
-    Game game = {
-        INITIAL_SCORE,
-        INITIAL_SCORE,
-        START_MENU,
-        INITIAL_COUNTER_VALUE,
-        INITIAL_COUNTER_VALUE,
-        INITIAL_COUNTER_VALUE,
-        INITIAL_COUNTER_VALUE
-        };
-
-    //set scroll text for main menu
-    scroll_text("PONG: PUSH TO START ");
+    Game game;
+    ball_init(&ball, 0, HEIGHT, STRAIGHT, UP, OFF_SCREEN); //round snapshots log its speed before the first serve
+    game_init(&game, &paddle, bitmap);
 
     while (1) {
         pacer_wait();
-        switch(game.game_mode) {
-            case START_MENU :
-                run_start_menu(&game);
-                break;
-
-            case PADDLE_MODE :
-                tinygl_clear();
-                run_paddle_only(&ball, &paddle, &game, bitmap);
-                break;
-
-            case PLAY_MODE :
-                play_round(&paddle, &ball, &game, bitmap);
-                break;
-
-            case DISPLAY_SCORE_MODE :
-                game.display_counter++;
-                display_character(game.score);
-                check_display_timeout(&game); //check if score displayed for long enough to return to game play
-                break;
-
-            case GAME_OVER_MODE :
-                tinygl_update();
-                break;
-        }
+        game_update(&game, &ball, &paddle, bitmap);
     }
 }
@@ -0,0 +1,63 @@
+/** @file game.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief game state machine shared by the firmware main loop and the host simulator
+ */
+
+
+#ifndef GAME_H
+#define GAME_H
+
+#include "system.h"
+#include "ball.h"
+#include "paddle.h"
+#include "ai.h"
+#include "balls.h"
+#include "ring.h"
+#include "lockstep.h"
+#include "stats_log.h"
+
+#define START_MENU 0
+#define PADDLE_MODE 1
+#define PLAY_MODE 2
+#define DISPLAY_SCORE_MODE 3
+#define GAME_OVER_MODE 4
+
+
+typedef struct {
+    char score;
+    char opponent_score;
+    uint8_t game_mode; //game modes: START_MENU = 0, PADDLE_MODE = 1, PLAY_MODE = 2, DISPLAY_SCORE_MODE = 3, GAME_OVER_MODE = 4
+    uint8_t column_counter;
+    uint8_t display_counter;
+    uint8_t display_cycle; //to count number of passed clock cycles
+    uint8_t round; //rounds served this game, modulo 16, carried in the round digest
+    uint8_t resyncs; //rounds where the other kit's digest disagreed and its state was taken
+    uint8_t single_player; //1 if the AI is the opponent, 0 if another kit is over IR
+    Ai ai;
+    uint8_t multi_ball; //1 if rounds are played with MULTI_BALLS balls
+    Balls balls;
+    uint8_t ring_mode; //1 if three or more kits share the court, see ring.h
+    Ring ring;
+    uint8_t lockstep_mode; //1 if both kits run the whole court from each other's inputs, see lockstep.h
+    Lockstep lockstep;
+    StatsLog stats; //totals kept in EEPROM across power cycles
+} Game;
+
+
+/** Reset game, paddle and display state ready for the start menu:
+    @param game a pointer to the game object
+    @param paddle a pointer to the paddle object
+    @param bitmap, an array indicating the current ledmat display */
+void game_init (Game* game, Paddle* paddle, uint8_t bitmap[]);
+
+
+/** Run one pacer tick of the game in its current mode:
+    @param game a pointer to the game object
+    @param ball a pointer to the ball object
+    @param paddle a pointer to the paddle object
+    @param bitmap, an array indicating the current ledmat display */
+void game_update (Game* game, Ball* ball, Paddle* paddle, uint8_t bitmap[]);
+
+
+#endif
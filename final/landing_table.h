@@ -0,0 +1,34 @@
+/** @file landing_table.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief column a ball entering the AI's screen reaches its paddle row in, stored in flash
+ */
+
+
+#ifndef LANDING_TABLE_H
+#define LANDING_TABLE_H
+
+#include "system.h"
+#include "ball.h"
+#include "progmem.h"
+
+#define landing_table_read(index) flash_read_byte(&landing_table[index])
+
+#define LANDING_TABLE_COLUMNS (RIGHT_WALL + 1)
+#define LANDING_TABLE_DIRECTIONS 3 //LEFT, STRAIGHT and RIGHT
+#define LANDING_TABLE_SIZE (LANDING_TABLE_COLUMNS * LANDING_TABLE_DIRECTIONS)
+
+
+/* landing_table.c is generated at build time by sim/landing_table_gen, which
+ * runs the branching update_location on a ball entering the top of the screen
+ * heading down, with no paddle in the way, until it reaches the paddle row. */
+
+
+/** Index of the entry for a ball entering in column x with an x direction */
+#define LANDING_TABLE_INDEX(x, direction_x) ((x) * LANDING_TABLE_DIRECTIONS + (direction_x) + 1)
+
+
+extern const uint8_t landing_table[LANDING_TABLE_SIZE] PROGMEM;
+
+
+#endif
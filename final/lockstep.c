@@ -0,0 +1,429 @@
+/** @file lockstep.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief lockstep mode: both kits simulate the whole court and exchange only timestamped paddle inputs
+ */
+
+
+#include "lockstep.h"
+#include "communications.h"
+#include "paddle.h"
+
+#define RING_MASK (LOCKSTEP_RING - 1)
+#define NO_SIDE 2
+#define POINTS_MASK 0x03 //points take two bits of the digest each
+#define DIGEST_MASK ((1 << LOCKSTEP_DIGEST_BITS) - 1)
+#define GROUP_MASK (LOCKSTEP_DIGEST_TURNS - 1)
+#define HASH_SHIFT 4 //the rest of the court is folded into digest bits 4-7
+#define CHECK_MASK 0x07 //the check symbol carries three bits, as every symbol 8-15
+#define CHECK_MIX 0x05 //mixed into the check symbol so a run of the same symbol does not pass
+
+
+/** Initialise the court for a new game:
+    @param state pointer to struct being initialised */
+static void state_init (LockstepState* state)
+{
+    ball_init(&state->ball, 0, HEIGHT, STRAIGHT, UP, OFF_SCREEN);
+    state->side = 0;
+    state->phase = LOCKSTEP_WAITING;
+    state->phase_turns = 0;
+    for (uint8_t i = 0; i < 2; i++) {
+        state->paddles[i] = PADDLE_START_POS;
+        state->points[i] = 0;
+        state->returns[i] = 0;
+    }
+}
+
+
+/** Pack the court into an eight bit digest: side 0's points in bits 0-1, side 1's in
+    bits 2-3, so a kit that disagrees can take them, and four bits folded from the rest:
+    @param state court to digest
+    @return the digest */
+static uint8_t state_digest (const LockstepState* state)
+{
+    const Ball* ball = &state->ball;
+    uint8_t hash = ball->x ^ ball->y << 3 ^ (uint8_t) ball->direction_x << 5 ^ (uint8_t) ball->direction_y << 6
+                 ^ ball->speed ^ state->side << 7 ^ state->phase << 1 ^ state->phase_turns
+                 ^ state->paddles[0] << 2 ^ state->paddles[1] << 4;
+    hash ^= hash >> HASH_SHIFT;
+    return state->points[0] | state->points[1] << 2 | hash << HASH_SHIFT;
+}
+
+
+/** Initialise a lockstep game as side 0, not yet started:
+    @param lockstep pointer to struct being initialised */
+void lockstep_init (Lockstep* lockstep)
+{
+    lockstep->side = 0;
+    lockstep->joined = 0;
+    lockstep->ticks = 0;
+    lockstep->turn = 0;
+    lockstep->confirmed = 0;
+    lockstep->received = LOCKSTEP_DELAY; //nobody sends the first turns, both kits start with the paddles still
+    lockstep->sent = LOCKSTEP_DELAY;
+    lockstep->sent_end = LOCKSTEP_DELAY;
+    lockstep->acked = LOCKSTEP_DELAY;
+    lockstep->checked = LOCKSTEP_DIGEST_TURNS; //the messages for the first turns are never sent, so the first digest never arrives whole
+    state_init(&lockstep->state);
+    uint8_t digest = state_digest(&lockstep->state); //messages for the first turns carry the digest of the start
+    for (uint8_t i = 0; i < LOCKSTEP_RING; i++) {
+        lockstep->inputs[0][i] = LOCKSTEP_INPUT + PADDLE_START_POS;
+        lockstep->inputs[1][i] = LOCKSTEP_INPUT + PADDLE_START_POS;
+        lockstep->digests[0][i] = digest;
+        lockstep->digests[1][i] = digest;
+    }
+    lockstep->length = 0;
+    lockstep->remote_pos = PADDLE_START_POS;
+    lockstep->serve = 0;
+    lockstep->stalled = 0;
+    lockstep->shown = lockstep->state;
+    lockstep->rollbacks = 0;
+    lockstep->resends = 0;
+    lockstep->resyncs = 0;
+    lockstep->stalls = 0;
+}
+
+
+/** Start a game as side 0 and tell the other kit to join:
+    @param lockstep pointer to lockstep struct */
+void lockstep_start (Lockstep* lockstep)
+{
+    lockstep->side = 0;
+    send_symbol(LOCKSTEP_START_EVENT);
+}
+
+
+/** Join a game after reading LOCKSTEP_START_EVENT, as side 1:
+    @param lockstep pointer to lockstep struct */
+void lockstep_join (Lockstep* lockstep)
+{
+    lockstep->side = 1;
+    lockstep->joined = 1;
+}
+
+
+/** Move the ball through one turn's pacer ticks on the side holding it, handing it
+    across mirrored as transmit_ball does, or scoring the point if it dies:
+    @param state court to step */
+static void step_rally (LockstepState* state)
+{
+    Ball* ball = &state->ball;
+    for (uint8_t tick = 0; tick < LOCKSTEP_TURN_TICKS; tick++) {
+        if (!ball_tick(ball)) {
+            continue;
+        }
+        int8_t falling = ball->direction_y == DOWN;
+        update_location(ball, state->paddles[state->side]);
+        if (falling && ball->direction_y == UP) {
+            state->returns[state->side]++;
+        }
+        if (!ball->on_screen) {
+            uint8_t speed = ball->speed;
+            ball_init(ball, RIGHT_WALL - ball->x, HEIGHT - 1, -ball->direction_x, DOWN, ON_SCREEN);
+            ball_set_speed(ball, speed);
+            state->side = !state->side;
+        } else if (ball->dead) {
+            state->points[!state->side]++;
+            state->phase = LOCKSTEP_POINT;
+            state->phase_turns = 0;
+            return;
+        }
+    }
+}
+
+
+/** Step the court through one turn:
+    @param state court to step
+    @param first input symbol of side 0
+    @param second input symbol of side 1 */
+static void step_turn (LockstepState* state, uint8_t first, uint8_t second)
+{
+    uint8_t inputs[2] = {first, second};
+    uint8_t server = NO_SIDE;
+    for (uint8_t i = 2; i-- > 0;) {
+        if (inputs[i] == LOCKSTEP_SERVE) {
+            server = i; //side 0 wins a tie, the same on both kits
+        } else {
+            state->paddles[i] = inputs[i] - LOCKSTEP_INPUT;
+        }
+    }
+
+    switch (state->phase) {
+        case LOCKSTEP_WAITING :
+            if (server != NO_SIDE) {
+                ball_init(&state->ball, state->paddles[server], 1, STRAIGHT, UP, ON_SCREEN);
+                state->side = server;
+                state->phase = LOCKSTEP_RALLY;
+            }
+            break;
+
+        case LOCKSTEP_RALLY :
+            step_rally(state);
+            break;
+
+        case LOCKSTEP_POINT :
+            if (++state->phase_turns >= LOCKSTEP_SCORE_TURNS) {
+                uint8_t over = state->points[0] >= LOCKSTEP_POINTS || state->points[1] >= LOCKSTEP_POINTS;
+                state->phase = over ? LOCKSTEP_OVER : LOCKSTEP_WAITING;
+            }
+            break;
+    }
+}
+
+
+/** Take side 0's points from its digest and wait for a serve, dropping the rally the kits disagreed on:
+    @param state court to resync
+    @param digest side 0's digest */
+static void resync (LockstepState* state, uint8_t digest)
+{
+    ball_init(&state->ball, 0, HEIGHT, STRAIGHT, UP, OFF_SCREEN);
+    state->side = 0;
+    state->phase_turns = 0;
+    state->points[0] = digest & POINTS_MASK;
+    state->points[1] = digest >> 2 & POINTS_MASK;
+    uint8_t over = state->points[0] >= LOCKSTEP_POINTS || state->points[1] >= LOCKSTEP_POINTS;
+    state->phase = over ? LOCKSTEP_OVER : LOCKSTEP_WAITING;
+}
+
+
+/** Work out the check symbol of a message, the exclusive or of the low bits of its other
+    symbols, so any one symbol corrupted into another changes it:
+    @param message the symbols before the check symbol
+    @param turn_symbol the turn symbol that ends the message
+    @return the check symbol */
+static uint8_t message_check (const uint8_t message[], uint8_t turn_symbol)
+{
+    uint8_t check = turn_symbol ^ CHECK_MIX;
+    for (uint8_t i = 0; i < LOCKSTEP_MESSAGE_LENGTH - 1; i++) {
+        check ^= message[i];
+    }
+    return LOCKSTEP_INPUT + (check & CHECK_MASK);
+}
+
+
+/** Act on a whole message: take its ack, and its input and digest bits if its turn is the next one we lack:
+    @param lockstep pointer to lockstep struct
+    @param turn_symbol the turn symbol that closed it */
+static void take_message (Lockstep* lockstep, uint8_t turn_symbol)
+{
+    const uint8_t* message = lockstep->message;
+    if (message_check(message, turn_symbol) != message[LOCKSTEP_MESSAGE_LENGTH - 1]) {
+        return; //a symbol was corrupted into another one, so none of it can be trusted
+    }
+    uint8_t ack = message[1] & LOCKSTEP_TURN_MASK;
+    lockstep->joined = 1;
+    //its count is never more than 3 behind one past the latest turn we sent, as we send at most LOCKSTEP_RESEND_TURNS past its ack
+    lockstep->acked = lockstep->sent_end - ((lockstep->sent_end - ack) & LOCKSTEP_TURN_MASK);
+
+    if ((turn_symbol & LOCKSTEP_TURN_MASK) != (lockstep->received & LOCKSTEP_TURN_MASK)) {
+        return; //one we already have, or one after a lost turn, which comes again
+    }
+    uint8_t symbol = message[0];
+    if ((int16_t) (lockstep->turn - lockstep->received) > 0 && symbol != LOCKSTEP_INPUT + lockstep->remote_pos) {
+        //its turn has been shown with the wrong input, the next turn reruns it
+        lockstep->rollbacks++;
+    }
+    lockstep->inputs[!lockstep->side][lockstep->received & RING_MASK] = symbol;
+    //turns are taken in order, so the group's digest is whole once its last turn is in
+    uint8_t* digest = &lockstep->digests[!lockstep->side][(lockstep->received & ~GROUP_MASK) & RING_MASK];
+    uint8_t shift = (lockstep->received & GROUP_MASK) * LOCKSTEP_DIGEST_BITS;
+    uint8_t bits = (message[1] & LOCKSTEP_DIGEST_BIT) >> 2 | (turn_symbol & LOCKSTEP_DIGEST_BIT) >> 1;
+    *digest = (shift ? *digest : 0) | bits << shift;
+    lockstep->received++;
+    if (symbol != LOCKSTEP_SERVE) {
+        lockstep->remote_pos = symbol - LOCKSTEP_INPUT;
+    }
+}
+
+
+/** Read every symbol that has arrived. The turn symbol ends a message, and it is only taken
+    if exactly its other symbols came just before, so one that lost a symbol, or that ran
+    into the one before it, is dropped rather than read out of place:
+    @param lockstep pointer to lockstep struct */
+static void receive_messages (Lockstep* lockstep)
+{
+    while (ir_uart_read_ready_p()) {
+        uint8_t symbol = read_symbol();
+        if (symbol >= LOCKSTEP_INPUT) {
+            if (lockstep->length < LOCKSTEP_MESSAGE_LENGTH) {
+                lockstep->message[lockstep->length] = symbol;
+            }
+            if (lockstep->length <= LOCKSTEP_MESSAGE_LENGTH) {
+                lockstep->length++; //one past a whole message means too many
+            }
+            continue;
+        }
+        if (lockstep->length == LOCKSTEP_MESSAGE_LENGTH) {
+            take_message(lockstep, symbol);
+        }
+        lockstep->length = 0;
+    }
+}
+
+
+/** Step the confirmed court through every turn both inputs are in for, up to the current one,
+    first resyncing if that turn ends a group whose digests disagree:
+    @param lockstep pointer to lockstep struct
+    @return LOCKSTEP_RETURN if this kit returned the ball on one of those turns, else 0 */
+static uint8_t confirm_turns (Lockstep* lockstep)
+{
+    LockstepState* state = &lockstep->state;
+    uint8_t returns = state->returns[lockstep->side];
+    while (lockstep->confirmed != lockstep->received && lockstep->confirmed != lockstep->turn) {
+        uint8_t index = lockstep->confirmed & RING_MASK;
+        uint16_t group = lockstep->confirmed & ~GROUP_MASK;
+        uint8_t group_index = group & RING_MASK;
+        if ((lockstep->confirmed & GROUP_MASK) == GROUP_MASK && (int16_t) (group - lockstep->checked) >= 0
+            && lockstep->digests[0][group_index] != lockstep->digests[1][group_index]) {
+            //both kits see the same pair of digests, so both resync on this turn
+            resync(state, lockstep->digests[0][group_index]);
+            lockstep->checked = lockstep->confirmed + LOCKSTEP_CHECK_TURNS + 1;
+            lockstep->resyncs++;
+        }
+        step_turn(state, lockstep->inputs[0][index], lockstep->inputs[1][index]);
+        lockstep->confirmed++;
+        lockstep->digests[lockstep->side][(lockstep->confirmed + LOCKSTEP_CHECK_TURNS) & RING_MASK] = state_digest(state);
+    }
+    return returns != state->returns[lockstep->side] ? LOCKSTEP_RETURN : 0;
+}
+
+
+/** Rerun the shown court from the confirmed one, predicting the other kit's paddle stays put:
+    @param lockstep pointer to lockstep struct */
+static void predict_turns (Lockstep* lockstep)
+{
+    uint8_t side = lockstep->side;
+    uint8_t predicted = LOCKSTEP_INPUT + lockstep->remote_pos;
+    lockstep->shown = lockstep->state;
+    for (uint16_t turn = lockstep->confirmed; turn != lockstep->turn; turn++) {
+        uint8_t own = lockstep->inputs[side][turn & RING_MASK];
+        step_turn(&lockstep->shown, side ? predicted : own, side ? own : predicted);
+    }
+}
+
+
+/** Choose this kit's input for the turn LOCKSTEP_DELAY turns from now:
+    @param lockstep pointer to lockstep struct
+    @param paddle this kit's paddle position */
+static void choose_input (Lockstep* lockstep, uint8_t paddle)
+{
+    uint16_t turn = lockstep->turn + LOCKSTEP_DELAY;
+    lockstep->inputs[lockstep->side][turn & RING_MASK] = lockstep->serve ? LOCKSTEP_SERVE : LOCKSTEP_INPUT + paddle;
+    lockstep->serve = 0;
+}
+
+
+/** Send one message: the next input the other kit has not acked, the turns we have its
+    inputs for, a check symbol and last the input's turn symbol, the ack and turn symbols
+    each carrying a bit of the digest of the input's group.
+    Once the newest input is out, or too many are unacked, go back to the first it lacks:
+    @param lockstep pointer to lockstep struct */
+static void send_message (Lockstep* lockstep)
+{
+    if (!lockstep->joined) {
+        //nothing from the other kit yet, it may have missed the start, and would read a message as some other start
+        send_symbol(LOCKSTEP_START_EVENT);
+        return;
+    }
+    uint16_t end = lockstep->turn + LOCKSTEP_DELAY; //one past the newest input chosen
+    if ((int16_t) (lockstep->acked - lockstep->sent) > 0) {
+        lockstep->sent = lockstep->acked; //it has these already
+    }
+    if (lockstep->sent == end || (uint16_t) (lockstep->sent - lockstep->acked) >= LOCKSTEP_RESEND_TURNS) {
+        lockstep->sent = lockstep->acked;
+    }
+    uint16_t turn = lockstep->sent;
+    if (turn == end) {
+        turn--; //it has them all, the newest goes again to carry our ack
+    } else {
+        if ((int16_t) (turn - lockstep->sent_end) < 0) {
+            lockstep->resends++;
+        } else {
+            lockstep->sent_end = turn + 1;
+        }
+        lockstep->sent++;
+    }
+
+    uint8_t digest = lockstep->digests[lockstep->side][(turn & ~GROUP_MASK) & RING_MASK];
+    uint8_t bits = digest >> (turn & GROUP_MASK) * LOCKSTEP_DIGEST_BITS & DIGEST_MASK;
+    uint8_t turn_symbol = (turn & LOCKSTEP_TURN_MASK) | (bits & 0x02) << 1;
+    uint8_t message[LOCKSTEP_MESSAGE_LENGTH] = {
+        lockstep->inputs[lockstep->side][turn & RING_MASK],
+        LOCKSTEP_INPUT + (lockstep->received & LOCKSTEP_TURN_MASK) + (bits & 0x01) * LOCKSTEP_DIGEST_BIT,
+    };
+    message[LOCKSTEP_MESSAGE_LENGTH - 1] = message_check(message, turn_symbol);
+    for (uint8_t i = 0; i < LOCKSTEP_MESSAGE_LENGTH; i++) {
+        send_symbol(message[i]);
+    }
+    send_symbol(turn_symbol);
+}
+
+
+/** Run one pacer tick: read inputs as they arrive and step a turn when one is due:
+    @param lockstep pointer to lockstep struct
+    @param paddle this kit's paddle position
+    @param serve 1 if this kit's player pushed serve this tick
+    @return LOCKSTEP_RETURN if a confirmed turn had this kit return the ball, else 0 */
+uint8_t lockstep_update (Lockstep* lockstep, uint8_t paddle, uint8_t serve)
+{
+    lockstep->serve |= serve;
+    receive_messages(lockstep);
+    if (++lockstep->ticks < LOCKSTEP_TURN_TICKS) {
+        return 0;
+    }
+
+    uint8_t events = confirm_turns(lockstep);
+    if ((uint16_t) (lockstep->turn - lockstep->confirmed) >= LOCKSTEP_WINDOW) {
+        //too far ahead to keep guessing, wait for the other kit and try again next tick
+        if (!lockstep->stalled++) {
+            lockstep->stalls++;
+        }
+        if (lockstep->stalled % LOCKSTEP_TURN_TICKS == 0) {
+            send_message(lockstep); //keep acking, and resending what it lacks
+        }
+        lockstep->ticks--;
+        return events;
+    }
+
+    lockstep->ticks = 0;
+    lockstep->stalled = 0;
+    choose_input(lockstep, paddle);
+    lockstep->turn++;
+    send_message(lockstep);
+    if (lockstep->joined && lockstep->sent != lockstep->turn + LOCKSTEP_DELAY) {
+        send_message(lockstep); //behind after a resend or a late join, catch up
+    }
+    events |= confirm_turns(lockstep);
+    predict_turns(lockstep);
+    return events;
+}
+
+
+/** Keep reading and answering the other kit once the game is over here, until it has acked
+    every input of ours up to our confirmed turn, so it can finish the game too:
+    @param lockstep pointer to lockstep struct */
+void lockstep_finish (Lockstep* lockstep)
+{
+    receive_messages(lockstep);
+    if (++lockstep->ticks < LOCKSTEP_TURN_TICKS) {
+        return;
+    }
+    lockstep->ticks = 0;
+    if ((int16_t) (lockstep->acked - lockstep->confirmed) < 0) {
+        send_message(lockstep);
+    }
+}
+
+
+/** Copy the ball of the shown court, on screen only while it is on this kit's side:
+    @param lockstep pointer to lockstep struct
+    @param ball ball to place it in */
+void lockstep_get_ball (const Lockstep* lockstep, Ball* ball)
+{
+    const LockstepState* shown = &lockstep->shown;
+    if (shown->phase != LOCKSTEP_WAITING && shown->side == lockstep->side) {
+        *ball = shown->ball;
+    } else {
+        ball_init(ball, 0, HEIGHT, STRAIGHT, UP, OFF_SCREEN);
+    }
+}
@@ -0,0 +1,127 @@
+/** @file lockstep.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief lockstep mode: both kits simulate the whole court and exchange only timestamped paddle inputs
+ */
+
+
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include "system.h"
+#include "ball.h"
+#include "timing.h"
+
+#define LOCKSTEP_START_EVENT 7 //sent on the start menu, the kit reading it joins as side 1
+#define LOCKSTEP_TURN_TICKS (PACER_RATE * 3 / 50) //pacer ticks per turn, 60 ms
+#define LOCKSTEP_DELAY 1 //turns between reading an input and applying it, so it usually arrives in time
+#define LOCKSTEP_WINDOW 4 //turns the shown court may run ahead of the confirmed one before we wait
+#define LOCKSTEP_RESEND_TURNS 3 //inputs sent past the other kit's last ack before going back to the first it lacks, under 4 so turn symbols are never ambiguous
+#define LOCKSTEP_CHECK_TURNS (LOCKSTEP_DELAY + LOCKSTEP_WINDOW) //a message's digest is of the confirmed court this many turns before its input
+#define LOCKSTEP_RING 32 //inputs and digests kept per side, a power of two covering every turn sent but not acked
+#define LOCKSTEP_TURN_MASK 0x03 //turn symbols are 0-7, the turn number modulo 4 in bits 0-1
+#define LOCKSTEP_DIGEST_BIT 0x04 //bit of the ack and turn symbols carrying a digest bit
+#define LOCKSTEP_INPUT 8 //input symbols are LOCKSTEP_INPUT plus the paddle position, 8-14
+#define LOCKSTEP_SERVE 15 //input symbol for a serve, the paddle stays where it was
+#define LOCKSTEP_MESSAGE_LENGTH 3 //symbols 8-15 before the turn symbol that ends a message: input, ack and a check
+#define LOCKSTEP_DIGEST_TURNS 4 //turns whose messages carry one digest between them, from the first turn's court
+#define LOCKSTEP_DIGEST_BITS 2 //digest bits carried by each message, one in the ack and one in the turn symbol
+#define LOCKSTEP_SCORE_TURNS 64 //turns the score shows after a point, as long as the other modes show it
+#define LOCKSTEP_POINTS 3 //points that win, as WINNING_SCORE in game.c
+
+#define LOCKSTEP_WAITING 0 //phases of the court
+#define LOCKSTEP_RALLY 1
+#define LOCKSTEP_POINT 2
+#define LOCKSTEP_OVER 3
+
+#define LOCKSTEP_RETURN 1 //lockstep_update event: this kit's paddle returned the ball on a confirmed turn
+
+
+/** The whole court, identical on both kits for the same turn and inputs */
+typedef struct {
+    Ball ball; //in the screen coordinates of the side holding it
+    uint8_t side; //side the ball is on, 0 for the kit that started the game
+    uint8_t phase; //LOCKSTEP_WAITING, LOCKSTEP_RALLY, LOCKSTEP_POINT or LOCKSTEP_OVER
+    uint8_t phase_turns; //turns the score has shown for
+    uint8_t paddles[2];
+    uint8_t points[2];
+    uint8_t returns[2]; //paddle returns by each side, modulo 256
+} LockstepState;
+
+
+/** Define data associated with a lockstep game */
+typedef struct lockstep_s Lockstep;
+
+
+/** Lockstep structure. Each turn both kits send the input they will apply LOCKSTEP_DELAY
+    turns later. The court is stepped for good up to the last turn with both inputs in,
+    and shown from a copy run on to the current turn with the other kit's paddle predicted
+    to stay put. A late input that differs from the prediction is corrected on the next
+    turn, since the copy is rerun from the confirmed court every turn.
+    Inputs are only taken in order, and each message acks the other kit's, so one that is
+    lost is sent again rather than guessed. Each message also carries two bits of a digest of
+    the sender's confirmed court, checked once every turn of its group is confirmed. When the digests disagree
+    both kits take side 0's points and the rally is played again */
+struct lockstep_s {
+    uint8_t side; //this kit's side
+    uint8_t joined; //1 once side 0 has heard from side 1, until then it sends the start event again instead of messages
+    uint8_t ticks; //pacer ticks into the current turn
+    uint16_t turn; //turns stepped in the shown court
+    uint16_t confirmed; //turns stepped in the confirmed court
+    uint16_t received; //turns the other kit's input is in for
+    uint16_t sent; //next turn to send this kit's input for
+    uint16_t sent_end; //one past the latest turn sent
+    uint16_t acked; //turns the other kit had this kit's input for, as of its last message
+    uint16_t checked; //first turn whose digests are compared, those before were taken before a resync or never sent whole
+    uint8_t inputs[2][LOCKSTEP_RING]; //input symbols by side and turn
+    uint8_t digests[2][LOCKSTEP_RING]; //digests by side and the first turn of the group of messages carrying them
+    uint8_t message[LOCKSTEP_MESSAGE_LENGTH]; //symbols of the message being read
+    uint8_t length; //symbols read since the last turn symbol, up to one more than a message holds
+    uint8_t remote_pos; //last paddle position the other kit sent
+    uint8_t serve; //1 if serve was pushed during this turn
+    uint16_t stalled; //ticks spent waiting for the other kit
+    LockstepState state; //confirmed court
+    LockstepState shown; //predicted court, at the current turn
+    uint16_t rollbacks; //inputs that arrived after their turn was shown, and differed from the prediction
+    uint16_t resends; //inputs sent again because the other kit had not acked them
+    uint16_t resyncs; //turns where the digests disagreed and side 0's points were taken
+    uint16_t stalls; //turns started late, waiting for the other kit
+};
+
+
+/** Initialise a lockstep game as side 0, not yet started:
+    @param lockstep pointer to struct being initialised */
+void lockstep_init (Lockstep* lockstep);
+
+
+/** Start a game as side 0 and tell the other kit to join:
+    @param lockstep pointer to lockstep struct */
+void lockstep_start (Lockstep* lockstep);
+
+
+/** Join a game after reading LOCKSTEP_START_EVENT, as side 1:
+    @param lockstep pointer to lockstep struct */
+void lockstep_join (Lockstep* lockstep);
+
+
+/** Run one pacer tick: read inputs as they arrive and step a turn when one is due:
+    @param lockstep pointer to lockstep struct
+    @param paddle this kit's paddle position
+    @param serve 1 if this kit's player pushed serve this tick
+    @return LOCKSTEP_RETURN if a confirmed turn had this kit return the ball, else 0 */
+uint8_t lockstep_update (Lockstep* lockstep, uint8_t paddle, uint8_t serve);
+
+
+/** Keep reading and answering the other kit once the game is over here, until it has acked
+    every input of ours up to our confirmed turn, so it can finish the game too:
+    @param lockstep pointer to lockstep struct */
+void lockstep_finish (Lockstep* lockstep);
+
+
+/** Copy the ball of the shown court, on screen only while it is on this kit's side:
+    @param lockstep pointer to lockstep struct
+    @param ball ball to place it in */
+void lockstep_get_ball (const Lockstep* lockstep, Ball* ball);
+
+
+#endif
@@ -7,10 +7,16 @@
 
 
 #include "pong_display.h"
+#include "progmem.h"
+#include "tracer.h"
+
+
+static PongDisplay display_state;
+DISPLAY_POINTER_STORAGE PongDisplay* pong_display = &display_state;
 
 
 /** Define PIO pins driving LED matrix rows.  */
-static const pio_t rows[] = {
+static const pio_t rows[] PROGMEM = {
     LEDMAT_ROW1_PIO, LEDMAT_ROW2_PIO, LEDMAT_ROW3_PIO,
     LEDMAT_ROW4_PIO, LEDMAT_ROW5_PIO, LEDMAT_ROW6_PIO,
     LEDMAT_ROW7_PIO
@@ -18,7 +24,7 @@ static const pio_t rows[] = {
 
 
 /** Define PIO pins driving LED matrix columns.  */
-static const pio_t cols[] = {
+static const pio_t cols[] PROGMEM = {
     LEDMAT_COL1_PIO, LEDMAT_COL2_PIO, LEDMAT_COL3_PIO,
     LEDMAT_COL4_PIO, LEDMAT_COL5_PIO
 };
@@ -29,34 +35,50 @@ void init_led_matrix (void)
 {
     /* Initialise LED matrix pins.  */
     for (int i = 0; i < 5; i++) {
-        pio_config_set(cols[i], PIO_OUTPUT_HIGH);
+        pio_config_set(flash_read_byte(&cols[i]), PIO_OUTPUT_HIGH);
     }
     for (int i = 0; i < 7; i++) {
-        pio_config_set(rows[i], PIO_OUTPUT_HIGH);
+        pio_config_set(flash_read_byte(&rows[i]), PIO_OUTPUT_HIGH);
     }
 }
 
 
-static pio_t prev;
 /** Flash the correct bit pattern for current column in led matrix:
     @param row_pattern the bitmap of which leds we want to light
     @param current_column, the index of the column we are currently flashing */
 void display_column (uint8_t row_pattern, uint8_t current_column)
 {
-    pio_output_high(cols[prev]);
-    prev = current_column;
+    pio_output_high(flash_read_byte(&cols[pong_display->prev]));
+    pong_display->prev = current_column;
     for (int current_row = 0; current_row < 7; current_row++) {
         if ((row_pattern >> current_row) & 1) {
-            pio_output_low(rows[current_row]);
+            pio_output_low(flash_read_byte(&rows[current_row]));
         } else {
-            pio_output_high(rows[current_row]);
+            pio_output_high(flash_read_byte(&rows[current_row]));
         }
     }
     //change after updating rows to prevent ghosting
-    pio_output_low(cols[current_column]);
+    pio_output_low(flash_read_byte(&cols[current_column]));
 }
 
 
+#if defined(TRACE) && TRACE >= TRACE_LEVEL_DISPLAY
+/** Count the LEDs a bitmap lights, for the frame tracepoint:
+    @param bitmap the pattern on the display
+    @return number of lit LEDs */
+static uint8_t lit_leds (const uint8_t bitmap[])
+{
+    uint8_t lit = 0;
+    for (uint8_t column = 0; column < LEDMAT_COLS_NUM; column++) {
+        for (uint8_t row = bitmap[column]; row; row >>= 1) {
+            lit += row & 1;
+        }
+    }
+    return lit;
+}
+#endif
+
+
 /** Update the led matrix to display given bitmap, flashing 1 column at a time:
     @param bitmap the pattern we want to light up
     @param current_column the column we are currently flashing
@@ -70,19 +92,24 @@ uint8_t update_display (uint8_t bitmap[], uint8_t current_column)
     current_column++;
     if (current_column > (LEDMAT_COLS_NUM - 1)) {
         current_column = 0;
+        TRACE_DISPLAY(TRACE_FRAME, lit_leds(bitmap));
     }
     return current_column;
 }
 
 
 /** Setup tinygl to display given text in scrolling mode:
-    @param text, the characters to display */
-void scroll_text (char* text)
+    @param text, the characters to display, in flash (use PSTR) */
+void scroll_text (const char* text)
 {
+    char* buffer = pong_display->text;
+    flash_string_copy(buffer, text, DISPLAY_TEXT_LENGTH - 1);
+    buffer[DISPLAY_TEXT_LENGTH - 1] = '\0';
+    TRACE_EVENT(TRACE_SCROLL, buffer[0]);
     tinygl_init (PACER_RATE);
     tinygl_font_set (&font5x7_1);
     tinygl_text_speed_set (MESSAGE_RATE);
-    tinygl_text (text);
+    tinygl_text (buffer);
     tinygl_text_mode_set (TINYGL_TEXT_MODE_SCROLL);
 }
 
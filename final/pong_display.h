@@ -15,11 +15,26 @@
 #include "pacer.h"
 #include "tinygl.h"
 #include "system.h"
+#include "timing.h"
 #include "../fonts/font5x7_1.h"
 #include "../fonts/font3x5_1.h"
 
-#define PACER_RATE 600
-#define MESSAGE_RATE 10
+#ifndef DISPLAY_POINTER_STORAGE
+#define DISPLAY_POINTER_STORAGE //the simulator makes the pointer thread local, as it does the tracer's
+#endif
+
+#define DISPLAY_TEXT_LENGTH 21 //longest scrolling message, with its terminator
+
+
+/** Display state kept between calls. The firmware has exactly one of these, the simulator gives one to each kit */
+typedef struct {
+    pio_t prev; //column driven last, turned off before the next one is driven
+    char text[DISPLAY_TEXT_LENGTH]; //tinygl keeps a pointer to the text it scrolls, so flash strings are copied here
+} PongDisplay;
+
+
+/** The display state in use */
+extern DISPLAY_POINTER_STORAGE PongDisplay* pong_display;
 
 
 /** Initialise the columns of the led matrix: */
@@ -40,8 +55,8 @@ uint8_t update_display (uint8_t bitmap[], uint8_t current_column);
 
 
 /** Setup tinygl to display given text in scrolling mode:
-    @param text, the characters to display */
-void scroll_text (char* text);
+    @param text, the characters to display, in flash (use PSTR) */
+void scroll_text (const char* text);
 
 
 /** Flash a single character onto the screen:
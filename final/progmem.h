@@ -0,0 +1,34 @@
+/** @file progmem.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief constant tables and strings kept in flash rather than copied into SRAM at start-up
+ */
+
+
+#ifndef PROGMEM_H
+#define PROGMEM_H
+
+#include "system.h"
+
+/* avr-gcc copies every const array into the 1 KB of SRAM at start-up unless
+ * it is marked PROGMEM. A table marked PROGMEM stays in flash and has to be
+ * read with the accessors below. They are plain reads on the host. */
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#define flash_read_byte(address) pgm_read_byte(address)
+#define flash_read_word(address) pgm_read_word(address)
+#define flash_read_block(destination, source, length) memcpy_P(destination, source, length)
+#define flash_string_copy(destination, source, length) strncpy_P(destination, source, length)
+#else
+#include <string.h>
+#define PROGMEM
+#define PSTR(text) (text)
+#define flash_read_byte(address) (*(const uint8_t*) (address))
+#define flash_read_word(address) (*(const uint16_t*) (address))
+#define flash_read_block(destination, source, length) memcpy(destination, source, length)
+#define flash_string_copy(destination, source, length) strncpy(destination, source, length)
+#endif
+
+
+#endif
@@ -0,0 +1,209 @@
+/** @file recorder.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief record mode: log IR traffic, navswitch events and mode changes for host replay
+ */
+
+
+#include "recorder.h"
+#include "navswitch.h"
+
+#ifdef RECORD
+
+#define VARINT_MORE 0x80
+#define VARINT_MASK 0x7F
+#define MAX_RECORD_LENGTH (1 + 5 + RECORD_SNAPSHOT_LENGTH)
+
+
+static Recorder recorder_state;
+RECORD_POINTER_STORAGE Recorder* recorder = &recorder_state;
+
+
+/** Return the log byte at an offset from the oldest record:
+    @param offset bytes from the oldest record */
+static uint8_t ring_byte (uint16_t offset)
+{
+    return recorder->buffer[((uint32_t) recorder->start + offset) % RECORD_BUFFER_SIZE];
+}
+
+
+/** Drop the oldest record to make room, moving base_tick past it */
+static void drop_oldest (void)
+{
+    uint8_t header = ring_byte(0);
+    uint16_t used = 1;
+    uint32_t delta = header >> RECORD_TYPE_BITS;
+    if (delta == RECORD_SHORT_DELTA) {
+        uint8_t shift = 0;
+        uint8_t byte;
+        do {
+            byte = ring_byte(used++);
+            delta += (uint32_t) (byte & VARINT_MASK) << shift;
+            shift += 7;
+        } while (byte & VARINT_MORE);
+    }
+    if ((header & RECORD_TYPE_MASK) == RECORD_SNAPSHOT) {
+        used += RECORD_SNAPSHOT_LENGTH;
+        recorder->snapshots--;
+    } else {
+        used++;
+    }
+
+    recorder->base_tick += delta;
+    recorder->start = ((uint32_t) recorder->start + used) % RECORD_BUFFER_SIZE;
+    recorder->length -= used;
+}
+
+
+/** Append a whole record, dropping old ones first if it does not fit. The newest
+    snapshot is kept instead, turning this record and the rest of its round away:
+    @param record the encoded record
+    @param length its length in bytes */
+static void append (const uint8_t record[], uint8_t length)
+{
+    if (recorder->full) {
+        return;
+    }
+    while (RECORD_BUFFER_SIZE - recorder->length < length) {
+        if (recorder->snapshots == 1 && (ring_byte(0) & RECORD_TYPE_MASK) == RECORD_SNAPSHOT) {
+            recorder->full = 1;
+            recorder->full_tick = recorder->tick;
+            return;
+        }
+        drop_oldest();
+    }
+    if ((record[0] & RECORD_TYPE_MASK) == RECORD_SNAPSHOT) {
+        recorder->snapshots++;
+    }
+    for (uint8_t i = 0; i < length; i++) {
+        recorder->buffer[((uint32_t) recorder->start + recorder->length) % RECORD_BUFFER_SIZE] = record[i];
+        recorder->length++;
+    }
+}
+
+
+/** Encode a record header for the current tick:
+    @param record where to place the header
+    @param type record type
+    @return number of bytes written */
+static uint8_t encode_header (uint8_t record[], uint8_t type)
+{
+    uint32_t delta = recorder->tick - recorder->last_tick;
+    uint8_t length = 1;
+    recorder->last_tick = recorder->tick;
+
+    if (delta < RECORD_SHORT_DELTA) {
+        record[0] = type | delta << RECORD_TYPE_BITS;
+    } else {
+        record[0] = type | RECORD_SHORT_DELTA << RECORD_TYPE_BITS;
+        delta -= RECORD_SHORT_DELTA;
+        while (delta > VARINT_MASK) {
+            record[length++] = (delta & VARINT_MASK) | VARINT_MORE;
+            delta >>= 7;
+        }
+        record[length++] = delta;
+    }
+    return length;
+}
+
+
+/** Clear the log and restart the tick count:
+    @param tick tick to count from */
+void record_init (uint32_t tick)
+{
+    recorder->start = 0;
+    recorder->length = 0;
+    recorder->base_tick = tick;
+    recorder->last_tick = tick;
+    recorder->tick = tick;
+    recorder->snapshots = 0;
+    recorder->full = 0;
+    recorder->full_tick = 0;
+}
+
+
+/** Count one pass of the main loop */
+void record_tick (void)
+{
+    recorder->tick++;
+}
+
+
+/** Append a record with a single payload byte:
+    @param type one of RECORD_RX, RECORD_TX, RECORD_NAV or RECORD_MODE
+    @param value the payload */
+void record_event (uint8_t type, uint8_t value)
+{
+    uint8_t record[MAX_RECORD_LENGTH];
+    uint8_t length = encode_header(record, type);
+    record[length++] = value;
+    append(record, length);
+}
+
+
+/** Append the navswitch push events seen by the last navswitch_update, if any */
+void record_navswitch (void)
+{
+    uint8_t events = 0;
+    for (uint8_t i = 0; i < NAVSWITCH_NUM; i++) {
+        if (navswitch_push_event_p(i)) {
+            events |= 1 << i;
+        }
+    }
+    if (events) {
+        record_event(RECORD_NAV, events);
+    }
+}
+
+
+/** Append a snapshot of the state a replay needs to start from:
+    @param snapshot RECORD_SNAPSHOT_LENGTH bytes laid out as the RECORD_SNAP_* offsets */
+void record_snapshot (const uint8_t snapshot[])
+{
+    uint8_t record[MAX_RECORD_LENGTH];
+    if (recorder->full) {
+        // the round the ring filled on can only be replayed up to there, start afresh from this one
+        recorder->start = 0;
+        recorder->length = 0;
+        recorder->base_tick = recorder->last_tick;
+        recorder->snapshots = 0;
+        recorder->full = 0;
+    }
+    uint8_t length = encode_header(record, RECORD_SNAPSHOT);
+    for (uint8_t i = 0; i < RECORD_SNAPSHOT_LENGTH; i++) {
+        record[length++] = snapshot[i];
+    }
+    append(record, length);
+}
+
+
+/** Write a varint to a dump:
+    @param write function called with each byte
+    @param value value to write */
+static void dump_varint (void (*write) (char), uint32_t value)
+{
+    while (value > VARINT_MASK) {
+        write((value & VARINT_MASK) | VARINT_MORE);
+        value >>= 7;
+    }
+    write(value);
+}
+
+
+/** Write the log out as a dump, oldest record first:
+    @param write function called with each byte of the dump */
+void record_dump (void (*write) (char))
+{
+    write(RECORD_MAGIC_0);
+    write(RECORD_MAGIC_1);
+    write(RECORD_VERSION);
+    dump_varint(write, recorder->base_tick);
+    write(recorder->full);
+    dump_varint(write, recorder->full_tick);
+    dump_varint(write, recorder->length);
+    for (uint16_t i = 0; i < recorder->length; i++) {
+        write(ring_byte(i));
+    }
+}
+
+#endif
@@ -0,0 +1,166 @@
+/** @file recorder.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief record mode: log IR traffic, navswitch events and mode changes for host replay
+ */
+
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include "system.h"
+
+#ifndef RECORD_BUFFER_SIZE
+#define RECORD_BUFFER_SIZE 256 //bytes of SRAM given to the log, at most 65535
+#endif
+
+#ifndef RECORD_POINTER_STORAGE
+#define RECORD_POINTER_STORAGE //the simulator makes the pointer thread local, as it does the tracer's
+#endif
+
+#define RECORD_MAGIC_0 'P'
+#define RECORD_MAGIC_1 'R'
+#define RECORD_VERSION 3
+#define RECORD_TYPE_BITS 3
+#define RECORD_TYPE_MASK 0x07
+#define RECORD_SHORT_DELTA 31 //largest delta stored in the header byte itself
+#define RECORD_SNAPSHOT_LENGTH 16
+
+#define RECORD_RX 0 //byte read from the IR UART
+#define RECORD_TX 1 //byte written to the IR UART
+#define RECORD_NAV 2 //bitmask of navswitch push events
+#define RECORD_MODE 3 //new game mode
+#define RECORD_SNAPSHOT 4 //the game state a replay needs to start from, laid out below
+
+// bytes of a snapshot
+#define RECORD_SNAP_MODE 0
+#define RECORD_SNAP_SCORE 1
+#define RECORD_SNAP_OPPONENT_SCORE 2
+#define RECORD_SNAP_PADDLE 3
+#define RECORD_SNAP_BALL_TIMER 4 //whole pacer ticks since the ball last stepped
+#define RECORD_SNAP_ROUND 5
+#define RECORD_SNAP_FLAGS 6 //RECORD_FLAG_* bits
+#define RECORD_SNAP_BALL_SPEED 7
+#define RECORD_SNAP_AI_PADDLE 8
+#define RECORD_SNAP_AI_TARGET 9
+#define RECORD_SNAP_AI_REACTION 10
+#define RECORD_SNAP_AI_MOVE_COUNTER 11
+#define RECORD_SNAP_AI_SERVE_COUNTER 12
+#define RECORD_SNAP_AI_LEVEL 13
+#define RECORD_SNAP_AI_RANDOM 14 //two bytes, low byte first
+
+#define RECORD_FLAG_SINGLE_PLAYER 0x01
+#define RECORD_FLAG_MULTI_BALL 0x02
+#define RECORD_FLAG_RING 0x04
+#define RECORD_FLAG_LOCKSTEP 0x08
+
+
+/* Records are packed oldest first into a ring buffer. Each starts with a header
+ * byte holding the record type in its low 3 bits and the pacer ticks since the
+ * previous record in its high 5 bits. Deltas of 31 or more store 31 there and
+ * the remainder follows as a little-endian base-128 varint. The header is
+ * followed by one payload byte, or RECORD_SNAPSHOT_LENGTH bytes for a
+ * snapshot. When the ring is full the oldest records are dropped.
+ * Snapshots are taken at power-on and at the start of each round, so a replay
+ * can always begin from the oldest snapshot still in the buffer. The newest
+ * snapshot is never dropped: once it is the oldest record left and the ring
+ * fills, further records are turned away until the next snapshot, which
+ * clears the ring and starts it afresh. A round too long for the ring is
+ * then kept from its start up to the tick the ring filled.
+ * A snapshot holds the mode flags, AI and ball speed as well as the score,
+ * but not the ring or lockstep courts, so those games replay only from
+ * power-on.
+ *
+ * A dump is "PR", RECORD_VERSION, the varint tick the first record's delta
+ * counts from, 1 if records were turned away and the varint tick that began,
+ * the varint length of the records, then the records themselves.
+ *
+ * Recording is compiled in with -DRECORD. Without it every RECORD_* macro
+ * expands to nothing. */
+
+
+/** Log state. The firmware has exactly one of these, the simulator gives one to each kit */
+typedef struct {
+    uint8_t buffer[RECORD_BUFFER_SIZE];
+    uint16_t start; //index of the oldest record
+    uint16_t length; //bytes in use
+    uint32_t base_tick; //tick the oldest record's delta counts from
+    uint32_t last_tick; //tick of the newest record
+    uint32_t tick; //pacer ticks (main loop passes) since recording started
+    uint8_t snapshots; //snapshots in the ring
+    uint8_t full; //1 if records are being turned away to keep the newest snapshot
+    uint32_t full_tick; //tick the first record was turned away
+} Recorder;
+
+
+/** The log records are written to */
+extern RECORD_POINTER_STORAGE Recorder* recorder;
+
+
+/** Clear the log and restart the tick count:
+    @param tick tick to count from */
+void record_init (uint32_t tick);
+
+
+/** Count one pass of the main loop */
+void record_tick (void);
+
+
+/** Append a record with a single payload byte:
+    @param type one of RECORD_RX, RECORD_TX, RECORD_NAV or RECORD_MODE
+    @param value the payload */
+void record_event (uint8_t type, uint8_t value);
+
+
+/** Append the navswitch push events seen by the last navswitch_update, if any */
+void record_navswitch (void);
+
+
+/** Append a snapshot of the state a replay needs to start from:
+    @param snapshot RECORD_SNAPSHOT_LENGTH bytes laid out as the RECORD_SNAP_* offsets */
+void record_snapshot (const uint8_t snapshot[]);
+
+
+/** Write the log out as a dump, oldest record first:
+    @param write function called with each byte of the dump */
+void record_dump (void (*write) (char));
+
+
+#ifdef RECORD
+#define RECORD_INIT() record_init(0)
+#define RECORD_TICK() record_tick()
+#define RECORD_BYTE(type, value) record_event((type), (value))
+#define RECORD_NAVSWITCH() record_navswitch()
+#define RECORD_SNAPSHOT_OF(game, own_paddle, ball_speed, ball_timer) do { \
+    const uint8_t snapshot_[RECORD_SNAPSHOT_LENGTH] = { \
+        [RECORD_SNAP_MODE] = (game)->game_mode, \
+        [RECORD_SNAP_SCORE] = (game)->score, \
+        [RECORD_SNAP_OPPONENT_SCORE] = (game)->opponent_score, \
+        [RECORD_SNAP_PADDLE] = (own_paddle)->pos, \
+        [RECORD_SNAP_BALL_TIMER] = (ball_timer), \
+        [RECORD_SNAP_ROUND] = (game)->round, \
+        [RECORD_SNAP_FLAGS] = ((game)->single_player ? RECORD_FLAG_SINGLE_PLAYER : 0) \
+                              | ((game)->multi_ball ? RECORD_FLAG_MULTI_BALL : 0) \
+                              | ((game)->ring_mode ? RECORD_FLAG_RING : 0) \
+                              | ((game)->lockstep_mode ? RECORD_FLAG_LOCKSTEP : 0), \
+        [RECORD_SNAP_BALL_SPEED] = (ball_speed), \
+        [RECORD_SNAP_AI_PADDLE] = (game)->ai.paddle.pos, \
+        [RECORD_SNAP_AI_TARGET] = (game)->ai.target, \
+        [RECORD_SNAP_AI_REACTION] = (game)->ai.reaction, \
+        [RECORD_SNAP_AI_MOVE_COUNTER] = (game)->ai.move_counter, \
+        [RECORD_SNAP_AI_SERVE_COUNTER] = (game)->ai.serve_counter, \
+        [RECORD_SNAP_AI_LEVEL] = (game)->ai.level, \
+        [RECORD_SNAP_AI_RANDOM] = (game)->ai.random & 0xFF, \
+        [RECORD_SNAP_AI_RANDOM + 1] = (game)->ai.random >> 8}; \
+    record_snapshot(snapshot_); \
+} while (0)
+#else
+#define RECORD_INIT()
+#define RECORD_TICK()
+#define RECORD_BYTE(type, value)
+#define RECORD_NAVSWITCH()
+#define RECORD_SNAPSHOT_OF(game, own_paddle, ball_speed, ball_timer)
+#endif
+
+
+#endif
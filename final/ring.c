@@ -0,0 +1,251 @@
+/** @file ring.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief ring mode: three or more kits, each facing the next, share one court with routed ball handoff
+ */
+
+
+#include "ring.h"
+#include "communications.h"
+
+#define SEQ_WINDOW 8 //sequence numbers this far behind the expected one are duplicates
+
+
+/** Initialise a ring with no address, not yet formed:
+    @param ring pointer to struct being initialised */
+void ring_init (Ring* ring)
+{
+    ring->address = 0;
+    ring->size = 0;
+    for (uint8_t i = 0; i < RING_MAX_NODES; i++) {
+        ring->tx_seq[i] = 0;
+        ring->rx_seq[i] = 0;
+        ring->rx_broadcast_seq[i] = 0;
+        ring->scores[i] = 0;
+    }
+    ring->tx_seq[RING_MAX_NODES] = 0;
+    ring->last_sender = 0;
+    ring->server = 0;
+    ring->forwarded = 0;
+    ring->duplicates = 0;
+    ring->gaps = 0;
+}
+
+
+/** Form a ring with this kit as address 0, by sending the first join message:
+    @param ring pointer to ring struct */
+void ring_start (Ring* ring)
+{
+    ring->address = 0;
+    ring->size = 0;
+    send_symbol(RING_JOIN_EVENT);
+    send_symbol(ring->address);
+}
+
+
+/** Take the next address after a RING_JOIN_EVENT symbol, and pass the join on:
+    @param ring pointer to ring struct */
+void ring_join (Ring* ring)
+{
+    uint8_t previous = read_symbol();
+    if (previous + 1 >= RING_MAX_NODES) {
+        previous = RING_MAX_NODES - 2; //corrupted or too many kits, the ring stays short of its full size
+    }
+    ring->address = previous + 1;
+    send_symbol(RING_JOIN_EVENT);
+    send_symbol(ring->address);
+}
+
+
+/** Check whether this kit serves the next round:
+    @param ring pointer to ring struct
+    @return 1 once the ring has formed if this kit is the server */
+uint8_t ring_may_serve (const Ring* ring)
+{
+    return ring->size && ring->server == ring->address;
+}
+
+
+/** Choose the kit a ball leaving the screen goes to. Straight balls cross to the
+    kit opposite, angled balls to either side of it:
+    @param ring pointer to ring struct
+    @param direction_x x direction of the ball as it left
+    @return address of the receiving kit */
+uint8_t ring_target (const Ring* ring, int8_t direction_x)
+{
+    int8_t offset = ring->size / 2 + direction_x;
+    if (offset < 1) {
+        offset = 1;
+    } else if (offset > ring->size - 1) {
+        offset = ring->size - 1;
+    }
+    return (ring->address + offset) % ring->size;
+}
+
+
+/** Write a frame originated by this kit:
+    @param ring pointer to ring struct
+    @param destination address of the receiving kit, or RING_BROADCAST
+    @param first first payload symbol
+    @param second second payload symbol
+    @param third third payload symbol */
+static void send_frame (Ring* ring, uint8_t destination, uint8_t first, uint8_t second, uint8_t third)
+{
+    uint8_t* seq = &ring->tx_seq[destination == RING_BROADCAST ? RING_MAX_NODES : destination];
+    send_symbol(RING_FRAME_EVENT);
+    send_symbol(destination);
+    send_symbol(ring->address);
+    send_symbol(*seq);
+    send_symbol(first);
+    send_symbol(second);
+    send_symbol(third);
+    *seq = (*seq + 1) & RING_SEQ_MASK;
+}
+
+
+/** Send the ball on to its target as it leaves the screen, or tell every kit it died:
+    @param ring pointer to ring struct
+    @param ball ball that just went off screen or died */
+void ring_send_ball (Ring* ring, Ball* ball)
+{
+    if (ball->dead) {
+        //whoever hit it to us wins the point, and we serve next
+        ring->scores[ring->last_sender]++;
+        ring->server = ring->address;
+        send_frame(ring, RING_BROADCAST, DEAD_BALL, ring->last_sender, 0);
+    } else {
+        // mirrored as in transmit_ball, however many kits the frame passes through
+        send_frame(ring, ring_target(ring, ball->direction_x), RIGHT_WALL - ball->x + COORD_OFFSET,
+                   -ball->direction_x + DIR_OFFSET, ball->speed);
+    }
+}
+
+
+/** Check a sequence number against the one expected from its source:
+    @param ring pointer to ring struct
+    @param expected next sequence number expected, advanced if the frame is new
+    @param seq sequence number of the frame
+    @return 1 if the frame is new, 0 if it has been seen before */
+static uint8_t accept_seq (Ring* ring, uint8_t* expected, uint8_t seq)
+{
+    uint8_t missed = (seq - *expected) & RING_SEQ_MASK;
+    if (missed >= SEQ_WINDOW) {
+        ring->duplicates++;
+        return 0;
+    }
+    ring->gaps += missed;
+    *expected = (seq + 1) & RING_SEQ_MASK;
+    return 1;
+}
+
+
+/** Read the rest of a frame after its RING_FRAME_EVENT symbol and act on it:
+    @param ring pointer to ring struct
+    @param ball ball to place on screen if one is handed to this kit
+    @return RING_BALL, RING_ROUND_OVER or RING_NONE as for ring_poll */
+static uint8_t receive_frame (Ring* ring, Ball* ball)
+{
+    uint8_t frame[RING_FRAME_LENGTH];
+    frame[0] = RING_FRAME_EVENT;
+    for (uint8_t i = 1; i < RING_FRAME_LENGTH; i++) {
+        frame[i] = read_symbol();
+    }
+    uint8_t destination = frame[1];
+    uint8_t source = frame[2];
+    uint8_t seq = frame[3];
+    if (source >= ring->size || source == ring->address) {
+        return RING_NONE; //corrupted, or our own frame back again
+    }
+
+    uint8_t for_us = destination == ring->address;
+    uint8_t forward = !for_us;
+    if (destination == RING_BROADCAST) {
+        //every kit acts on it once, and it goes round as far as the kit before its source
+        for_us = accept_seq(ring, &ring->rx_broadcast_seq[source], seq);
+        forward = for_us && (ring->address + 1) % ring->size != source;
+    }
+    if (forward) {
+        for (uint8_t i = 0; i < RING_FRAME_LENGTH; i++) {
+            send_symbol(frame[i]);
+        }
+        ring->forwarded++;
+    }
+    if (!for_us) {
+        return RING_NONE;
+    }
+
+    if (destination == RING_BROADCAST) {
+        if (frame[4] != DEAD_BALL) {
+            return RING_NONE;
+        }
+        if (frame[5] < ring->size) {
+            ring->scores[frame[5]]++;
+        }
+        ring->server = source;
+        return RING_ROUND_OVER;
+    }
+    if (!accept_seq(ring, &ring->rx_seq[source], seq)) {
+        return RING_NONE;
+    }
+    uint8_t x_coord = frame[4] - COORD_OFFSET;
+    int8_t x_dir = frame[5] - DIR_OFFSET;
+    if (x_coord > RIGHT_WALL) {
+        x_coord = RIGHT_WALL; //corrupted beyond repair, keep the ball in play anyway
+    }
+    if (x_dir < LEFT || x_dir > RIGHT) {
+        //transmission got messed up, default to straight down
+        x_dir = STRAIGHT;
+    }
+    ball_init(ball, x_coord, HEIGHT - 1, x_dir, DOWN, ON_SCREEN);
+    ball_set_speed(ball, frame[6]);
+    ring->last_sender = source;
+    return RING_BALL;
+}
+
+
+/** Handle an incoming message if one has arrived, forwarding frames meant for other kits:
+    @param ring pointer to ring struct
+    @param ball ball to place on screen if one is handed to this kit
+    @return RING_BALL if the ball arrived, RING_ROUND_OVER if any kit dropped it, else RING_NONE */
+uint8_t ring_poll (Ring* ring, Ball* ball)
+{
+    if (!ir_uart_read_ready_p()) {
+        return RING_NONE;
+    }
+    uint8_t message = read_symbol();
+    if (message == RING_JOIN_EVENT) {
+        uint8_t last = read_symbol();
+        if (ring->address == 0 && !ring->size && last < RING_MAX_NODES) {
+            //our join has come all the way round, so every kit has an address
+            ring->size = last + 1;
+            send_symbol(RING_SIZE_EVENT);
+            send_symbol(ring->size);
+        }
+    } else if (message == RING_SIZE_EVENT) {
+        uint8_t size = read_symbol();
+        if (!ring->size && size <= RING_MAX_NODES && ring->address < size) {
+            ring->size = size;
+            if (ring->address != size - 1) {
+                send_symbol(RING_SIZE_EVENT);
+                send_symbol(size);
+            }
+        }
+    } else if (message == RING_FRAME_EVENT && ring->size) {
+        return receive_frame(ring, ball);
+    }
+    return RING_NONE;
+}
+
+
+/** Return the highest score of any other kit:
+    @param ring pointer to ring struct */
+uint8_t ring_best_other (const Ring* ring)
+{
+    uint8_t best = 0;
+    for (uint8_t i = 0; i < ring->size; i++) {
+        if (i != ring->address && ring->scores[i] > best) {
+            best = ring->scores[i];
+        }
+    }
+    return best;
+}
@@ -0,0 +1,95 @@
+/** @file ring.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief ring mode: three or more kits, each facing the next, share one court with routed ball handoff
+ */
+
+
+#ifndef RING_H
+#define RING_H
+
+#include "system.h"
+#include "ball.h"
+
+#define RING_MAX_NODES 8
+#define RING_BROADCAST 15 //destination address of frames every kit acts on
+#define RING_JOIN_EVENT 9 //followed by the sender's address while the ring is forming
+#define RING_SIZE_EVENT 8 //followed by the number of kits once the ring has formed
+#define RING_FRAME_EVENT 14 //followed by destination, source, sequence and three payload symbols
+#define RING_FRAME_LENGTH 7
+#define RING_SEQ_MASK 0x0f //sequence numbers are one 4 bit symbol
+
+#define RING_NONE 0 //ring_poll results
+#define RING_BALL 1
+#define RING_ROUND_OVER 2
+
+
+/** Define data associated with this kit's place on the ring */
+typedef struct ring_s Ring;
+
+
+/** Ring structure. Kit n transmits only to kit n + 1, so every frame is passed on
+    hop by hop until it reaches its destination */
+struct ring_s {
+    uint8_t address; //this kit's position, 0 for the kit that formed the ring
+    uint8_t size; //number of kits, 0 until the ring has formed
+    uint8_t tx_seq[RING_MAX_NODES + 1]; //next sequence number to each destination, the last for broadcasts
+    uint8_t rx_seq[RING_MAX_NODES]; //next sequence number expected from each source
+    uint8_t rx_broadcast_seq[RING_MAX_NODES];
+    uint8_t scores[RING_MAX_NODES]; //points won by each kit
+    uint8_t last_sender; //kit that handed us the ball, who scores if we drop it
+    uint8_t server; //kit that serves the next round
+    uint16_t forwarded; //frames passed on for other kits
+    uint16_t duplicates; //frames dropped because their sequence number was already seen
+    uint16_t gaps; //frames missed, going by the sequence numbers that did arrive
+};
+
+
+/** Initialise a ring with no address, not yet formed:
+    @param ring pointer to struct being initialised */
+void ring_init (Ring* ring);
+
+
+/** Form a ring with this kit as address 0, by sending the first join message:
+    @param ring pointer to ring struct */
+void ring_start (Ring* ring);
+
+
+/** Take the next address after a RING_JOIN_EVENT symbol, and pass the join on:
+    @param ring pointer to ring struct */
+void ring_join (Ring* ring);
+
+
+/** Check whether this kit serves the next round:
+    @param ring pointer to ring struct
+    @return 1 once the ring has formed if this kit is the server */
+uint8_t ring_may_serve (const Ring* ring);
+
+
+/** Choose the kit a ball leaving the screen goes to. Straight balls cross to the
+    kit opposite, angled balls to either side of it:
+    @param ring pointer to ring struct
+    @param direction_x x direction of the ball as it left
+    @return address of the receiving kit */
+uint8_t ring_target (const Ring* ring, int8_t direction_x);
+
+
+/** Send the ball on to its target as it leaves the screen, or tell every kit it died:
+    @param ring pointer to ring struct
+    @param ball ball that just went off screen or died */
+void ring_send_ball (Ring* ring, Ball* ball);
+
+
+/** Handle an incoming message if one has arrived, forwarding frames meant for other kits:
+    @param ring pointer to ring struct
+    @param ball ball to place on screen if one is handed to this kit
+    @return RING_BALL if the ball arrived, RING_ROUND_OVER if any kit dropped it, else RING_NONE */
+uint8_t ring_poll (Ring* ring, Ball* ball);
+
+
+/** Return the highest score of any other kit:
+    @param ring pointer to ring struct */
+uint8_t ring_best_other (const Ring* ring);
+
+
+#endif
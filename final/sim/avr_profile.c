@@ -0,0 +1,547 @@
+/** @file avr_profile.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief cycle-accurate profile of game.out on simavr's ATmega32U4 core, driven by a navswitch and IR script
+ */
+
+
+#include <getopt.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "avr_ioport.h"
+#include "avr_uart.h"
+#include "coder.h"
+#include "game.h"
+#include "timing.h"
+
+#define DEFAULT_MCU "atmega32u4" //simavr has no 32U2 core, game.out must be built for the one it runs on
+#define DEFAULT_TOP 25
+#define F_CPU 8000000
+#define CYCLES_PER_MS (F_CPU / 1000)
+#define TAP_MS 50 //how long a tap holds a button down
+#define MAX_EVENTS 1024
+#define MAX_SYMBOLS 512
+#define MAX_DEPTH 64
+#define NO_FUNCTION 0xffff
+#define GAME_MODE_OFFSET offsetof(Game, game_mode) //only bytes come before it, so the AVR's offset is the same
+#define NUM_MODES 5
+#define NUM_TRACKED 6
+
+
+/* The profiler steps the simulated CPU one instruction at a time. Each
+ * instruction's cycles go to the function holding its address, for the flat
+ * profile. Calls to the tracked functions are timed from their first
+ * instruction until the stack pointer climbs back above where it was on entry,
+ * so the times include everything they call. game_update is split by the
+ * game_mode it finds on entry. */
+
+
+/** Navswitch buttons, wired as on the UCFK4: active low with pull ups */
+typedef enum {
+    BUTTON_NORTH,
+    BUTTON_EAST,
+    BUTTON_SOUTH,
+    BUTTON_WEST,
+    BUTTON_PUSH,
+    NUM_BUTTONS
+} Button;
+
+
+static const char* button_names[NUM_BUTTONS] = {"north", "east", "south", "west", "push"};
+/* The Makefile reads each navswitch pin out of the kit's target.h and passes it as
+ * TARGET_<BUTTON>_PORT and TARGET_<BUTTON>_PIN */
+#if !defined(TARGET_NORTH_PIN) || !defined(TARGET_EAST_PIN) || !defined(TARGET_SOUTH_PIN) \
+    || !defined(TARGET_WEST_PIN) || !defined(TARGET_PUSH_PIN)
+#error "navswitch pins not found, set TARGET_H in the Makefile to the kit's target.h"
+#endif
+
+enum {PORT_B = 'B', PORT_C = 'C', PORT_D = 'D'};
+
+static const char button_ports[NUM_BUTTONS] = {TARGET_NORTH_PORT, TARGET_EAST_PORT, TARGET_SOUTH_PORT,
+                                               TARGET_WEST_PORT, TARGET_PUSH_PORT};
+static const uint8_t button_pins[NUM_BUTTONS] = {TARGET_NORTH_PIN, TARGET_EAST_PIN, TARGET_SOUTH_PIN,
+                                                 TARGET_WEST_PIN, TARGET_PUSH_PIN};
+
+
+static const char* mode_names[NUM_MODES] = {"START_MENU", "PADDLE_MODE", "PLAY_MODE", "DISPLAY_SCORE_MODE",
+                                            "GAME_OVER_MODE"};
+
+
+/** One scripted stimulus */
+typedef enum {
+    EVENT_PRESS,
+    EVENT_RELEASE,
+    EVENT_IR,
+    EVENT_END
+} EventType;
+
+
+typedef struct {
+    uint64_t cycle;
+    EventType type;
+    uint8_t value; //button, or symbol to send encoded over IR
+    uint32_t order; //position in the script, so events at equal times keep it
+} Event;
+
+
+/** A function from the ELF symbol table */
+typedef struct {
+    uint32_t address;
+    uint32_t size;
+    char name[64];
+    uint64_t self_cycles;
+} Symbol;
+
+
+/** Calls timed for one tracked function, or one game mode of game_update */
+typedef struct {
+    const char* name;
+    uint64_t calls;
+    uint64_t cycles;
+    uint64_t min;
+    uint64_t max;
+} CallStats;
+
+
+/** A tracked call still running */
+typedef struct {
+    CallStats* stats;
+    uint64_t start;
+    uint16_t sp;
+} Frame;
+
+
+/** Profiler state */
+typedef struct {
+    Symbol symbols[MAX_SYMBOLS];
+    size_t num_symbols;
+    uint16_t* owner; //symbol index for every flash word
+    CallStats** entry_stats; //tracked call at each flash word, NULL if none
+    uint32_t flash_words;
+    CallStats tracked[NUM_TRACKED];
+    CallStats modes[NUM_MODES];
+    uint32_t game_update; //address of game_update
+    Frame frames[MAX_DEPTH];
+    uint8_t depth;
+    uint64_t tx_bytes;
+    int verbose;
+} Profile;
+
+
+static Event events[MAX_EVENTS];
+static size_t num_events;
+
+
+/** Add a scripted event:
+    @param ms time from reset
+    @param type what happens
+    @param value button or symbol
+    @return 1 if there was room, else 0 */
+static int add_event (double ms, EventType type, uint8_t value)
+{
+    if (num_events == MAX_EVENTS) {
+        return 0;
+    }
+    events[num_events].cycle = (uint64_t) (ms * CYCLES_PER_MS);
+    events[num_events].type = type;
+    events[num_events].value = value;
+    events[num_events].order = num_events;
+    num_events++;
+    return 1;
+}
+
+
+/** Look up a button by name:
+    @param name button name
+    @return the button, or NUM_BUTTONS if there is none by that name */
+static Button find_button (const char* name)
+{
+    Button button = 0;
+    while (button < NUM_BUTTONS && strcmp(button_names[button], name) != 0) {
+        button++;
+    }
+    return button;
+}
+
+
+static int compare_events (const void* a, const void* b)
+{
+    const Event* first = a;
+    const Event* second = b;
+    if (first->cycle != second->cycle) {
+        return first->cycle < second->cycle ? -1 : 1;
+    }
+    return first->order < second->order ? -1 : 1;
+}
+
+
+/** Read a stimulus script. Each line is a time in ms followed by one of
+    press/release/tap <button>, ir <symbol>... or end; # starts a comment:
+    @param path script file
+    @return 1 if the script was read, else 0 */
+static int read_script (const char* path)
+{
+    FILE* file = fopen(path, "r");
+    char line[256];
+    unsigned number = 0;
+    if (!file) {
+        perror(path);
+        return 0;
+    }
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        char* comment = strchr(line, '#');
+        if (comment) {
+            *comment = '\0';
+        }
+        char* word = strtok(line, " \t\r\n");
+        if (!word) {
+            continue;
+        }
+        double ms = atof(word);
+        char* action = strtok(NULL, " \t\r\n");
+        char* argument = strtok(NULL, " \t\r\n");
+        int ok = action != NULL;
+        if (ok && strcmp(action, "end") == 0) {
+            ok = add_event(ms, EVENT_END, 0);
+        } else if (ok && strcmp(action, "ir") == 0) {
+            ok = argument != NULL;
+            // queued together, the UART model delivers them a byte time apart
+            for (; ok && argument; argument = strtok(NULL, " \t\r\n")) {
+                unsigned long symbol = strtoul(argument, NULL, 0);
+                ok = symbol < NUM_SYNDROMES && add_event(ms, EVENT_IR, symbol);
+            }
+        } else if (ok) {
+            Button button = argument ? find_button(argument) : NUM_BUTTONS;
+            ok = button < NUM_BUTTONS;
+            if (ok && strcmp(action, "press") == 0) {
+                ok = add_event(ms, EVENT_PRESS, button);
+            } else if (ok && strcmp(action, "release") == 0) {
+                ok = add_event(ms, EVENT_RELEASE, button);
+            } else if (ok && strcmp(action, "tap") == 0) {
+                ok = add_event(ms, EVENT_PRESS, button) && add_event(ms + TAP_MS, EVENT_RELEASE, button);
+            } else {
+                ok = 0;
+            }
+        }
+        if (!ok) {
+            fprintf(stderr, "%s:%u: cannot read event\n", path, number);
+            fclose(file);
+            return 0;
+        }
+    }
+    fclose(file);
+    qsort(events, num_events, sizeof(Event), compare_events);
+    return 1;
+}
+
+
+/** Read the function symbols written by avr-nm --print-size --defined-only:
+    @param profile profiler state
+    @param path symbol file
+    @return 1 if any functions were read, else 0 */
+static int read_symbols (Profile* profile, const char* path)
+{
+    FILE* file = fopen(path, "r");
+    char line[256];
+    if (!file) {
+        perror(path);
+        return 0;
+    }
+    while (fgets(line, sizeof(line), file) && profile->num_symbols < MAX_SYMBOLS) {
+        Symbol* symbol = &profile->symbols[profile->num_symbols];
+        unsigned address;
+        unsigned size;
+        char type;
+        if (sscanf(line, "%x %x %c %63s", &address, &size, &type, symbol->name) == 4
+            && (type == 'T' || type == 't' || type == 'W' || type == 'w')) {
+            symbol->address = address;
+            symbol->size = size;
+            symbol->self_cycles = 0;
+            profile->num_symbols++;
+        }
+    }
+    fclose(file);
+    return profile->num_symbols != 0;
+}
+
+
+/** Find a function by name:
+    @param profile profiler state
+    @param name function name
+    @return the symbol, or NULL if it is not in the image */
+static Symbol* find_symbol (Profile* profile, const char* name)
+{
+    for (size_t i = 0; i < profile->num_symbols; i++) {
+        if (strcmp(profile->symbols[i].name, name) == 0) {
+            return &profile->symbols[i];
+        }
+    }
+    return NULL;
+}
+
+
+/** Map every flash word to the function holding it and mark the tracked entry points:
+    @param profile profiler state
+    @param flash_bytes size of flash */
+static void build_maps (Profile* profile, uint32_t flash_bytes)
+{
+    static const char* tracked[NUM_TRACKED] = {"decode", "update_location", "display_column",
+                                               "ball_tick", "balls_tick", "ball_speed_period"};
+    profile->flash_words = flash_bytes / 2;
+    profile->owner = malloc(profile->flash_words * sizeof(uint16_t));
+    profile->entry_stats = calloc(profile->flash_words, sizeof(CallStats*));
+    for (uint32_t i = 0; i < profile->flash_words; i++) {
+        profile->owner[i] = NO_FUNCTION;
+    }
+    for (size_t i = 0; i < profile->num_symbols; i++) {
+        const Symbol* symbol = &profile->symbols[i];
+        for (uint32_t word = symbol->address / 2; word < (symbol->address + symbol->size) / 2
+             && word < profile->flash_words; word++) {
+            profile->owner[word] = i;
+        }
+    }
+    for (size_t i = 0; i < sizeof(tracked) / sizeof(tracked[0]); i++) {
+        Symbol* symbol = find_symbol(profile, tracked[i]);
+        profile->tracked[i].name = tracked[i];
+        profile->tracked[i].min = UINT64_MAX;
+        if (symbol) {
+            profile->entry_stats[symbol->address / 2] = &profile->tracked[i];
+        }
+    }
+    for (uint8_t mode = 0; mode < NUM_MODES; mode++) {
+        profile->modes[mode].name = mode_names[mode];
+        profile->modes[mode].min = UINT64_MAX;
+    }
+    Symbol* game_update = find_symbol(profile, "game_update");
+    profile->game_update = game_update ? game_update->address : UINT32_MAX;
+}
+
+
+/** Read the stack pointer:
+    @param avr simulated MCU */
+static uint16_t stack_pointer (const avr_t* avr)
+{
+    return avr->data[R_SPL] | avr->data[R_SPH] << 8;
+}
+
+
+/** Finish tracked calls that have returned, and start one if the CPU has just entered a tracked function:
+    @param profile profiler state
+    @param avr simulated MCU after an instruction */
+static void track_calls (Profile* profile, avr_t* avr)
+{
+    uint16_t sp = stack_pointer(avr);
+    while (profile->depth && sp > profile->frames[profile->depth - 1].sp) {
+        Frame* frame = &profile->frames[--profile->depth];
+        uint64_t cycles = avr->cycle - frame->start;
+        frame->stats->calls++;
+        frame->stats->cycles += cycles;
+        frame->stats->min = cycles < frame->stats->min ? cycles : frame->stats->min;
+        frame->stats->max = cycles > frame->stats->max ? cycles : frame->stats->max;
+    }
+
+    CallStats* stats = NULL;
+    if (avr->pc == profile->game_update) {
+        // first argument, the Game pointer, arrives in r25:r24
+        uint16_t game = avr->data[24] | avr->data[25] << 8;
+        uint8_t mode = avr->data[game + GAME_MODE_OFFSET];
+        stats = mode < NUM_MODES ? &profile->modes[mode] : NULL;
+    } else if (avr->pc / 2 < profile->flash_words) {
+        stats = profile->entry_stats[avr->pc / 2];
+    }
+    if (stats && profile->depth < MAX_DEPTH) {
+        profile->frames[profile->depth].stats = stats;
+        profile->frames[profile->depth].start = avr->cycle;
+        profile->frames[profile->depth].sp = sp;
+        profile->depth++;
+    }
+}
+
+
+/** Count each byte the firmware transmits over IR:
+    @param irq UART output irq
+    @param value byte sent
+    @param param profiler state */
+static void uart_output (struct avr_irq_t* irq, uint32_t value, void* param)
+{
+    Profile* profile = param;
+    (void) irq;
+    profile->tx_bytes++;
+    if (profile->verbose) {
+        printf("  tx symbol %2u\n", decode(value));
+    }
+}
+
+
+/** Apply a scripted event:
+    @param avr simulated MCU
+    @param event the event */
+static void apply_event (avr_t* avr, const Event* event)
+{
+    if (event->type == EVENT_IR) {
+        avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('1'), UART_IRQ_INPUT), encode(event->value));
+    } else if (event->type == EVENT_PRESS || event->type == EVENT_RELEASE) {
+        avr_irq_t* pin = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(button_ports[event->value]),
+                                       button_pins[event->value]);
+        avr_raise_irq(pin, event->type == EVENT_RELEASE); //pressed pulls the pin low
+    }
+}
+
+
+/** Print calls to one tracked function or game mode:
+    @param stats timed calls */
+static void print_calls (const CallStats* stats)
+{
+    if (!stats->calls) {
+        printf("%-28s %10s\n", stats->name, "no calls");
+        return;
+    }
+    printf("%-28s %10llu %12.1f %8llu %8llu\n", stats->name, (unsigned long long) stats->calls,
+           (double) stats->cycles / stats->calls, (unsigned long long) stats->min, (unsigned long long) stats->max);
+}
+
+
+static int compare_self (const void* a, const void* b)
+{
+    const Symbol* first = a;
+    const Symbol* second = b;
+    return first->self_cycles < second->self_cycles ? 1 : first->self_cycles > second->self_cycles ? -1 : 0;
+}
+
+
+static void usage (const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options] game.out game.sym script\n"
+        "  runs game.out on a simulated AVR, feeding it the navswitch and IR events in script,\n"
+        "  and reports cycles per call and a flat profile; game.sym comes from avr-nm --print-size\n"
+        "  -m mcu      simavr core to run (default %s)\n"
+        "  -n count    functions to list in the flat profile (default %d)\n"
+        "  -v          print every IR symbol the firmware sends\n",
+        program, DEFAULT_MCU, DEFAULT_TOP);
+}
+
+
+int main (int argc, char* argv[])
+{
+    const char* mcu = DEFAULT_MCU;
+    size_t top = DEFAULT_TOP;
+    static Profile profile;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:n:vh")) != -1) {
+        switch (opt) {
+            case 'm' : mcu = optarg; break;
+            case 'n' : top = atoi(optarg); break;
+            case 'v' : profile.verbose = 1; break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    if (argc - optind != 3) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!read_symbols(&profile, argv[optind + 1]) || !read_script(argv[optind + 2])) {
+        return 1;
+    }
+
+    elf_firmware_t firmware;
+    memset(&firmware, 0, sizeof(firmware));
+    if (elf_read_firmware(argv[optind], &firmware) != 0) {
+        fprintf(stderr, "cannot load %s\n", argv[optind]);
+        return 1;
+    }
+    avr_t* avr = avr_make_mcu_by_name(mcu);
+    if (!avr) {
+        fprintf(stderr, "simavr has no %s core\n", mcu);
+        return 1;
+    }
+    avr_init(avr);
+    avr->frequency = F_CPU;
+    avr_load_firmware(avr, &firmware);
+    build_maps(&profile, avr->flashend + 1);
+
+    // bytes the firmware sends are counted here rather than echoed to stdout
+    uint32_t flags = 0;
+    avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('1'), &flags);
+    flags &= ~AVR_UART_FLAG_STDIO;
+    avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('1'), &flags);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('1'), UART_IRQ_OUTPUT), uart_output, &profile);
+    for (Button button = 0; button < NUM_BUTTONS; button++) {
+        Event release = {0, EVENT_RELEASE, button, 0};
+        apply_event(avr, &release);
+    }
+
+    uint64_t end = num_events ? events[num_events - 1].cycle : 0;
+    uint64_t unowned = 0;
+    size_t next = 0;
+    int state = cpu_Running;
+    while (avr->cycle < end && state != cpu_Done && state != cpu_Crashed) {
+        while (next < num_events && events[next].cycle <= avr->cycle) {
+            if (profile.verbose && events[next].type != EVENT_END) {
+                printf("%9.1f ms  %s %u\n", (double) avr->cycle / CYCLES_PER_MS,
+                       events[next].type == EVENT_IR ? "rx symbol" : events[next].type == EVENT_PRESS ? "press" : "release",
+                       events[next].value);
+            }
+            apply_event(avr, &events[next++]);
+        }
+        avr_flashaddr_t pc = avr->pc;
+        avr_cycle_count_t before = avr->cycle;
+        state = avr_run(avr);
+        uint16_t owner = pc / 2 < profile.flash_words ? profile.owner[pc / 2] : NO_FUNCTION;
+        if (owner == NO_FUNCTION) {
+            unowned += avr->cycle - before;
+        } else {
+            profile.symbols[owner].self_cycles += avr->cycle - before;
+        }
+        track_calls(&profile, avr);
+    }
+    if (state == cpu_Crashed) {
+        fprintf(stderr, "firmware crashed at pc 0x%04x after %llu cycles\n", avr->pc, (unsigned long long) avr->cycle);
+        return 1;
+    }
+
+    uint64_t ticks = 0;
+    for (uint8_t mode = 0; mode < NUM_MODES; mode++) {
+        ticks += profile.modes[mode].calls;
+    }
+    Symbol* pacer_wait = find_symbol(&profile, "pacer_wait");
+    printf("%s, %u Hz: %.1f ms simulated (%llu cycles), %llu pacer ticks, %llu IR bytes sent\n", mcu, F_CPU,
+           (double) avr->cycle / CYCLES_PER_MS, (unsigned long long) avr->cycle, (unsigned long long) ticks,
+           (unsigned long long) profile.tx_bytes);
+    if (pacer_wait && avr->cycle) {
+        printf("%.1f%% of cycles spent waiting in pacer_wait, budget %u cycles per tick\n",
+               100.0 * pacer_wait->self_cycles / avr->cycle, F_CPU / PACER_RATE);
+    }
+
+    printf("\n%-28s %10s %12s %8s %8s\n", "cycles per call, inclusive", "calls", "mean", "min", "max");
+    for (size_t i = 0; i < sizeof(profile.tracked) / sizeof(profile.tracked[0]); i++) {
+        print_calls(&profile.tracked[i]);
+    }
+    for (uint8_t mode = 0; mode < NUM_MODES; mode++) {
+        char name[40];
+        snprintf(name, sizeof(name), "game_update %s", mode_names[mode]);
+        profile.modes[mode].name = name;
+        print_calls(&profile.modes[mode]);
+    }
+
+    printf("\n%-28s %12s %7s\n", "flat profile, self", "cycles", "share");
+    qsort(profile.symbols, profile.num_symbols, sizeof(Symbol), compare_self);
+    for (size_t i = 0; i < profile.num_symbols && i < top && profile.symbols[i].self_cycles; i++) {
+        printf("%-28s %12llu %6.2f%%\n", profile.symbols[i].name, (unsigned long long) profile.symbols[i].self_cycles,
+               100.0 * profile.symbols[i].self_cycles / avr->cycle);
+    }
+    if (unowned) {
+        printf("%-28s %12llu %6.2f%%\n", "(no symbol)", (unsigned long long) unowned, 100.0 * unowned / avr->cycle);
+    }
+    free(profile.owner);
+    free(profile.entry_stats);
+    return 0;
+}
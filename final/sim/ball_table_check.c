@@ -0,0 +1,122 @@
+/** @file ball_table_check.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief exhaustive equivalence check and timing of table-driven against branching update_location
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ball.h"
+#include "ball_table.h"
+#include "sim_util.h"
+
+#define TIMED_STEPS 100000000ULL
+#define DEFAULT_SEED 260
+
+
+// ball.c built a second time with BALL_TABLE defined, under this name
+void table_update_location (Ball* ball, uint8_t paddle);
+
+
+static void print_ball (const Ball* ball)
+{
+    printf("x=%u y=%u dx=%+d dy=%+d on_screen=%u dead=%u speed=%u", ball->x, ball->y, ball->direction_x,
+           ball->direction_y, ball->on_screen, ball->dead, ball->speed);
+}
+
+
+/** Compare both versions on one input:
+    @param start ball before the step
+    @param paddle paddle position
+    @return 1 if they agree, else 0 */
+static int check_one (const Ball* start, uint8_t paddle)
+{
+    Ball reference = *start;
+    Ball table = *start;
+    update_location(&reference, paddle);
+    table_update_location(&table, paddle);
+    if (reference.x == table.x && reference.y == table.y && reference.direction_x == table.direction_x
+        && reference.direction_y == table.direction_y && reference.on_screen == table.on_screen
+        && reference.dead == table.dead && reference.speed == table.speed && reference.period == table.period) {
+        return 1;
+    }
+    printf("mismatch from ");
+    print_ball(start);
+    printf(" paddle=%u\n  branching: ", paddle);
+    print_ball(&reference);
+    printf("\n  table:     ");
+    print_ball(&table);
+    printf("\n");
+    return 0;
+}
+
+
+/** Time one version over a long rally of random paddle positions:
+    @param step the update_location to time
+    @param seed random seed, the same for both versions
+    @param checksum where to place a value depending on every step taken
+    @return nanoseconds per step */
+static double time_steps (void (*step) (Ball*, uint8_t), uint64_t seed, uint64_t* checksum)
+{
+    static uint8_t paddles[1 << 16];
+    struct timespec begin, finish;
+    SimRng rng;
+    Ball ball;
+    uint64_t sum = 0;
+
+    sim_rng_seed(&rng, seed, 0);
+    for (uint32_t i = 0; i < sizeof(paddles); i++) {
+        paddles[i] = sim_rng_below(&rng, RIGHT_WALL + 1);
+    }
+    ball_init(&ball, 3, GROUND + 1, STRAIGHT, UP, ON_SCREEN);
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (uint64_t i = 0; i < TIMED_STEPS; i++) {
+        step(&ball, paddles[i & (sizeof(paddles) - 1)]);
+        if (!ball.on_screen || ball.dead) {
+            // same hand back as receive_ball, so the rally never ends
+            ball_init(&ball, RIGHT_WALL - ball.x, HEIGHT - 1, -ball.direction_x, DOWN, ON_SCREEN);
+        }
+        sum += ball.x;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+    *checksum = sum;
+    return ((finish.tv_sec - begin.tv_sec) * 1e9 + (finish.tv_nsec - begin.tv_nsec)) / TIMED_STEPS;
+}
+
+
+int main (void)
+{
+    uint32_t inputs = 0;
+    uint32_t mismatches = 0;
+
+    // the whole domain: every ball on screen and alive, every possible paddle value
+    for (uint16_t paddle = 0; paddle <= UINT8_MAX; paddle++) {
+        for (uint8_t y = GROUND; y < HEIGHT; y++) {
+            for (uint8_t x = LEFT_WALL; x <= RIGHT_WALL; x++) {
+                for (int8_t dx = LEFT; dx <= RIGHT; dx++) {
+                    for (int8_t dy = DOWN; dy <= UP; dy += UP - DOWN) {
+                        Ball ball;
+                        ball_init(&ball, x, y, dx, dy, ON_SCREEN);
+                        inputs++;
+                        mismatches += !check_one(&ball, paddle);
+                    }
+                }
+            }
+        }
+    }
+    printf("%u inputs checked (%u table entries, %u bytes of flash), %u mismatches\n",
+           inputs, BALL_TABLE_SIZE, (unsigned) sizeof(ball_table), mismatches);
+    if (mismatches) {
+        return 1;
+    }
+
+    uint64_t reference_sum, table_sum;
+    double reference_ns = time_steps(update_location, DEFAULT_SEED, &reference_sum);
+    double table_ns = time_steps(table_update_location, DEFAULT_SEED, &table_sum);
+    printf("host timing over %llu steps: branching %.2f ns/step, table %.2f ns/step%s\n",
+           TIMED_STEPS, reference_ns, table_ns, reference_sum == table_sum ? "" : " (RALLIES DIFFER)");
+    return reference_sum != table_sum;
+}
@@ -0,0 +1,87 @@
+/** @file ball_table_gen.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief build-time generator of ball_table.c from the branching update_location
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "ball.h"
+#include "ball_table.h"
+
+#define ENTRIES_PER_LINE 8
+
+
+/** Run the reference update_location once and pack the result as a table entry:
+    @param x ball x coordinate
+    @param y ball y coordinate
+    @param direction_x ball x direction
+    @param direction_y ball y direction
+    @param paddle paddle position */
+static uint16_t reference_entry (uint8_t x, uint8_t y, int8_t direction_x, int8_t direction_y, uint8_t paddle)
+{
+    Ball ball;
+    ball_init(&ball, x, y, direction_x, direction_y, ON_SCREEN);
+    update_location(&ball, paddle);
+    if (ball.x > RIGHT_WALL || ball.y > HEIGHT || ball.on_screen != (ball.y < HEIGHT)) {
+        fprintf(stderr, "ball_table_gen: x=%u y=%u dx=%d dy=%d paddle=%u steps to x=%u y=%u, "
+                "which a table entry cannot hold\n", x, y, direction_x, direction_y, paddle, ball.x, ball.y);
+        exit(1);
+    }
+    return ball.x << BALL_TABLE_X_SHIFT | ball.y << BALL_TABLE_Y_SHIFT
+           | (ball.direction_x + 1) << BALL_TABLE_DX_SHIFT | (ball.direction_y == UP) << BALL_TABLE_UP_SHIFT
+           | ball.dead << BALL_TABLE_DEAD_SHIFT;
+}
+
+
+int main (int argc, char* argv[])
+{
+    static uint16_t table[BALL_TABLE_SIZE];
+    static uint8_t filled[BALL_TABLE_SIZE];
+    FILE* out = stdout;
+
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [ball_table.c]\n", argv[0]);
+        return 1;
+    }
+
+    for (uint8_t paddle = 0; paddle < BALL_TABLE_PADDLES; paddle++) {
+        for (uint8_t y = GROUND; y < HEIGHT; y++) {
+            for (uint8_t x = LEFT_WALL; x <= RIGHT_WALL; x++) {
+                for (int8_t dx = LEFT; dx <= RIGHT; dx++) {
+                    for (int8_t dy = DOWN; dy <= UP; dy += UP - DOWN) {
+                        Ball ball;
+                        ball_init(&ball, x, y, dx, dy, ON_SCREEN);
+                        uint16_t index = BALL_TABLE_INDEX(&ball, paddle);
+                        table[index] = reference_entry(x, y, dx, dy, paddle);
+                        filled[index]++;
+                    }
+                }
+            }
+        }
+    }
+    for (uint16_t i = 0; i < BALL_TABLE_SIZE; i++) {
+        if (filled[i] != 1) {
+            fprintf(stderr, "ball_table_gen: entry %u filled %u times\n", i, filled[i]);
+            return 1;
+        }
+    }
+
+    // only create the file once the whole table is known to be good
+    if (argc == 2 && !(out = fopen(argv[1], "w"))) {
+        perror(argv[1]);
+        return 1;
+    }
+    fprintf(out, "/** @file ball_table.c\n"
+                 " * @brief generated by sim/ball_table_gen from ball.c, do not edit\n"
+                 " */\n\n\n"
+                 "#include \"ball_table.h\"\n\n\n"
+                 "const uint16_t ball_table[BALL_TABLE_SIZE] PROGMEM = {\n");
+    for (uint16_t i = 0; i < BALL_TABLE_SIZE; i++) {
+        fprintf(out, "%s0x%03x,%s", i % ENTRIES_PER_LINE ? " " : "    ", table[i],
+                i % ENTRIES_PER_LINE == ENTRIES_PER_LINE - 1 || i == BALL_TABLE_SIZE - 1 ? "\n" : "");
+    }
+    fprintf(out, "};\n");
+    return out != stdout && fclose(out) ? 1 : 0;
+}
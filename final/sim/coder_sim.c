@@ -0,0 +1,491 @@
+/** @file coder_sim.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief Monte Carlo IR channel simulator and bit error rate sweep for the coder
+ */
+
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "coder.h"
+#include "sim_util.h"
+
+#define CHUNK_TRIALS 65536 //trials per unit of parallel work
+#define NUM_MESSAGES 16
+#define BYTE_VALUES 256
+#define BITS_PER_BYTE 8
+#define SYMBOL_BITS 2
+#define DEFAULT_TRIALS 10000000
+#define DEFAULT_POINTS 12
+#define DEFAULT_BER_LOW 1e-4
+#define DEFAULT_BER_HIGH 0.5
+#define DEFAULT_BURST 3
+#define DEFAULT_SEED 260
+
+
+/* Every codec is a pure function of a single byte, so the simulator tabulates
+ * encode and decode once per codec and the inner loop is a pair of lookups.
+ * The check function answers "would a decoder that can refuse have refused this
+ * byte?" and is what the detection figures are measured against. */
+
+
+/** Channel models, the swept probability p means something different for each:
+ *   flip  - every bit inverted independently with probability p
+ *   burst - bursts of burst_len bits, each bit in a burst inverted with probability 1/2
+ *           (the first always), started so the average bit error rate is p. Bursts run
+ *           on across byte boundaries and can follow each other straight away, so p can
+ *           go up to (burst_len + 1) / (2 burst_len), the rate with every bit in a burst
+ *   drop  - whole byte lost with probability p
+ *   stuck - every bit read as 1 independently with probability p (saturated receiver) */
+typedef enum {
+    CHANNEL_FLIP,
+    CHANNEL_BURST,
+    CHANNEL_DROP,
+    CHANNEL_STUCK,
+    NUM_CHANNELS
+} Channel;
+
+
+static const char* channel_names[NUM_CHANNELS] = {"flip", "burst", "drop", "stuck"};
+
+
+/** A codec under test. To add one, write its encode/decode/check and append it to codecs[] */
+typedef struct {
+    const char* name;
+    uint8_t (*encode) (uint8_t message);
+    uint8_t (*decode) (uint8_t transmission);
+    uint8_t (*check) (uint8_t transmission); //non-zero if a decoder could flag the byte as uncorrectable
+} Codec;
+
+
+/** Tabulated codec, built once per run */
+typedef struct {
+    uint8_t encoded[NUM_MESSAGES];
+    uint8_t decoded[BYTE_VALUES];
+    uint8_t flagged[BYTE_VALUES];
+} CodecTable;
+
+
+/** Outcome counts for one sweep point. Every delivered byte lands in exactly
+    one of clean, corrected, detected or miscorrected */
+typedef struct {
+    uint64_t trials;
+    uint64_t dropped;
+    uint64_t clean;
+    uint64_t corrected;
+    uint64_t detected; //decoded wrongly but check() would have flagged it
+    uint64_t miscorrected; //decoded wrongly and indistinguishable from a good byte
+    uint64_t bit_errors;
+} Tally;
+
+
+/** Read-only description of a sweep point handed to the workers */
+typedef struct {
+    const CodecTable* table;
+    Channel channel;
+    double p;
+    double burst_rate; //probability a bit outside a burst starts one
+    uint8_t burst_len;
+    uint64_t trials;
+    uint64_t seed;
+    uint64_t stream;
+} Point;
+
+
+/** Burst channel state carried from byte to byte */
+typedef struct {
+    uint64_t gap; //bits outside a burst before the next one starts
+    uint8_t left; //bits left in the current burst
+    uint64_t coin; //decides which of its bits after the first the current burst inverts
+} Burst;
+
+
+/** Count differing 2-bit F_4 symbols between two codewords */
+static uint8_t symbol_distance (uint8_t a, uint8_t b)
+{
+    uint8_t diff = a ^ b;
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < CODE_LENGTH; i++) {
+        count += (diff & 0x3) != 0;
+        diff >>= SYMBOL_BITS;
+    }
+    return count;
+}
+
+
+/** The (4,2) code has distance 3 so only words within one symbol of a codeword
+    are corrected with certainty; decode() guesses for the other 48 bytes */
+static uint8_t check_reed_solomon (uint8_t transmission)
+{
+    return symbol_distance(transmission, encode(decode(transmission))) > 1;
+}
+
+
+/** Uncoded baseline: the message is sent in the low nibble as is */
+static uint8_t encode_none (uint8_t message)
+{
+    return message;
+}
+
+
+static uint8_t decode_none (uint8_t transmission)
+{
+    return transmission & 0x0F;
+}
+
+
+static uint8_t check_none (uint8_t transmission)
+{
+    return (transmission & 0xF0) != 0;
+}
+
+
+static const Codec codecs[] = {
+    {"rs42", encode, decode, check_reed_solomon},
+    {"none", encode_none, decode_none, check_none},
+};
+
+#define NUM_CODECS (sizeof(codecs) / sizeof(codecs[0]))
+
+
+/** Build lookup tables for a codec:
+    @param codec the codec to tabulate
+    @param table where to place the tables */
+static void build_table (const Codec* codec, CodecTable* table)
+{
+    for (int i = 0; i < NUM_MESSAGES; i++) {
+        table->encoded[i] = codec->encode(i);
+    }
+    for (int i = 0; i < BYTE_VALUES; i++) {
+        table->decoded[i] = codec->decode(i);
+        table->flagged[i] = codec->check(i);
+    }
+}
+
+
+/** Sample the gap before the next bit event of an i.i.d. Bernoulli(p) stream:
+    @param rng generator for this chunk
+    @param p per-bit event probability, 0 < p < 1
+    @return number of untouched bits before the next event */
+static uint64_t geometric_gap (SimRng* rng, double p)
+{
+    double gap = floor(log1p(-sim_rng_uniform(rng)) / log1p(-p));
+    return gap > 1e18 ? (uint64_t) 1e18 : (uint64_t) gap;
+}
+
+
+/** Build the error mask for the next byte of an i.i.d. bit stream. Skipping
+    straight to the next event keeps low error rates cheap:
+    @param rng generator for this chunk
+    @param p per-bit event probability
+    @param next_event bits remaining until the next event, carried between bytes
+    @return mask of affected bits in this byte */
+static uint8_t iid_mask (SimRng* rng, double p, uint64_t* next_event)
+{
+    uint8_t mask = 0;
+    if (p >= 1.0) {
+        return 0xFF;
+    }
+    while (*next_event < BITS_PER_BYTE) {
+        mask |= 1 << *next_event;
+        *next_event += 1 + geometric_gap(rng, p);
+    }
+    *next_event -= BITS_PER_BYTE;
+    return mask;
+}
+
+
+/** Sample the gap before the next burst, every bit outside one starts one with the point's burst rate:
+    @param rng generator for this chunk
+    @param point sweep point being run
+    @return bits outside a burst before the next one */
+static uint64_t burst_gap (SimRng* rng, const Point* point)
+{
+    if (point->burst_rate >= 1.0) {
+        return 0;
+    }
+    return point->burst_rate > 0 ? geometric_gap(rng, point->burst_rate) : UINT64_MAX;
+}
+
+
+/** Build the error mask for the next byte of the burst channel:
+    @param rng generator for this chunk
+    @param point sweep point being run
+    @param burst burst in progress, carried between bytes
+    @return mask of inverted bits */
+static uint8_t burst_mask (SimRng* rng, const Point* point, Burst* burst)
+{
+    uint8_t mask = 0;
+    for (uint8_t bit = 0; bit < BITS_PER_BYTE; bit++) {
+        if (!burst->left) {
+            if (burst->gap) {
+                uint64_t room = BITS_PER_BYTE - bit;
+                uint64_t skip = burst->gap < room ? burst->gap : room;
+                burst->gap -= skip;
+                bit += skip - 1;
+                continue;
+            }
+            burst->left = point->burst_len;
+            burst->coin = sim_rng_next(rng);
+            mask |= 1 << bit; //the first bit of a burst is always inverted
+        } else if (burst->coin & 1) {
+            mask |= 1 << bit;
+        }
+        burst->coin >>= 1;
+        if (--burst->left == 0) {
+            burst->gap = burst_gap(rng, point);
+        }
+    }
+    return mask;
+}
+
+
+/** Run one chunk of trials for a sweep point:
+    @param context the Point being run
+    @param accumulator this thread's Tally
+    @param chunk chunk index */
+static void run_chunk (void* context, void* accumulator, uint64_t chunk)
+{
+    const Point* point = context;
+    const CodecTable* table = point->table;
+    Tally* tally = accumulator;
+    SimRng rng;
+    uint64_t first = chunk * CHUNK_TRIALS;
+    uint64_t count = point->trials - first < CHUNK_TRIALS ? point->trials - first : CHUNK_TRIALS;
+    uint64_t next_event = 0;
+    uint64_t message_bits = 0;
+    Burst burst = {0, 0, 0};
+
+    sim_rng_seed(&rng, point->seed, (point->stream << 40) ^ chunk);
+    if (point->channel == CHANNEL_FLIP || point->channel == CHANNEL_STUCK) {
+        next_event = point->p > 0 ? geometric_gap(&rng, point->p) : UINT64_MAX;
+    } else if (point->channel == CHANNEL_BURST) {
+        burst.gap = burst_gap(&rng, point);
+    }
+
+    for (uint64_t i = 0; i < count; i++) {
+        if ((i & 0xF) == 0) {
+            message_bits = sim_rng_next(&rng); //16 messages per draw
+        }
+        uint8_t message = message_bits & 0x0F;
+        message_bits >>= 4;
+        uint8_t sent = table->encoded[message];
+        uint8_t received = sent;
+
+        switch (point->channel) {
+            case CHANNEL_FLIP :
+                received ^= iid_mask(&rng, point->p, &next_event);
+                break;
+            case CHANNEL_STUCK :
+                received |= iid_mask(&rng, point->p, &next_event);
+                break;
+            case CHANNEL_BURST :
+                received ^= burst_mask(&rng, point, &burst);
+                break;
+            case CHANNEL_DROP :
+                if (sim_rng_uniform(&rng) < point->p) {
+                    tally->dropped++;
+                    continue;
+                }
+                break;
+            default :
+                break;
+        }
+
+        tally->bit_errors += __builtin_popcount(sent ^ received);
+        if (sent == received) {
+            tally->clean++;
+        } else if (table->decoded[received] == message) {
+            tally->corrected++;
+        } else if (table->flagged[received]) {
+            tally->detected++;
+        } else {
+            tally->miscorrected++;
+        }
+    }
+    tally->trials += count;
+}
+
+
+/** Add one thread's tally into the total:
+    @param total the total Tally
+    @param accumulator one thread's Tally */
+static void merge_tally (void* total, const void* accumulator)
+{
+    Tally* to = total;
+    const Tally* from = accumulator;
+    to->trials += from->trials;
+    to->dropped += from->dropped;
+    to->clean += from->clean;
+    to->corrected += from->corrected;
+    to->detected += from->detected;
+    to->miscorrected += from->miscorrected;
+    to->bit_errors += from->bit_errors;
+}
+
+
+/** Run a full sweep point across all threads:
+    @param point sweep point to run
+    @param num_threads number of worker threads
+    @param total where to place merged results */
+static void run_point (const Point* point, unsigned num_threads, Tally* total)
+{
+    uint64_t num_chunks = (point->trials + CHUNK_TRIALS - 1) / CHUNK_TRIALS;
+    memset(total, 0, sizeof(Tally));
+    sim_parallel_for(num_chunks, num_threads, run_chunk, (void*) point, sizeof(Tally), merge_tally, total);
+}
+
+
+static double ratio (uint64_t numerator, uint64_t denominator)
+{
+    return denominator ? (double) numerator / denominator : 0.0;
+}
+
+
+static void usage (const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -c codec      codec to test: rs42, none or all (default all)\n"
+        "  -m model      channel: flip, burst, drop, stuck or all (default all)\n"
+        "  -n trials     codewords per sweep point, eg 1e9 or 4G (default %d)\n"
+        "  -l p          lowest error probability (default %g)\n"
+        "  -u p          highest error probability (default %g)\n"
+        "  -p points     number of log-spaced sweep points (default %d)\n"
+        "  -b length     burst length in bits for the burst channel, 1-8 (default %d)\n"
+        "  -s seed       random seed, equal seeds give equal results (default %d)\n"
+        "  -t threads    worker threads (default: number of cores)\n"
+        "  -o file       also write results as CSV to file\n",
+        program, DEFAULT_TRIALS, DEFAULT_BER_LOW, DEFAULT_BER_HIGH, DEFAULT_POINTS, DEFAULT_BURST, DEFAULT_SEED);
+}
+
+
+int main (int argc, char* argv[])
+{
+    const char* codec_name = "all";
+    const char* channel_name = "all";
+    const char* csv_path = NULL;
+    uint64_t trials = DEFAULT_TRIALS;
+    uint64_t seed = DEFAULT_SEED;
+    uint64_t value;
+    double low = DEFAULT_BER_LOW;
+    double high = DEFAULT_BER_HIGH;
+    int points = DEFAULT_POINTS;
+    int burst_len = DEFAULT_BURST;
+    unsigned num_threads = sim_default_threads();
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:m:n:l:u:p:b:s:t:o:h")) != -1) {
+        switch (opt) {
+            case 'c' : codec_name = optarg; break;
+            case 'm' : channel_name = optarg; break;
+            case 'n' :
+                if (!sim_parse_count(optarg, &trials)) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'l' : low = atof(optarg); break;
+            case 'u' : high = atof(optarg); break;
+            case 'p' : points = atoi(optarg); break;
+            case 'b' : burst_len = atoi(optarg); break;
+            case 's' : seed = strtoull(optarg, NULL, 0); break;
+            case 't' :
+                if (!sim_parse_count(optarg, &value) || value == 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                num_threads = value;
+                break;
+            case 'o' : csv_path = optarg; break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    if (points < 1 || low <= 0 || high > 1 || low > high || burst_len < 1 || burst_len > BITS_PER_BYTE) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE* csv = NULL;
+    if (csv_path) {
+        csv = fopen(csv_path, "w");
+        if (!csv) {
+            perror(csv_path);
+            return 1;
+        }
+        fprintf(csv, "codec,channel,p,trials,dropped,clean,corrected,detected,miscorrected,"
+                     "measured_ber,residual_rate,miscorrection_rate,detection_rate\n");
+    }
+
+    printf("seed %llu, %llu trials per point, %u threads\n",
+           (unsigned long long) seed, (unsigned long long) trials, num_threads);
+    uint64_t stream = 0;
+    int ran = 0;
+    for (size_t c = 0; c < NUM_CODECS; c++) {
+        if (strcmp(codec_name, "all") && strcmp(codec_name, codecs[c].name)) {
+            continue;
+        }
+        CodecTable table;
+        build_table(&codecs[c], &table);
+
+        for (int m = 0; m < NUM_CHANNELS; m++) {
+            if (strcmp(channel_name, "all") && strcmp(channel_name, channel_names[m])) {
+                continue;
+            }
+            ran = 1;
+            printf("\n%-5s %-5s %10s %12s %12s %12s %12s %9s\n", "codec", "chan", "p",
+                   "measured BER", "residual", "miscorrect", "lost", "detected");
+            for (int i = 0; i < points; i++) {
+                Point point = {&table, m, low, 0, burst_len, trials, seed, stream++};
+                if (points > 1) {
+                    point.p = low * pow(high / low, (double) i / (points - 1));
+                }
+                // a burst inverts its first bit and half the rest, (burst_len + 1) / (2 burst_len)
+                // of its bits on average, so bursts must cover this share of the stream
+                double covered = point.p * 2 * burst_len / (burst_len + 1);
+                if (m == CHANNEL_BURST && covered > 1) {
+                    printf("%-5s %-5s %10.3e  skipped, %d bit bursts reach a BER of at most %.4f\n",
+                           codecs[c].name, channel_names[m], point.p, burst_len,
+                           (burst_len + 1) / (2.0 * burst_len));
+                    continue;
+                }
+                // with each bit outside a burst starting one at rate r, r L / (1 + r (L - 1)) are covered
+                point.burst_rate = covered / (burst_len - covered * (burst_len - 1));
+
+                Tally t;
+                run_point(&point, num_threads, &t);
+                uint64_t delivered = t.trials - t.dropped;
+                uint64_t wrong = t.detected + t.miscorrected;
+                double ber = ratio(t.bit_errors, delivered * BITS_PER_BYTE);
+                double residual = ratio(wrong, delivered);
+                double miscorrection = ratio(t.miscorrected, delivered);
+                double detection = ratio(t.detected, wrong);
+
+                printf("%-5s %-5s %10.3e %12.4e %12.4e %12.4e %12.4e %8.2f%%\n",
+                       codecs[c].name, channel_names[m], point.p, ber, residual,
+                       miscorrection, ratio(t.dropped, t.trials), 100 * detection);
+                if (csv) {
+                    fprintf(csv, "%s,%s,%.6e,%llu,%llu,%llu,%llu,%llu,%llu,%.6e,%.6e,%.6e,%.6e\n",
+                            codecs[c].name, channel_names[m], point.p,
+                            (unsigned long long) t.trials, (unsigned long long) t.dropped,
+                            (unsigned long long) t.clean, (unsigned long long) t.corrected,
+                            (unsigned long long) t.detected, (unsigned long long) t.miscorrected,
+                            ber, residual, miscorrection, detection);
+                }
+            }
+        }
+    }
+    if (csv) {
+        fclose(csv);
+    }
+    if (!ran) {
+        fprintf(stderr, "no codec/channel matches '%s'/'%s'\n", codec_name, channel_name);
+        return 1;
+    }
+    return 0;
+}
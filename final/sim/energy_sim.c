@@ -0,0 +1,169 @@
+/** @file energy_sim.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief LED duty cycle and charge per game screen, from matches between two simulated kits
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_bot.h"
+#include "sim_energy.h"
+#include "sim_kit.h"
+#include "sim_util.h"
+#include "pong_display.h"
+
+#define DEFAULT_GAMES 200
+#define DEFAULT_SEED 260
+#define DEFAULT_MISS 0.1
+#define DEFAULT_LINGER 5.0 //seconds the result scrolls before the kits are switched off
+#define GAME_TIMEOUT (600 * PACER_RATE) //ticks before a game counts as stalled
+
+
+/** Read-only run settings */
+typedef struct {
+    uint64_t games;
+    uint64_t seed;
+    double miss_rate;
+    double linger;
+    SimChannel channel;
+    SimPower power;
+} Run;
+
+
+/** Per-thread results, merged at the end */
+typedef struct {
+    SimEnergy energy;
+    uint64_t games;
+    uint64_t stalls;
+} Stats;
+
+
+/** Play one match from power on until both kits have shown the result for the linger time:
+    @param run run settings
+    @param index game number, used as the random stream
+    @param stats where to count the results */
+static void play_game (const Run* run, uint64_t index, Stats* stats)
+{
+    SimWorld world;
+    SimKit kits[2];
+    SimLink links[2];
+    SimBot bots[2];
+    uint64_t linger = run->linger * PACER_RATE;
+    uint64_t over = 0; //tick both kits reached the game over screen
+
+    sim_world_init_pair(&world, kits, links, &run->channel, run->seed + index);
+    for (uint8_t i = 0; i < 2; i++) {
+        sim_bot_init(&bots[i], run->miss_rate, run->seed, 2 * index + i);
+    }
+    while (world.tick < GAME_TIMEOUT && (!over || world.tick < over + linger)) {
+        sim_bot_input(&bots[0], &kits[0], 1, index & 1);
+        sim_bot_input(&bots[1], &kits[1], 0, !(index & 1));
+        sim_world_step(&world);
+        for (uint8_t i = 0; i < 2; i++) {
+            sim_energy_sample(&stats->energy, &run->power, &kits[i]);
+        }
+        if (!over && kits[0].game.game_mode == GAME_OVER_MODE && kits[1].game.game_mode == GAME_OVER_MODE) {
+            over = world.tick;
+        }
+    }
+
+    stats->stalls += !over;
+    stats->games++;
+    for (uint8_t i = 0; i < 2; i++) {
+        sim_kit_free(&kits[i]);
+    }
+}
+
+
+/** Play one game per chunk:
+    @param context the Run
+    @param accumulator this thread's Stats
+    @param chunk game number */
+static void run_chunk (void* context, void* accumulator, uint64_t chunk)
+{
+    play_game(context, chunk, accumulator);
+}
+
+
+/** Add one thread's results into the total:
+    @param total the total Stats
+    @param accumulator one thread's Stats */
+static void merge_stats (void* total, const void* accumulator)
+{
+    Stats* to = total;
+    const Stats* from = accumulator;
+    sim_energy_merge(&to->energy, &from->energy);
+    to->games += from->games;
+    to->stalls += from->stalls;
+}
+
+
+static void usage (const char* program)
+{
+    SimPower power;
+    sim_energy_defaults(&power);
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -n games    matches to play between two kits (default %d)\n"
+        "  -w seconds  time the result scrolls before the kits are switched off (default %g)\n"
+        "  -i mA       current through one lit LED (default %g)\n"
+        "  -v volts    supply voltage (default %g)\n"
+        "  -a mA       MCU current while running (default %g)\n"
+        "  -S mA       MCU current in idle sleep (default %g)\n"
+        "  -C mAh      battery capacity (default %g)\n"
+        "  -c mode=n   game_update cycles per tick in a game mode, by number or name, from make profile\n"
+        "  -l loss     IR byte loss probability (default 0)\n"
+        "  -m rate     probability a bot misses the ball (default %g)\n"
+        "  -s seed     random seed (default %d)\n"
+        "  -t threads  worker threads (default: number of cores)\n",
+        program, DEFAULT_GAMES, DEFAULT_LINGER, power.led_ma, power.supply_v, power.active_ma,
+        power.idle_ma, power.capacity_mah, DEFAULT_MISS, DEFAULT_SEED);
+}
+
+
+int main (int argc, char* argv[])
+{
+    Run run = {DEFAULT_GAMES, DEFAULT_SEED, DEFAULT_MISS, DEFAULT_LINGER, {2400, 0, 0, 0, 0}, {0, 0, 0, 0, 0, {0}}};
+    unsigned num_threads = sim_default_threads();
+    uint64_t value;
+    int opt;
+
+    sim_energy_defaults(&run.power);
+    while ((opt = getopt(argc, argv, "n:w:i:v:a:S:C:c:l:m:s:t:h")) != -1) {
+        int ok = 1;
+        switch (opt) {
+            case 'n' : ok = sim_parse_count(optarg, &run.games) && run.games; break;
+            case 'w' : run.linger = atof(optarg); ok = run.linger >= 0; break;
+            case 'i' : run.power.led_ma = atof(optarg); break;
+            case 'v' : run.power.supply_v = atof(optarg); break;
+            case 'a' : run.power.active_ma = atof(optarg); break;
+            case 'S' : run.power.idle_ma = atof(optarg); break;
+            case 'C' : run.power.capacity_mah = atof(optarg); ok = run.power.capacity_mah > 0; break;
+            case 'c' : ok = sim_energy_parse_cycles(&run.power, optarg); break;
+            case 'l' : run.channel.loss = atof(optarg); break;
+            case 'm' : run.miss_rate = atof(optarg); break;
+            case 's' : run.seed = strtoull(optarg, NULL, 0); break;
+            case 't' : ok = sim_parse_count(optarg, &value) && value; num_threads = value; break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    Stats total;
+    memset(&total, 0, sizeof(total));
+    sim_parallel_for(run.games, num_threads, run_chunk, &run, sizeof(Stats), merge_stats, &total);
+
+    printf("%llu matches between two kits, result shown for %g s, IR loss %g, stalled %llu\n",
+           (unsigned long long) total.games, run.linger, run.channel.loss, (unsigned long long) total.stalls);
+    // each match is counted on both kits
+    sim_energy_report(&total.energy, &run.power, 2 * total.games);
+    return total.stalls != 0;
+}
@@ -0,0 +1,17 @@
+/** @file font3x5_1.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief host stand-in for the UCFK4 font3x5_1 font, the simulator draws its glyphs with sim_tinygl.c
+ */
+
+
+#ifndef FONT3X5_1_H
+#define FONT3X5_1_H
+
+#include "font.h"
+
+
+extern const font_t font3x5_1;
+
+
+#endif
@@ -0,0 +1,460 @@
+/** @file handoff_bench.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief end-to-end ball handoff latency and bandwidth benchmark for two virtual kits under IR noise
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_bot.h"
+#include "sim_kit.h"
+#include "navswitch.h"
+#include "pong_display.h"
+
+#define DEFAULT_ROUNDS 500
+#define DEFAULT_SEED 260
+#define DEFAULT_TIMEOUT 6000 //ticks without progress before a round counts as deadlocked
+#define DEFAULT_MISS 0.1
+#define DEFAULT_BAUD 2400
+#define MAX_CONDITIONS 32
+#define NO_HANDOFF UINT64_MAX
+#define HANDOFF_SLOTS 8 //unmatched crossings kept per kit, a lockstep kit can run a few ahead of the other
+#define PROTOCOL_BALL 0 //the ball is sent across as it leaves a screen
+#define PROTOCOL_LOCKSTEP 1 //both kits run the whole court from each other's paddle inputs
+#define NUM_PROTOCOLS 2
+#define BITS_PER_BYTE 10 //the UART sends a start and stop bit with each byte
+
+
+static const char* protocol_names[NUM_PROTOCOLS] = {"ball", "lockstep"};
+
+
+typedef struct {
+    char label[64];
+    SimChannel channel;
+} Condition;
+
+
+/** Measurements for one channel condition */
+typedef struct {
+    uint64_t rounds;
+    uint64_t deadlocks;
+    uint64_t desyncs;
+    uint64_t resyncs; //times a kit took the other's state after a digest disagreed, the server's or side 0's in lockstep
+    uint64_t rollbacks; //lockstep inputs that arrived after their turn was shown, and differed from the prediction
+    uint64_t ticks;
+    uint64_t bytes_sent;
+    uint64_t bytes_lost;
+    int32_t* latency; //zero when the ball showed on the receiver before it left the sender
+    int32_t max_lead; //most ticks a lockstep receiver showed the ball before the sender let it go
+    size_t latency_count;
+    size_t latency_cap;
+} Result;
+
+
+/** The ball crossing between the screens, as one kit showed it */
+typedef struct {
+    uint16_t turn; //lockstep turn of the shown court it happened in, the same crossing has the same turn on both kits
+    uint64_t tick; //NO_HANDOFF once matched
+} Crossing;
+
+
+/** Both kits plus the round bookkeeping the benchmark keeps about them */
+typedef struct {
+    SimWorld world;
+    SimKit kits[2];
+    SimLink links[2];
+    SimBot bots[2];
+    uint8_t prev_mode[2];
+    uint8_t prev_on_screen[2];
+    Crossing departures[2][HANDOFF_SLOTS]; //unmatched times the ball left kit i
+    Crossing arrivals[2][HANDOFF_SLOTS]; //unmatched times the ball showed on kit i before leaving the other, lockstep only
+    uint8_t protocol;
+    uint8_t server;
+    uint8_t round_open;
+    uint8_t double_ball;
+    uint64_t last_progress;
+} Bench;
+
+
+/** Count the repairs each kit made during the session that is ending:
+    @param bench benchmark state
+    @param result where to count them */
+static void count_session (Bench* bench, Result* result)
+{
+    for (uint8_t i = 0; i < 2; i++) {
+        Game* game = &bench->kits[i].game;
+        result->resyncs += game->resyncs + game->lockstep.resyncs;
+        result->rollbacks += game->lockstep.rollbacks;
+    }
+}
+
+
+/** Power cycle both kits and empty the link, as players do after a hang:
+    @param bench benchmark state
+    @param result where to count the repairs of the session that is ending */
+static void reset_session (Bench* bench, Result* result)
+{
+    count_session(bench, result);
+    for (uint8_t i = 0; i < 2; i++) {
+        sim_kit_reset(&bench->kits[i]);
+        sim_link_clear(&bench->links[i]);
+        sim_bot_reset(&bench->bots[i]);
+        bench->bots[i].start_button = bench->protocol == PROTOCOL_LOCKSTEP ? NAVSWITCH_SOUTH : NAVSWITCH_PUSH;
+        bench->prev_mode[i] = START_MENU;
+        bench->prev_on_screen[i] = 0;
+        for (uint8_t slot = 0; slot < HANDOFF_SLOTS; slot++) {
+            bench->departures[i][slot].tick = NO_HANDOFF;
+            bench->arrivals[i][slot].tick = NO_HANDOFF;
+        }
+    }
+    bench->server = 0;
+    bench->round_open = 0;
+    bench->double_ball = 0;
+    bench->last_progress = bench->world.tick;
+}
+
+
+static void record_latency (Result* result, int64_t latency)
+{
+    if (result->latency_count == result->latency_cap) {
+        result->latency_cap = result->latency_cap ? 2 * result->latency_cap : 1024;
+        result->latency = realloc(result->latency, result->latency_cap * sizeof(int32_t));
+    }
+    result->latency[result->latency_count++] = latency;
+}
+
+
+/** Take the unmatched crossing with the given turn:
+    @param crossings crossings one kit showed
+    @param turn lockstep turn to look for, 0 under the ball protocol
+    @return tick of the crossing, NO_HANDOFF if there is none */
+static uint64_t take_crossing (Crossing* crossings, uint16_t turn)
+{
+    for (uint8_t slot = 0; slot < HANDOFF_SLOTS; slot++) {
+        if (crossings[slot].tick != NO_HANDOFF && crossings[slot].turn == turn) {
+            uint64_t tick = crossings[slot].tick;
+            crossings[slot].tick = NO_HANDOFF;
+            return tick;
+        }
+    }
+    return NO_HANDOFF;
+}
+
+
+/** Keep a crossing until the other kit shows its side of it, in place of the oldest:
+    @param crossings crossings one kit showed
+    @param turn lockstep turn it happened in, 0 under the ball protocol
+    @param tick tick it showed */
+static void keep_crossing (Crossing* crossings, uint16_t turn, uint64_t tick)
+{
+    uint8_t oldest = 0;
+    for (uint8_t slot = 1; slot < HANDOFF_SLOTS; slot++) {
+        if (crossings[slot].tick == NO_HANDOFF || crossings[slot].tick < crossings[oldest].tick) {
+            oldest = slot;
+        }
+    }
+    crossings[oldest].turn = turn;
+    crossings[oldest].tick = tick;
+}
+
+
+/** Close the current round, checking both kits agree on the score:
+    @param bench benchmark state
+    @param result where to count the round */
+static void close_round (Bench* bench, Result* result)
+{
+    Game* a = &bench->kits[0].game;
+    Game* b = &bench->kits[1].game;
+    result->rounds++;
+    bench->round_open = 0;
+    if (a->score != b->opponent_score || a->opponent_score != b->score || bench->double_ball) {
+        // every later round is meaningless once the kits disagree
+        result->desyncs++;
+        reset_session(bench, result);
+    }
+}
+
+
+/** Watch both kits after a tick for handoffs, round boundaries and hangs:
+    @param bench benchmark state
+    @param result measurements for the current condition */
+static void observe (Bench* bench, Result* result)
+{
+    uint64_t tick = bench->world.tick;
+    uint8_t in_play = 0;
+    uint8_t balls_on_screen = 0;
+
+    for (uint8_t i = 0; i < 2; i++) {
+        SimKit* kit = &bench->kits[i];
+        uint8_t mode = kit->game.game_mode;
+        uint8_t on_screen = mode == PLAY_MODE && kit->ball.on_screen && !kit->ball.dead;
+
+        if (mode != bench->prev_mode[i]) {
+            bench->last_progress = tick;
+            if (mode == PLAY_MODE && !bench->round_open) {
+                bench->round_open = 1;
+                bench->double_ball = 0;
+            } else if (mode == DISPLAY_SCORE_MODE && kit->ball.on_screen) {
+                // loser of the point serves next, even if the other kit never heard it was lost
+                bench->server = i;
+            }
+        } else if (mode == PLAY_MODE) {
+            // lockstep kits step the same court, so a crossing happens in the same turn on both;
+            // a ball sent across is matched with the one pending, as only one is ever in flight
+            uint16_t turn = bench->protocol == PROTOCOL_LOCKSTEP ? kit->game.lockstep.turn : 0;
+            if (bench->prev_on_screen[i] && !kit->ball.on_screen && !kit->ball.dead) {
+                uint64_t arrival = take_crossing(bench->arrivals[1 - i], turn);
+                if (arrival != NO_HANDOFF) {
+                    // a lockstep kit whose turns run ahead shows the ball before this one lets go
+                    int32_t lead = tick - arrival;
+                    result->max_lead = lead > result->max_lead ? lead : result->max_lead;
+                    record_latency(result, 0);
+                } else {
+                    keep_crossing(bench->departures[i], turn, tick);
+                }
+                bench->last_progress = tick;
+            } else if (!bench->prev_on_screen[i] && on_screen) {
+                uint64_t departure = take_crossing(bench->departures[1 - i], turn);
+                if (departure != NO_HANDOFF) {
+                    record_latency(result, tick - departure);
+                    bench->last_progress = tick;
+                } else if (bench->protocol == PROTOCOL_LOCKSTEP && bench->prev_on_screen[1 - i]) {
+                    keep_crossing(bench->arrivals[i], turn, tick);
+                }
+            }
+        }
+        if (mode != PLAY_MODE && bench->protocol == PROTOCOL_BALL) {
+            // the point is over, a ball still pending was lost with it
+            for (uint8_t slot = 0; slot < HANDOFF_SLOTS; slot++) {
+                bench->departures[0][slot].tick = NO_HANDOFF;
+                bench->departures[1][slot].tick = NO_HANDOFF;
+            }
+        }
+        bench->prev_mode[i] = mode;
+        bench->prev_on_screen[i] = on_screen;
+        in_play += mode == PLAY_MODE;
+        balls_on_screen += on_screen;
+    }
+    // lockstep kits can be a few ticks apart in showing the same court, so only the ball protocol can be caught out this way
+    bench->double_ball |= balls_on_screen > 1 && bench->protocol == PROTOCOL_BALL;
+
+    if (bench->round_open && !in_play) {
+        close_round(bench, result);
+    } else if (tick - bench->last_progress > DEFAULT_TIMEOUT) {
+        // nothing has happened for too long, one kit is waiting on the other forever
+        result->rounds += bench->round_open;
+        result->deadlocks++;
+        reset_session(bench, result);
+    } else if (bench->kits[0].game.game_mode == GAME_OVER_MODE && bench->kits[1].game.game_mode == GAME_OVER_MODE) {
+        reset_session(bench, result);
+    }
+}
+
+
+/** Run scripted rallies under one channel condition:
+    @param condition channel to run over
+    @param protocol PROTOCOL_BALL or PROTOCOL_LOCKSTEP
+    @param rounds number of rounds to complete
+    @param miss_rate probability a bot misses each approach
+    @param seed random seed
+    @param result where to place the measurements */
+static void run_condition (const Condition* condition, uint8_t protocol, uint64_t rounds, double miss_rate,
+                           uint64_t seed, Result* result)
+{
+    Bench bench;
+    memset(&bench, 0, sizeof(Bench));
+    bench.protocol = protocol;
+    memset(result, 0, sizeof(Result));
+    sim_world_init_pair(&bench.world, bench.kits, bench.links, &condition->channel, seed);
+    sim_bot_init(&bench.bots[0], miss_rate, seed, UINT32_MAX);
+    sim_bot_init(&bench.bots[1], miss_rate, seed, UINT32_MAX - 1);
+    reset_session(&bench, result);
+
+    uint64_t max_ticks = rounds * 100 * DEFAULT_TIMEOUT;
+    while (result->rounds < rounds && bench.world.tick < max_ticks) {
+        sim_bot_input(&bench.bots[0], &bench.kits[0], 1, bench.server == 0);
+        sim_bot_input(&bench.bots[1], &bench.kits[1], 0, bench.server == 1);
+        sim_world_step(&bench.world);
+        observe(&bench, result);
+    }
+    result->ticks = bench.world.tick;
+    count_session(&bench, result);
+    for (uint8_t i = 0; i < 2; i++) {
+        result->bytes_sent += bench.links[i].sent;
+        result->bytes_lost += bench.links[i].lost;
+        sim_kit_free(&bench.kits[i]);
+    }
+}
+
+
+static int compare_i32 (const void* a, const void* b)
+{
+    int32_t x = *(const int32_t*) a;
+    int32_t y = *(const int32_t*) b;
+    return (x > y) - (x < y);
+}
+
+
+/** Return the given percentile of a sorted array:
+    @param values sorted values
+    @param count number of values
+    @param percent percentile wanted, 0-100 */
+static int32_t percentile (const int32_t* values, size_t count, double percent)
+{
+    if (!count) {
+        return 0;
+    }
+    size_t index = (size_t) (percent / 100 * (count - 1) + 0.5);
+    return values[index];
+}
+
+
+/** Parse a condition such as "baud=2400,delay=2,jitter=3,loss=0.01,ber=0":
+    @param text the specification, unspecified keys keep their defaults
+    @param condition where to place the result
+    @return 1 on success, else 0 */
+static int parse_condition (const char* text, Condition* condition)
+{
+    char buffer[128];
+    SimChannel* channel = &condition->channel;
+    memset(condition, 0, sizeof(Condition));
+    channel->baud = DEFAULT_BAUD;
+    snprintf(condition->label, sizeof(condition->label), "%s", text);
+    snprintf(buffer, sizeof(buffer), "%s", text);
+
+    for (char* item = strtok(buffer, ","); item; item = strtok(NULL, ",")) {
+        char* value = strchr(item, '=');
+        if (!value) {
+            return 0;
+        }
+        *value++ = '\0';
+        if (!strcmp(item, "baud")) {
+            channel->baud = atoi(value);
+        } else if (!strcmp(item, "delay")) {
+            channel->delay = atof(value);
+        } else if (!strcmp(item, "jitter")) {
+            channel->jitter = atof(value);
+        } else if (!strcmp(item, "loss")) {
+            channel->loss = atof(value);
+        } else if (!strcmp(item, "ber")) {
+            channel->ber = atof(value);
+        } else {
+            return 0;
+        }
+    }
+    return channel->baud > 0;
+}
+
+
+static const char* default_conditions[] = {
+    "baud=2400",
+    "baud=1200",
+    "baud=2400,delay=3,jitter=6",
+    "baud=2400,loss=0.001",
+    "baud=2400,loss=0.01",
+    "baud=2400,loss=0.05",
+    "baud=2400,ber=0.001",
+    "baud=2400,ber=0.01",
+};
+
+
+static void usage (const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -c spec     channel condition, eg baud=2400,delay=2,jitter=3,loss=0.01,ber=0.001\n"
+        "              (delay and jitter in pacer ticks, repeat -c for several; default: a preset grid)\n"
+        "  -p protocol ball or lockstep, repeat -p for both (default: both)\n"
+        "  -r rounds   rounds to play per condition (default %d)\n"
+        "  -m rate     probability a bot misses the ball on each approach (default %g)\n"
+        "  -s seed     random seed (default %d)\n",
+        program, DEFAULT_ROUNDS, DEFAULT_MISS, DEFAULT_SEED);
+}
+
+
+int main (int argc, char* argv[])
+{
+    Condition conditions[MAX_CONDITIONS];
+    int num_conditions = 0;
+    uint64_t rounds = DEFAULT_ROUNDS;
+    uint64_t seed = DEFAULT_SEED;
+    double miss_rate = DEFAULT_MISS;
+    uint8_t protocols = 0; //mask of the protocols to run
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:p:r:m:s:h")) != -1) {
+        switch (opt) {
+            case 'c' :
+                if (num_conditions == MAX_CONDITIONS || !parse_condition(optarg, &conditions[num_conditions])) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                num_conditions++;
+                break;
+            case 'p' : {
+                uint8_t protocol = 0;
+                while (protocol < NUM_PROTOCOLS && strcmp(optarg, protocol_names[protocol])) {
+                    protocol++;
+                }
+                if (protocol == NUM_PROTOCOLS) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                protocols |= 1 << protocol;
+                break;
+            }
+            case 'r' :
+                if (!sim_parse_count(optarg, &rounds) || rounds == 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'm' : miss_rate = atof(optarg); break;
+            case 's' : seed = strtoull(optarg, NULL, 0); break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    if (!protocols) {
+        protocols = (1 << NUM_PROTOCOLS) - 1;
+    }
+    if (!num_conditions) {
+        for (size_t i = 0; i < sizeof(default_conditions) / sizeof(default_conditions[0]); i++) {
+            parse_condition(default_conditions[i], &conditions[num_conditions++]);
+        }
+    }
+
+    printf("seed %llu, %llu rounds per condition, latency in pacer ticks (%d Hz)\n\n",
+           (unsigned long long) seed, (unsigned long long) rounds, PACER_RATE);
+    printf("%-32s %-8s %7s %8s %5s %5s %5s %5s %9s %8s %7s %8s %7s %6s %8s %5s\n", "condition", "protocol",
+           "rounds", "handoffs", "min", "p50", "p99", "max", "deadlock", "desync", "resync", "lost", "B/s", "load", "rollback", "lead");
+    for (int i = 0; i < num_conditions; i++) {
+        for (uint8_t protocol = 0; protocol < NUM_PROTOCOLS; protocol++) {
+            if (!(protocols >> protocol & 1)) {
+                continue;
+            }
+            Result result;
+            run_condition(&conditions[i], protocol, rounds, miss_rate, seed, &result);
+            qsort(result.latency, result.latency_count, sizeof(int32_t), compare_i32);
+            double rounds_run = result.rounds ? result.rounds : 1;
+            // bytes each kit sends per second, start menu and result screens included
+            double rate = result.bytes_sent / 2.0 * PACER_RATE / result.ticks;
+            double capacity = (double) conditions[i].channel.baud / BITS_PER_BYTE;
+            printf("%-32s %-8s %7llu %8zu %5d %5d %5d %5d %8.2f%% %7.2f%% %7llu %8llu %7.1f %5.1f%% %8llu %5d\n",
+                   conditions[i].label, protocol_names[protocol], (unsigned long long) result.rounds,
+                   result.latency_count, percentile(result.latency, result.latency_count, 0),
+                   percentile(result.latency, result.latency_count, 50),
+                   percentile(result.latency, result.latency_count, 99),
+                   percentile(result.latency, result.latency_count, 100),
+                   100 * result.deadlocks / rounds_run, 100 * result.desyncs / rounds_run,
+                   (unsigned long long) result.resyncs, (unsigned long long) result.bytes_lost, rate,
+                   100 * rate / capacity, (unsigned long long) result.rollbacks, result.max_lead);
+            free(result.latency);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,25 @@
+/** @file font.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief host stand-in for the UCFK4 font type
+ */
+
+
+#ifndef FONT_H
+#define FONT_H
+
+#include "system.h"
+
+
+typedef struct font_struct {
+    uint8_t flags;
+    uint8_t width;
+    uint8_t height;
+    uint8_t offset;
+    uint8_t size;
+    uint8_t bytes;
+    const uint8_t* data;
+} font_t;
+
+
+#endif
@@ -0,0 +1,30 @@
+/** @file ir_uart.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief host stand-in for the UCFK4 IR UART driver, bytes travel over a simulated link
+ */
+
+
+#ifndef IR_UART_H
+#define IR_UART_H
+
+#include "system.h"
+
+
+int8_t ir_uart_init (void);
+
+
+void ir_uart_putc (char ch);
+
+
+/** Blocks (yields to the simulator) until a byte has arrived, as on the kit */
+char ir_uart_getc (void);
+
+
+bool ir_uart_read_ready_p (void);
+
+
+bool ir_uart_write_ready_p (void);
+
+
+#endif
@@ -0,0 +1,40 @@
+/** @file navswitch.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief host stand-in for the UCFK4 navswitch driver, events are scripted by the simulator
+ */
+
+
+#ifndef NAVSWITCH_H
+#define NAVSWITCH_H
+
+#include "system.h"
+
+
+enum {
+    NAVSWITCH_NORTH,
+    NAVSWITCH_EAST,
+    NAVSWITCH_SOUTH,
+    NAVSWITCH_WEST,
+    NAVSWITCH_PUSH
+};
+
+#define NAVSWITCH_NUM 5
+
+
+void navswitch_init (void);
+
+
+void navswitch_update (void);
+
+
+bool navswitch_push_event_p (uint8_t navswitch);
+
+
+bool navswitch_release_event_p (uint8_t navswitch);
+
+
+bool navswitch_down_p (uint8_t navswitch);
+
+
+#endif
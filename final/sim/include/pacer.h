@@ -0,0 +1,20 @@
+/** @file pacer.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief host stand-in for the UCFK4 pacer, each wait hands control back to the simulator
+ */
+
+
+#ifndef PACER_H
+#define PACER_H
+
+#include "system.h"
+
+
+void pacer_init (uint16_t pacer_rate);
+
+
+void pacer_wait (void);
+
+
+#endif
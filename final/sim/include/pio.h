@@ -0,0 +1,34 @@
+/** @file pio.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief host stand-in for the UCFK4 pio driver, pin levels are kept per virtual kit
+ */
+
+
+#ifndef PIO_H
+#define PIO_H
+
+#include "system.h"
+
+
+typedef uint8_t pio_t;
+
+
+typedef enum {
+    PIO_INPUT = 1,
+    PIO_PULLUP,
+    PIO_OUTPUT_LOW,
+    PIO_OUTPUT_HIGH
+} pio_config_t;
+
+
+bool pio_config_set (pio_t pio, pio_config_t config);
+
+
+void pio_output_high (pio_t pio);
+
+
+void pio_output_low (pio_t pio);
+
+
+#endif
@@ -0,0 +1,39 @@
+/** @file system.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief host stand-in for the UCFK4 system header, used by the simulator
+ */
+
+
+#ifndef SYSTEM_H
+#define SYSTEM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define F_CPU 8000000
+
+/* LED matrix pins are numbered so the simulated pio can tell rows (0-6)
+ * from columns (8-12) */
+#define LEDMAT_ROWS_NUM 7
+#define LEDMAT_COLS_NUM 5
+#define LEDMAT_COL_PIO_BASE 8
+
+#define LEDMAT_ROW1_PIO 0
+#define LEDMAT_ROW2_PIO 1
+#define LEDMAT_ROW3_PIO 2
+#define LEDMAT_ROW4_PIO 3
+#define LEDMAT_ROW5_PIO 4
+#define LEDMAT_ROW6_PIO 5
+#define LEDMAT_ROW7_PIO 6
+#define LEDMAT_COL1_PIO (LEDMAT_COL_PIO_BASE + 0)
+#define LEDMAT_COL2_PIO (LEDMAT_COL_PIO_BASE + 1)
+#define LEDMAT_COL3_PIO (LEDMAT_COL_PIO_BASE + 2)
+#define LEDMAT_COL4_PIO (LEDMAT_COL_PIO_BASE + 3)
+#define LEDMAT_COL5_PIO (LEDMAT_COL_PIO_BASE + 4)
+
+
+void system_init (void);
+
+
+#endif
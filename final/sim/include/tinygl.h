@@ -0,0 +1,42 @@
+/** @file tinygl.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief host stand-in for tinygl, records what each virtual kit is asked to show
+ */
+
+
+#ifndef TINYGL_H
+#define TINYGL_H
+
+#include "system.h"
+#include "font.h"
+
+
+typedef enum {
+    TINYGL_TEXT_MODE_STEP,
+    TINYGL_TEXT_MODE_SCROLL
+} tinygl_text_mode_t;
+
+
+void tinygl_init (const uint16_t update_rate);
+
+
+void tinygl_font_set (const font_t* font);
+
+
+void tinygl_text_speed_set (uint8_t speed);
+
+
+void tinygl_text (const char* string);
+
+
+void tinygl_text_mode_set (tinygl_text_mode_t text_mode);
+
+
+void tinygl_update (void);
+
+
+void tinygl_clear (void);
+
+
+#endif
@@ -0,0 +1,51 @@
+/** @file landing_table_gen.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief build-time generator of landing_table.c from the branching update_location
+ */
+
+
+#include <stdio.h>
+#include "ball.h"
+#include "landing_table.h"
+
+#define NO_PADDLE UINT8_MAX //paddle position that no ball can touch
+
+
+int main (int argc, char* argv[])
+{
+    uint8_t table[LANDING_TABLE_SIZE];
+    FILE* out = stdout;
+
+    if (argc > 2) {
+        fprintf(stderr, "usage: %s [landing_table.c]\n", argv[0]);
+        return 1;
+    }
+
+    for (uint8_t x = LEFT_WALL; x <= RIGHT_WALL; x++) {
+        for (int8_t direction = LEFT; direction <= RIGHT; direction++) {
+            Ball ball;
+            ball_init(&ball, x, HEIGHT - 1, direction, DOWN, ON_SCREEN);
+            while (ball.y != GROUND + 1) {
+                update_location(&ball, NO_PADDLE);
+            }
+            table[LANDING_TABLE_INDEX(x, direction)] = ball.x;
+        }
+    }
+
+    if (argc == 2 && !(out = fopen(argv[1], "w"))) {
+        perror(argv[1]);
+        return 1;
+    }
+    fprintf(out, "/** @file landing_table.c\n"
+                 " * @brief generated by sim/landing_table_gen from ball.c, do not edit\n"
+                 " */\n\n\n"
+                 "#include \"landing_table.h\"\n\n\n"
+                 "const uint8_t landing_table[LANDING_TABLE_SIZE] PROGMEM = {\n");
+    for (uint8_t x = 0; x < LANDING_TABLE_COLUMNS; x++) {
+        fprintf(out, "    %u, %u, %u,\n", table[LANDING_TABLE_INDEX(x, LEFT)], table[LANDING_TABLE_INDEX(x, STRAIGHT)],
+                table[LANDING_TABLE_INDEX(x, RIGHT)]);
+    }
+    fprintf(out, "};\n");
+    return out != stdout && fclose(out) ? 1 : 0;
+}
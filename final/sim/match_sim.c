@@ -0,0 +1,455 @@
+/** @file match_sim.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief headless AI-vs-AI rally simulator running the real ball and paddle logic
+ */
+
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ball.h"
+#include "paddle.h"
+#include "sim_bot.h"
+#include "sim_util.h"
+
+#define CHUNK_RALLIES 4096
+#define DEFAULT_RALLIES 10000000
+#define DEFAULT_SEED 260
+#define DEFAULT_SPEED 5 //paddle moves per ball step at serve speed: BALL_RATE 100 ticks over a 20 tick human move
+#define SERVE_PERIOD ((BALL_RATE + 1) << BALL_FRACTION_BITS) //Q8.8 ticks per step before any paddle hit
+#define DEFAULT_ERROR 0.1
+#define DEFAULT_MAX_STEPS 100000
+#define MAX_HITS_BUCKET 256 //rally lengths at or above this share the last bucket
+#define NUM_COLUMNS (RIGHT_WALL + 1)
+#define NUM_OFFSETS 3 //ball met the left, centre or right of the paddle
+#define NUM_SIDES 2
+#define AIM_MISS 3 //columns a predicting AI is off by when it errs
+
+
+/* A rally is played with ball.c's update_location on one half at a time. When
+ * the ball leaves a half it is handed over exactly as transmit_ball and
+ * receive_ball do: x and direction_x mirrored, entering from the top moving
+ * down, keeping its speed. The paddle on the ball's half gets up to speed moves
+ * before each step at serve speed, fewer as the ball's period shrinks. */
+
+
+/** Paddle strategies */
+typedef enum {
+    AI_PREDICT, //move to where the ball will land, hitting with a random part of the paddle
+    AI_CENTRE, //as predict, but always meet the ball with the centre of the paddle
+    AI_TRACK, //follow the ball's current column
+    AI_RANDOM, //random moves
+    AI_STILL, //never moves
+    NUM_AIS
+} Strategy;
+
+
+static const char* ai_names[NUM_AIS] = {"predict", "centre", "track", "random", "still"};
+
+
+typedef struct {
+    Strategy ai;
+    double error; //chance per approach that a predicting AI aims wrong
+} Player;
+
+
+/** Read-only run settings */
+typedef struct {
+    Player players[NUM_SIDES];
+    uint64_t rallies;
+    uint64_t seed;
+    uint32_t max_steps;
+    uint8_t speed;
+    uint8_t deterministic; //1 if no player uses randomness, so a repeated state is a true loop
+} Run;
+
+
+/** Per-thread results, merged at the end */
+typedef struct {
+    uint64_t rallies;
+    uint64_t steps;
+    uint64_t server_wins;
+    uint64_t wins[NUM_SIDES];
+    uint64_t endless; //rallies stopped at max_steps
+    uint64_t loops; //endless rallies proven to be cycling
+    uint64_t length[MAX_HITS_BUCKET + 1];
+    uint64_t column_hits[NUM_SIDES][NUM_COLUMNS];
+    uint64_t offset_hits[NUM_SIDES][NUM_OFFSETS];
+} Stats;
+
+
+/** Pack everything that determines the future of a deterministic rally:
+    @param ball the ball
+    @param side half the ball is on
+    @param paddles paddle positions
+    @param targets where each player is heading */
+static uint32_t pack_state (const Ball* ball, uint8_t side, const uint8_t paddles[], const uint8_t targets[])
+{
+    return side | ball->x << 1 | ball->y << 4 | (ball->direction_x + 1) << 7 | (ball->direction_y > 0) << 9
+           | paddles[0] << 10 | paddles[1] << 13 | targets[0] << 16 | targets[1] << 19 | (uint32_t) ball->speed << 22;
+}
+
+
+/** Choose where a player heads when the ball arrives on their half:
+    @param player the player
+    @param ball the ball as it arrives
+    @param paddle current paddle position
+    @param rng generator for this chunk */
+static uint8_t choose_target (const Player* player, const Ball* ball, uint8_t paddle, SimRng* rng)
+{
+    uint8_t landing = sim_bot_predict_landing(ball);
+    int8_t target = landing;
+    switch (player->ai) {
+        case AI_PREDICT :
+            target += (int8_t) sim_rng_below(rng, 3) - 1; //any part of the paddle
+            // fall through
+        case AI_CENTRE :
+            if (player->error > 0 && sim_rng_uniform(rng) < player->error) {
+                target = landing > RIGHT_WALL / 2 ? landing - AIM_MISS : landing + AIM_MISS;
+            }
+            break;
+        case AI_TRACK :
+            target = ball->x;
+            break;
+        case AI_RANDOM :
+            target = sim_rng_below(rng, NUM_COLUMNS);
+            break;
+        case AI_STILL :
+            target = paddle;
+            break;
+        default :
+            break;
+    }
+    if (target < PADDLE_LIMIT_LEFT) {
+        target = PADDLE_LIMIT_LEFT;
+    } else if (target > PADDLE_LIMIT_RIGHT) {
+        target = PADDLE_LIMIT_RIGHT;
+    }
+    return target;
+}
+
+
+/** Step a paddle towards its target using the paddle module:
+    @param paddle the paddle
+    @param target column to head for
+    @param moves moves allowed this step */
+static void move_towards (Paddle* paddle, uint8_t target, uint8_t moves)
+{
+    for (uint8_t i = 0; i < moves; i++) {
+        if (paddle->pos < target) {
+            paddle_move_right(paddle);
+        } else if (paddle->pos > target) {
+            paddle_move_left(paddle);
+        } else {
+            break;
+        }
+    }
+}
+
+
+/** Play one rally to its end:
+    @param run run settings
+    @param rng generator for this chunk
+    @param stats where to count the results */
+static void play_rally (const Run* run, SimRng* rng, Stats* stats)
+{
+    Paddle paddles[NUM_SIDES];
+    uint8_t targets[NUM_SIDES];
+    uint8_t server = sim_rng_below(rng, NUM_SIDES);
+    uint8_t side = server;
+    uint32_t hits = 0;
+    uint32_t steps = 0;
+    Ball ball;
+
+    for (uint8_t i = 0; i < NUM_SIDES; i++) {
+        paddles[i].pos = run->deterministic ? PADDLE_START_POS : sim_rng_below(rng, NUM_COLUMNS);
+        targets[i] = paddles[i].pos;
+    }
+    ball_init(&ball, paddles[server].pos, GROUND + 1, STRAIGHT, UP, ON_SCREEN);
+
+    // Brent's cycle detection, only meaningful when nothing random happens
+    uint32_t saved = 0;
+    uint32_t power = 1;
+    uint32_t lambda = 0;
+    uint8_t looped = 0;
+
+    while (1) {
+        uint8_t paddle = paddles[side].pos;
+        if (ball.y == GROUND + 1 && ball.direction_y == DOWN) {
+            int8_t offset = ball.x - paddle;
+            if (offset >= -1 && offset <= 1) {
+                hits++;
+                stats->column_hits[side][ball.x]++;
+                stats->offset_hits[side][offset + 1]++;
+            }
+        }
+        update_location(&ball, paddle);
+        steps++;
+
+        if (ball.dead) {
+            stats->wins[1 - side]++;
+            stats->server_wins += 1 - side == server;
+            break;
+        }
+        if (!ball.on_screen) {
+            // same mirroring as transmit_ball/receive_ball
+            uint8_t speed = ball.speed;
+            ball_init(&ball, RIGHT_WALL - ball.x, HEIGHT - 1, -ball.direction_x, DOWN, ON_SCREEN);
+            ball_set_speed(&ball, speed);
+            side = 1 - side;
+            targets[side] = choose_target(&run->players[side], &ball, paddles[side].pos, rng);
+        }
+        move_towards(&paddles[side], targets[side], (run->speed * ball.period + SERVE_PERIOD / 2) / SERVE_PERIOD);
+
+        if (steps >= run->max_steps) {
+            stats->endless++;
+            stats->loops += looped;
+            break;
+        }
+        if (run->deterministic && !looped) {
+            uint8_t positions[NUM_SIDES] = {paddles[0].pos, paddles[1].pos};
+            uint32_t state = pack_state(&ball, side, positions, targets);
+            lambda++;
+            if (state == saved) {
+                looped = 1;
+                stats->endless++;
+                stats->loops++;
+                break;
+            }
+            if (lambda == power) {
+                saved = state;
+                power <<= 1;
+                lambda = 0;
+            }
+        }
+    }
+    stats->rallies++;
+    stats->steps += steps;
+    stats->length[hits < MAX_HITS_BUCKET ? hits : MAX_HITS_BUCKET]++;
+}
+
+
+/** Play one chunk of rallies:
+    @param context the Run
+    @param accumulator this thread's Stats
+    @param chunk chunk index */
+static void run_chunk (void* context, void* accumulator, uint64_t chunk)
+{
+    const Run* run = context;
+    SimRng rng;
+    uint64_t first = chunk * CHUNK_RALLIES;
+    uint64_t count = run->rallies - first < CHUNK_RALLIES ? run->rallies - first : CHUNK_RALLIES;
+    sim_rng_seed(&rng, run->seed, chunk);
+    for (uint64_t i = 0; i < count; i++) {
+        play_rally(run, &rng, accumulator);
+    }
+}
+
+
+/** Add one thread's counts into the total. Every field is a count, so the slots can be summed word by word:
+    @param total the total Stats
+    @param accumulator one thread's Stats */
+static void merge_stats (void* total, const void* accumulator)
+{
+    const uint64_t* from = accumulator;
+    uint64_t* to = total;
+    for (size_t j = 0; j < sizeof(Stats) / sizeof(uint64_t); j++) {
+        to[j] += from[j];
+    }
+}
+
+
+/** Play every rally across a thread pool:
+    @param run run settings
+    @param num_threads number of worker threads
+    @param total where to place merged results
+    @return wall clock seconds taken */
+static double run_rallies (const Run* run, unsigned num_threads, Stats* total)
+{
+    struct timespec begin, finish;
+    uint64_t num_chunks = (run->rallies + CHUNK_RALLIES - 1) / CHUNK_RALLIES;
+
+    memset(total, 0, sizeof(Stats));
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    sim_parallel_for(num_chunks, num_threads, run_chunk, (void*) run, sizeof(Stats), merge_stats, total);
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+    return (finish.tv_sec - begin.tv_sec) + (finish.tv_nsec - begin.tv_nsec) * 1e-9;
+}
+
+
+/** Return the smallest rally length with at least the given fraction of rallies at or below it */
+static uint32_t length_percentile (const Stats* stats, double fraction)
+{
+    uint64_t needed = (uint64_t) ceil(fraction * stats->rallies);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i <= MAX_HITS_BUCKET; i++) {
+        seen += stats->length[i];
+        if (seen >= needed && seen) {
+            return i;
+        }
+    }
+    return MAX_HITS_BUCKET;
+}
+
+
+static void print_report (const Run* run, const Stats* stats)
+{
+    uint64_t total_hits = 0;
+    for (uint32_t i = 0; i <= MAX_HITS_BUCKET; i++) {
+        total_hits += i * stats->length[i];
+    }
+    double n = stats->rallies;
+    double decided = n - stats->endless;
+    double server_rate = decided ? stats->server_wins / decided : 0;
+
+    printf("\nrally length (paddle hits): mean %.2f, p50 %u, p90 %u, p99 %u, max %s%u\n",
+           total_hits / n, length_percentile(stats, 0.5), length_percentile(stats, 0.9),
+           length_percentile(stats, 0.99), stats->length[MAX_HITS_BUCKET] ? ">=" : "",
+           length_percentile(stats, 1.0));
+    printf("mean ball steps per rally %.1f\n", stats->steps / n);
+
+    printf("\n%6s %12s %8s\n", "hits", "rallies", "share");
+    uint32_t bucket = 1;
+    for (uint32_t low = 0; low <= MAX_HITS_BUCKET; low += bucket, bucket *= low >= 4 ? 2 : 1) {
+        uint32_t high = low + bucket - 1 > MAX_HITS_BUCKET ? MAX_HITS_BUCKET : low + bucket - 1;
+        uint64_t count = 0;
+        for (uint32_t i = low; i <= high; i++) {
+            count += stats->length[i];
+        }
+        if (count) {
+            char label[16];
+            snprintf(label, sizeof(label), high > low ? "%u-%u" : "%u", low, high);
+            int bar = (int) (50 * count / n + 0.5);
+            printf("%6s %12llu %7.3f%% %.*s\n", label, (unsigned long long) count, 100 * count / n, bar,
+                   "##################################################");
+        }
+    }
+
+    printf("\nserver wins %.3f%% of decided rallies (+-%.3f%% at 95%%), side A %llu, side B %llu\n",
+           100 * server_rate, 196 * sqrt(server_rate * (1 - server_rate) / (decided ? decided : 1)),
+           (unsigned long long) stats->wins[0], (unsigned long long) stats->wins[1]);
+    printf("endless rallies (>= %u steps): %llu", run->max_steps, (unsigned long long) stats->endless);
+    if (run->deterministic) {
+        printf(", of which proven loops: %llu", (unsigned long long) stats->loops);
+    }
+    printf("\n");
+
+    for (uint8_t side = 0; side < NUM_SIDES; side++) {
+        uint64_t side_hits = 0;
+        for (uint8_t c = 0; c < NUM_COLUMNS; c++) {
+            side_hits += stats->column_hits[side][c];
+        }
+        printf("\nside %c (%s) hits by column\n  ", 'A' + side, ai_names[run->players[side].ai]);
+        for (uint8_t c = 0; c < NUM_COLUMNS; c++) {
+            printf("%7u", c);
+        }
+        printf("\n  ");
+        for (uint8_t c = 0; c < NUM_COLUMNS; c++) {
+            printf("%6.2f%%", side_hits ? 100.0 * stats->column_hits[side][c] / side_hits : 0);
+        }
+        printf("\n  paddle left %.2f%%, centre %.2f%%, right %.2f%%\n",
+               side_hits ? 100.0 * stats->offset_hits[side][0] / side_hits : 0,
+               side_hits ? 100.0 * stats->offset_hits[side][1] / side_hits : 0,
+               side_hits ? 100.0 * stats->offset_hits[side][2] / side_hits : 0);
+    }
+}
+
+
+/** Parse a player such as "predict" or "centre:0.05":
+    @param text the specification, the number is the error rate
+    @param player where to place the result
+    @return 1 on success, else 0 */
+static int parse_player (const char* text, Player* player)
+{
+    const char* colon = strchr(text, ':');
+    size_t length = colon ? (size_t) (colon - text) : strlen(text);
+    for (int i = 0; i < NUM_AIS; i++) {
+        if (strlen(ai_names[i]) == length && !strncmp(text, ai_names[i], length)) {
+            player->ai = i;
+            if (colon) {
+                player->error = atof(colon + 1);
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+static void usage (const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -a ai[:error]  side A player: predict, centre, track, random or still (default predict:%g)\n"
+        "  -b ai[:error]  side B player (default predict:%g)\n"
+        "  -n rallies     rallies to play, eg 1e8 (default %d)\n"
+        "  -v moves       paddle moves per ball step (default %d)\n"
+        "  -x steps       ball steps before a rally counts as endless (default %d)\n"
+        "  -s seed        random seed (default %d)\n"
+        "  -t threads     worker threads (default: number of cores)\n"
+        "  -S             measure scaling from 1 thread up to -t threads\n",
+        program, DEFAULT_ERROR, DEFAULT_ERROR, DEFAULT_RALLIES, DEFAULT_SPEED, DEFAULT_MAX_STEPS, DEFAULT_SEED);
+}
+
+
+int main (int argc, char* argv[])
+{
+    Run run = {
+        {{AI_PREDICT, DEFAULT_ERROR}, {AI_PREDICT, DEFAULT_ERROR}},
+        DEFAULT_RALLIES, DEFAULT_SEED, DEFAULT_MAX_STEPS, DEFAULT_SPEED, 0
+    };
+    unsigned num_threads = sim_default_threads();
+    uint64_t value;
+    int scaling = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:b:n:v:x:s:t:Sh")) != -1) {
+        int ok = 1;
+        switch (opt) {
+            case 'a' : ok = parse_player(optarg, &run.players[0]); break;
+            case 'b' : ok = parse_player(optarg, &run.players[1]); break;
+            case 'n' : ok = sim_parse_count(optarg, &run.rallies) && run.rallies; break;
+            case 'v' : run.speed = atoi(optarg); break;
+            case 'x' : ok = sim_parse_count(optarg, &value) && value && value < UINT32_MAX; run.max_steps = value; break;
+            case 's' : run.seed = strtoull(optarg, NULL, 0); break;
+            case 't' : ok = sim_parse_count(optarg, &value) && value; num_threads = value; break;
+            case 'S' : scaling = 1; break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    run.deterministic = 1;
+    for (uint8_t i = 0; i < NUM_SIDES; i++) {
+        Player* player = &run.players[i];
+        run.deterministic &= player->ai == AI_TRACK || player->ai == AI_STILL
+                             || (player->ai == AI_CENTRE && player->error == 0);
+    }
+
+    Stats stats;
+    printf("%s vs %s, %llu rallies, seed %llu\n", ai_names[run.players[0].ai], ai_names[run.players[1].ai],
+           (unsigned long long) run.rallies, (unsigned long long) run.seed);
+    if (scaling) {
+        double base = 0;
+        printf("\n%8s %14s %9s %11s\n", "threads", "rallies/s", "speedup", "efficiency");
+        for (unsigned threads = 1; threads <= num_threads; threads = threads * 2 > num_threads && threads != num_threads ? num_threads : threads * 2) {
+            double seconds = run_rallies(&run, threads, &stats);
+            double rate = run.rallies / seconds;
+            base = base ? base : rate;
+            printf("%8u %14.0f %8.2fx %10.1f%%\n", threads, rate, rate / base, 100 * rate / base / threads);
+        }
+    } else {
+        double seconds = run_rallies(&run, num_threads, &stats);
+        printf("%u threads, %.3f s, %.0f rallies/s\n", num_threads, seconds, run.rallies / seconds);
+    }
+    print_report(&run, &stats);
+    return 0;
+}
@@ -0,0 +1,455 @@
+/** @file mem_budget.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief build-time RAM and flash budget of game.out, with a worst-case stack estimate from main
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_RAM_SIZE 1024 //ATmega32U2 SRAM
+#define DEFAULT_FLASH_SIZE 28672 //32 KB less the 4 KB DFU bootloader
+#define DEFAULT_RAM_HEADROOM 64
+#define DEFAULT_FLASH_HEADROOM 1024
+#define DEFAULT_TOP 20
+#define RAM_START 0x800000 //avr-gcc places data addresses here, above flash
+#define RAM_END 0x810000
+#define RETURN_ADDRESS 2 //bytes a call pushes, the 32U2 has a 16 bit program counter
+#define MAX_FUNCTIONS 1024
+#define MAX_EDGES 8192
+#define MAX_SYMBOLS 2048
+#define NAME_LENGTH 64
+#define NO_CALLEE -1
+
+
+/* Static RAM and flash come from avr-size -A and the symbols from avr-nm.
+ * The stack estimate combines the frame size gcc reports for each function
+ * (-fstack-usage) with the call graph read from avr-objdump -d. The deepest
+ * path from main is added to the deepest interrupt handler, since one can
+ * fire at any point. Calls through function pointers cannot be followed and
+ * are listed. Recursion makes the stack unbounded and fails the check. */
+
+
+/** A function in the call graph */
+typedef struct {
+    char name[NAME_LENGTH];
+    int frame; //bytes from -fstack-usage, -1 if gcc reported none
+    int first_edge;
+    int num_edges;
+    int indirect; //1 if it calls through a pointer
+    int state; //0 unvisited, 1 on the current path, 2 done
+    int depth; //worst-case stack from its entry, once done
+    int deepest; //callee on the worst-case path, or NO_CALLEE
+} Function;
+
+
+/** A call, or a jump to the start of another function */
+typedef struct {
+    int caller;
+    int callee;
+    int pushes; //RETURN_ADDRESS for a call, 0 for a tail jump
+} Edge;
+
+
+/** A named object or function from avr-nm */
+typedef struct {
+    char name[NAME_LENGTH];
+    unsigned long address;
+    unsigned long size;
+} Symbol;
+
+
+static Function functions[MAX_FUNCTIONS];
+static int num_functions;
+static Edge edges[MAX_EDGES];
+static int num_edges;
+static Symbol ram_symbols[MAX_SYMBOLS];
+static int num_ram_symbols;
+static Symbol flash_symbols[MAX_SYMBOLS];
+static int num_flash_symbols;
+static int recursive;
+
+
+/** Find a function by name, adding it if it is new:
+    @param name function name
+    @return its index, or -1 if the table is full */
+static int function_index (const char* name)
+{
+    for (int i = 0; i < num_functions; i++) {
+        if (strcmp(functions[i].name, name) == 0) {
+            return i;
+        }
+    }
+    if (num_functions == MAX_FUNCTIONS) {
+        return -1;
+    }
+    Function* function = &functions[num_functions];
+    snprintf(function->name, NAME_LENGTH, "%s", name);
+    function->frame = -1;
+    function->deepest = NO_CALLEE;
+    return num_functions++;
+}
+
+
+/** Open an input file, reporting failure:
+    @param path file to open */
+static FILE* open_input (const char* path)
+{
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+    }
+    return file;
+}
+
+
+/** Read section sizes written by avr-size -A:
+    @param path section listing
+    @param text where to place the size of .text
+    @param data where to place the size of .data
+    @param bss where to place the size of .bss and .noinit
+    @return 1 if the file was read, else 0 */
+static int read_sections (const char* path, unsigned long* text, unsigned long* data, unsigned long* bss)
+{
+    FILE* file = open_input(path);
+    char line[256];
+    char name[NAME_LENGTH];
+    unsigned long size;
+    if (!file) {
+        return 0;
+    }
+    *text = *data = *bss = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%63s %lu", name, &size) != 2) {
+            continue;
+        }
+        if (strcmp(name, ".text") == 0) {
+            *text = size;
+        } else if (strcmp(name, ".data") == 0) {
+            *data = size;
+        } else if (strcmp(name, ".bss") == 0 || strcmp(name, ".noinit") == 0) {
+            *bss += size;
+        }
+    }
+    fclose(file);
+    return 1;
+}
+
+
+/** Read symbols written by avr-nm --print-size --defined-only:
+    @param path symbol listing
+    @return 1 if the file was read, else 0 */
+static int read_symbols (const char* path)
+{
+    FILE* file = open_input(path);
+    char line[256];
+    if (!file) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), file)) {
+        Symbol symbol;
+        char type;
+        if (sscanf(line, "%lx %lx %c %63s", &symbol.address, &symbol.size, &type, symbol.name) != 4) {
+            continue; //no size, eg a linker label
+        }
+        if (symbol.address >= RAM_START && symbol.address < RAM_END && strchr("bBdDvV", type)
+            && num_ram_symbols < MAX_SYMBOLS) {
+            ram_symbols[num_ram_symbols++] = symbol;
+        } else if (symbol.address < RAM_START && strchr("tTwW", type) && num_flash_symbols < MAX_SYMBOLS) {
+            flash_symbols[num_flash_symbols++] = symbol;
+        }
+    }
+    fclose(file);
+    return 1;
+}
+
+
+/** Read the frame sizes gcc writes with -fstack-usage, eg "game.c:181:13:play_round  16  static":
+    @param path .su files run together
+    @return 1 if the file was read, else 0 */
+static int read_stack_usage (const char* path)
+{
+    FILE* file = open_input(path);
+    char line[512];
+    if (!file) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), file)) {
+        char* tab = strchr(line, '\t');
+        if (!tab) {
+            continue;
+        }
+        *tab = '\0';
+        char* name = strrchr(line, ':');
+        name = name ? name + 1 : line;
+        int index = function_index(name);
+        int frame = atoi(tab + 1);
+        if (index >= 0 && frame > functions[index].frame) {
+            functions[index].frame = frame; //static functions can share a name across files
+        }
+    }
+    fclose(file);
+    return 1;
+}
+
+
+/** Read the call graph out of avr-objdump -d:
+    @param path disassembly
+    @return 1 if the file was read, else 0 */
+static int read_calls (const char* path)
+{
+    FILE* file = open_input(path);
+    char line[512];
+    int current = -1;
+    if (!file) {
+        return 0;
+    }
+    while (fgets(line, sizeof(line), file)) {
+        char name[NAME_LENGTH];
+        unsigned long address;
+        if (sscanf(line, "%lx <%63[^>]>:", &address, name) == 2) {
+            current = function_index(name);
+            continue;
+        }
+        // instruction lines are "address:<tab>bytes<tab>mnemonic<tab>operands"
+        char* field = strchr(line, '\t');
+        field = field ? strchr(field + 1, '\t') : NULL;
+        if (current < 0 || !field) {
+            continue;
+        }
+        char mnemonic[16];
+        if (sscanf(field + 1, "%15s", mnemonic) != 1) {
+            continue;
+        }
+        if (strcmp(mnemonic, "icall") == 0 || strcmp(mnemonic, "eicall") == 0 || strcmp(mnemonic, "ijmp") == 0
+            || strcmp(mnemonic, "eijmp") == 0) {
+            functions[current].indirect = 1;
+            continue;
+        }
+        int call = strcmp(mnemonic, "call") == 0 || strcmp(mnemonic, "rcall") == 0;
+        int jump = strcmp(mnemonic, "jmp") == 0 || strcmp(mnemonic, "rjmp") == 0;
+        char* open = strrchr(line, '<');
+        if (!(call || jump) || !open || sscanf(open, "<%63[^>+]>", name) != 1 || strchr(open, '+')) {
+            continue; //not a call, or a jump within a function
+        }
+        int callee = function_index(name);
+        if (callee < 0 || (jump && callee == current) || num_edges == MAX_EDGES) {
+            continue;
+        }
+        edges[num_edges].caller = current;
+        edges[num_edges].callee = callee;
+        edges[num_edges].pushes = call ? RETURN_ADDRESS : 0;
+        num_edges++;
+    }
+    fclose(file);
+    return 1;
+}
+
+
+static int compare_edges (const void* a, const void* b)
+{
+    return ((const Edge*) a)->caller - ((const Edge*) b)->caller;
+}
+
+
+/** Sort the edges by caller so each function's calls are together */
+static void index_edges (void)
+{
+    qsort(edges, num_edges, sizeof(Edge), compare_edges);
+    for (int i = num_edges - 1; i >= 0; i--) {
+        functions[edges[i].caller].first_edge = i;
+        functions[edges[i].caller].num_edges++;
+    }
+}
+
+
+/** Work out the worst-case stack from a function's entry, through everything it can call:
+    @param index the function
+    @return bytes of stack */
+static int stack_depth (int index)
+{
+    Function* function = &functions[index];
+    if (function->state == 2) {
+        return function->depth;
+    }
+    if (function->state == 1) {
+        if (!recursive) {
+            fprintf(stderr, "recursion through %s, the stack has no bound\n", function->name);
+        }
+        recursive = 1;
+        return 0;
+    }
+    function->state = 1;
+    int deepest = 0;
+    for (int i = function->first_edge; i < function->first_edge + function->num_edges; i++) {
+        int depth = edges[i].pushes + stack_depth(edges[i].callee);
+        if (depth > deepest) {
+            deepest = depth;
+            function->deepest = edges[i].callee;
+        }
+    }
+    function->depth = (function->frame > 0 ? function->frame : 0) + deepest;
+    function->state = 2;
+    return function->depth;
+}
+
+
+static int compare_size (const void* a, const void* b)
+{
+    unsigned long first = ((const Symbol*) a)->size;
+    unsigned long second = ((const Symbol*) b)->size;
+    return first < second ? 1 : first > second ? -1 : strcmp(((const Symbol*) a)->name, ((const Symbol*) b)->name);
+}
+
+
+/** Print the worst-case path from a function:
+    @param index where it starts */
+static void print_path (int index)
+{
+    printf("  ");
+    for (int i = index; i != NO_CALLEE; i = functions[i].deepest) {
+        printf("%s%s (%d)", i == index ? "" : " -> ", functions[i].name, functions[i].frame > 0 ? functions[i].frame : 0);
+    }
+    printf("\n");
+}
+
+
+static void usage (const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options] sections symbols disassembly stack_usage\n"
+        "  sections from avr-size -A, symbols from avr-nm --print-size --defined-only,\n"
+        "  disassembly from avr-objdump -d and stack_usage the .su files from gcc -fstack-usage\n"
+        "  -r bytes    RAM that must be left after static data and the worst-case stack (default %d)\n"
+        "  -f bytes    flash that must be left (default %d)\n"
+        "  -R bytes    RAM size (default %d)\n"
+        "  -F bytes    flash size available to the program (default %d)\n"
+        "  -n count    symbols to list in each table (default %d)\n",
+        program, DEFAULT_RAM_HEADROOM, DEFAULT_FLASH_HEADROOM, DEFAULT_RAM_SIZE, DEFAULT_FLASH_SIZE, DEFAULT_TOP);
+}
+
+
+int main (int argc, char* argv[])
+{
+    long ram_headroom = DEFAULT_RAM_HEADROOM;
+    long flash_headroom = DEFAULT_FLASH_HEADROOM;
+    long ram_size = DEFAULT_RAM_SIZE;
+    long flash_size = DEFAULT_FLASH_SIZE;
+    int top = DEFAULT_TOP;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:f:R:F:n:h")) != -1) {
+        switch (opt) {
+            case 'r' : ram_headroom = atol(optarg); break;
+            case 'f' : flash_headroom = atol(optarg); break;
+            case 'R' : ram_size = atol(optarg); break;
+            case 'F' : flash_size = atol(optarg); break;
+            case 'n' : top = atoi(optarg); break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    if (argc - optind != 4) {
+        usage(argv[0]);
+        return 1;
+    }
+    unsigned long text;
+    unsigned long data;
+    unsigned long bss;
+    if (!read_sections(argv[optind], &text, &data, &bss) || !read_symbols(argv[optind + 1])
+        || !read_calls(argv[optind + 2]) || !read_stack_usage(argv[optind + 3])) {
+        return 1;
+    }
+    index_edges();
+
+    // main is entered by a call from the start-up code, interrupts can land at its deepest point
+    int main_index = function_index("main");
+    int main_depth = RETURN_ADDRESS + stack_depth(main_index);
+    int isr_index = -1;
+    int isr_depth = 0;
+    for (int i = 0; i < num_functions; i++) {
+        if (strncmp(functions[i].name, "__vector_", strlen("__vector_")) == 0
+            && strcmp(functions[i].name, "__vector_default") != 0) {
+            int depth = RETURN_ADDRESS + stack_depth(i);
+            if (depth > isr_depth) {
+                isr_depth = depth;
+                isr_index = i;
+            }
+        }
+    }
+    long stack = main_depth + isr_depth;
+    long ram_left = ram_size - (long) (data + bss) - stack;
+    long flash_used = text + data; //.data initial values are copied out of flash at start-up
+    long flash_left = flash_size - flash_used;
+
+    printf("RAM   %5ld bytes: %4lu static (.data %lu, .bss %lu), %ld worst-case stack, %ld left (need %ld)\n",
+           ram_size, data + bss, data, bss, stack, ram_left, ram_headroom);
+    printf("flash %5ld bytes: %5ld used (.text %lu, .data %lu), %ld left (need %ld)\n",
+           flash_size, flash_used, text, data, flash_left, flash_headroom);
+
+    unsigned long named = 0;
+    qsort(ram_symbols, num_ram_symbols, sizeof(Symbol), compare_size);
+    printf("\n%-32s %6s\n", "RAM symbols", "bytes");
+    for (int i = 0; i < num_ram_symbols; i++) {
+        if (i < top) {
+            printf("%-32s %6lu\n", ram_symbols[i].name, ram_symbols[i].size);
+        }
+        named += ram_symbols[i].size;
+    }
+    if (num_ram_symbols > top) {
+        printf("%-32s %6s\n", "...", "");
+    }
+    if (data + bss > named) {
+        printf("%-32s %6lu\n", "(unnamed, eg string literals)", data + bss - named);
+    }
+
+    qsort(flash_symbols, num_flash_symbols, sizeof(Symbol), compare_size);
+    printf("\n%-32s %6s\n", "flash symbols", "bytes");
+    for (int i = 0; i < num_flash_symbols && i < top; i++) {
+        printf("%-32s %6lu\n", flash_symbols[i].name, flash_symbols[i].size);
+    }
+
+    printf("\nworst-case stack from main, %d bytes with return addresses, frame sizes in brackets:\n", main_depth);
+    print_path(main_index);
+    if (isr_index >= 0) {
+        printf("deepest interrupt handler, %d bytes:\n", isr_depth);
+        print_path(isr_index);
+    }
+    int reported = 0;
+    for (int i = 0; i < num_functions; i++) {
+        if (functions[i].state == 2 && functions[i].indirect) {
+            printf("%s %s", reported++ ? "," : "calls through pointers not followed in", functions[i].name);
+        }
+    }
+    if (reported) {
+        printf("\n");
+    }
+    reported = 0;
+    for (int i = 0; i < num_functions; i++) {
+        if (functions[i].state == 2 && functions[i].frame < 0) {
+            printf("%s %s", reported++ ? "," : "no -fstack-usage data, counted as 0:", functions[i].name);
+        }
+    }
+    if (reported) {
+        printf("\n");
+    }
+
+    int failed = 0;
+    if (recursive) {
+        printf("FAIL: recursion, the worst-case stack is unbounded\n");
+        failed = 1;
+    }
+    if (ram_left < ram_headroom) {
+        printf("FAIL: %ld bytes of RAM left, RAM_HEADROOM is %ld\n", ram_left, ram_headroom);
+        failed = 1;
+    }
+    if (flash_left < flash_headroom) {
+        printf("FAIL: %ld bytes of flash left, FLASH_HEADROOM is %ld\n", flash_left, flash_headroom);
+        failed = 1;
+    }
+    return failed;
+}
@@ -0,0 +1,193 @@
+/** @file multiball_bench.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief equivalence check and timing of the struct-of-arrays multi-ball engine against one Ball per ball
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "ball.h"
+#include "balls.h"
+#include "sim_util.h"
+
+#define TIMED_TICKS 20000000ULL
+#define DEFAULT_SEED 260
+#define BAUD 2400
+#define BITS_PER_BYTE 10 //start, 8 data and stop bits on the IR UART
+
+
+/** Compare balls_step with update_location for a single ball in slot 0:
+    @param start ball before the step
+    @param paddle paddle position
+    @return 1 if they agree, else 0 */
+static int check_one (const Ball* start, uint8_t paddle)
+{
+    Ball reference = *start;
+    Balls balls;
+    balls_init(&balls, 1);
+    balls.x[0] = start->x;
+    balls.y[0] = start->y;
+    balls.direction_x[0] = start->direction_x;
+    balls.direction_y[0] = start->direction_y;
+    balls.speed[0] = start->speed;
+    balls.period[0] = start->period;
+    balls.on_screen = 1;
+
+    update_location(&reference, paddle);
+    uint8_t leaving = balls_step(&balls, paddle, 1);
+    if (reference.dead == balls.dead && (reference.dead
+        || (reference.speed == balls.speed[0] && reference.period == balls.period[0] && reference.x == balls.x[0] && reference.y == balls.y[0] && reference.direction_x == balls.direction_x[0]
+            && reference.direction_y == balls.direction_y[0] && reference.on_screen == balls.on_screen
+            && leaving == !reference.on_screen))) {
+        return 1;
+    }
+    printf("mismatch from x=%u y=%u dx=%+d dy=%+d paddle=%u\n", start->x, start->y, start->direction_x,
+           start->direction_y, paddle);
+    return 0;
+}
+
+
+/** Fill the paddle positions both versions are timed against:
+    @param paddles array of 2^16 positions
+    @param seed random seed */
+static void fill_paddles (uint8_t paddles[], uint64_t seed)
+{
+    SimRng rng;
+    sim_rng_seed(&rng, seed, 0);
+    for (uint32_t i = 0; i < 1 << 16; i++) {
+        paddles[i] = sim_rng_below(&rng, RIGHT_WALL + 1);
+    }
+}
+
+
+/** Time stepping and drawing count balls as an array of Ball structs:
+    @param count number of balls
+    @param paddles paddle position for each tick
+    @param checksum where to place a value depending on every tick
+    @return nanoseconds per tick */
+static double time_structs (uint8_t count, const uint8_t paddles[], uint64_t* checksum)
+{
+    Ball balls[BALLS_MAX];
+    uint8_t bitmap[HEIGHT] = {0};
+    struct timespec begin, finish;
+    uint64_t sum = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        ball_init(&balls[i], i % (RIGHT_WALL + 1), GROUND + 1 + i / 3, i % 3 - 1, UP, ON_SCREEN);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (uint64_t tick = 0; tick < TIMED_TICKS; tick++) {
+        uint8_t paddle = paddles[tick & 0xffff];
+        uint8_t paddle_bits = bitmap[PADDLE_COL];
+        memset(bitmap, BLANK, sizeof(bitmap));
+        for (uint8_t i = 0; i < count; i++) {
+            Ball* ball = &balls[i];
+            update_location(ball, paddle);
+            if (!ball->on_screen || ball->dead) {
+                // same hand back as receive_ball, so the rally never ends
+                ball_init(ball, RIGHT_WALL - ball->x, HEIGHT - 1, -ball->direction_x, DOWN, ON_SCREEN);
+            }
+            bitmap[HEIGHT - 1 - ball->y] |= 1 << (RIGHT_WALL - ball->x);
+        }
+        bitmap[PADDLE_COL] |= paddle_bits;
+        sum += bitmap[tick % HEIGHT];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+    *checksum = sum;
+    return ((finish.tv_sec - begin.tv_sec) * 1e9 + (finish.tv_nsec - begin.tv_nsec)) / TIMED_TICKS;
+}
+
+
+/** Time stepping and drawing count balls with balls_step and balls_get_bitmap:
+    @param count number of balls
+    @param paddles paddle position for each tick
+    @param checksum where to place a value depending on every tick
+    @return nanoseconds per tick */
+static double time_arrays (uint8_t count, const uint8_t paddles[], uint64_t* checksum)
+{
+    Balls balls;
+    uint8_t bitmap[HEIGHT] = {0};
+    struct timespec begin, finish;
+    uint64_t sum = 0;
+
+    balls_init(&balls, count);
+    for (uint8_t i = 0; i < count; i++) {
+        balls.x[i] = i % (RIGHT_WALL + 1);
+        balls.y[i] = GROUND + 1 + i / 3;
+        balls.direction_x[i] = i % 3 - 1;
+        balls.direction_y[i] = UP;
+    }
+    balls.on_screen = (1 << count) - 1;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    for (uint64_t tick = 0; tick < TIMED_TICKS; tick++) {
+        uint8_t gone = balls_step(&balls, paddles[tick & 0xffff], balls.on_screen) | balls.dead;
+        for (uint8_t i = 0; gone; i++, gone >>= 1) {
+            if (gone & 1) {
+                balls.x[i] = RIGHT_WALL - balls.x[i];
+                balls.y[i] = HEIGHT - 1;
+                balls.direction_x[i] = -balls.direction_x[i];
+                balls.direction_y[i] = DOWN;
+            }
+        }
+        balls.on_screen = (1 << count) - 1;
+        balls.dead = 0;
+        balls_get_bitmap(bitmap, &balls);
+        sum += bitmap[tick % HEIGHT];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+    *checksum = sum;
+    return ((finish.tv_sec - begin.tv_sec) * 1e9 + (finish.tv_nsec - begin.tv_nsec)) / TIMED_TICKS;
+}
+
+
+int main (void)
+{
+    uint32_t inputs = 0;
+    uint32_t mismatches = 0;
+
+    // every ball on screen and alive, every possible paddle value
+    for (uint16_t paddle = 0; paddle <= UINT8_MAX; paddle++) {
+        for (uint8_t y = GROUND; y < HEIGHT; y++) {
+            for (uint8_t x = LEFT_WALL; x <= RIGHT_WALL; x++) {
+                for (int8_t dx = LEFT; dx <= RIGHT; dx++) {
+                    for (int8_t dy = DOWN; dy <= UP; dy += UP - DOWN) {
+                        Ball ball;
+                        ball_init(&ball, x, y, dx, dy, ON_SCREEN);
+                        inputs++;
+                        mismatches += !check_one(&ball, paddle);
+                    }
+                }
+            }
+        }
+    }
+    printf("%u inputs checked against update_location, %u mismatches\n", inputs, mismatches);
+    if (mismatches) {
+        return 1;
+    }
+
+    static uint8_t paddles[1 << 16];
+    int differ = 0;
+    fill_paddles(paddles, DEFAULT_SEED);
+    printf("\nhost timing per tick (step and draw) over %llu ticks\n", TIMED_TICKS);
+    printf("balls  Ball structs  Balls arrays\n");
+    for (uint8_t count = 1; count <= BALLS_MAX; count *= 2) {
+        uint64_t struct_sum, array_sum;
+        double struct_ns = time_structs(count, paddles, &struct_sum);
+        double array_ns = time_arrays(count, paddles, &array_sum);
+        differ |= struct_sum != array_sum;
+        printf("%5u  %9.2f ns  %9.2f ns%s\n", count, struct_ns, array_ns,
+               struct_sum == array_sum ? "" : "  (RALLIES DIFFER)");
+    }
+
+    printf("\nIR bytes to hand over k balls leaving in the same step at %d baud\n", BAUD);
+    printf("    k  one frame  per-ball messages\n");
+    for (uint8_t k = 1; k <= BALLS_MAX; k++) {
+        unsigned batch = 2 + 3 * k; //BALL_BATCH, count, then a coordinate, direction and speed per ball
+        unsigned single = 3 * k;
+        printf("%5u  %2u B %5.1f ms  %2u B %5.1f ms\n", k, batch, 1e3 * batch * BITS_PER_BYTE / BAUD,
+               single, 1e3 * single * BITS_PER_BYTE / BAUD);
+    }
+    return differ;
+}
@@ -0,0 +1,467 @@
+/** @file replay.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief replay a record mode dump through the game logic and check it reproduces
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sim_bot.h"
+#include "sim_kit.h"
+#include "pong_display.h"
+
+#define DEFAULT_SEED 260
+#define DEFAULT_MISS 0.01
+#define VARINT_MORE 0x80
+#define VARINT_MASK 0x7F
+#define RECORD_HEADER_LENGTH 3
+
+
+static const char* type_names[] = {"rx", "tx", "nav", "mode", "snapshot"};
+
+
+/** One decoded record with an absolute tick */
+typedef struct {
+    uint32_t tick;
+    uint8_t type;
+    uint8_t data[RECORD_SNAPSHOT_LENGTH];
+} Event;
+
+
+typedef struct {
+    Event* events;
+    size_t count;
+    size_t cap;
+    uint8_t full; //1 if the kit turned records away to keep its newest snapshot
+    uint32_t full_tick; //tick it started to, later events may be missing
+} Log;
+
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t cap;
+} Bytes;
+
+
+/** Where record_dump output is collected, record_dump takes no context pointer */
+static Bytes* capture;
+
+
+static void append_byte (Bytes* bytes, uint8_t byte)
+{
+    if (bytes->size == bytes->cap) {
+        bytes->cap = bytes->cap ? 2 * bytes->cap : 4096;
+        bytes->data = realloc(bytes->data, bytes->cap);
+    }
+    bytes->data[bytes->size++] = byte;
+}
+
+
+static void capture_byte (char byte)
+{
+    append_byte(capture, byte);
+}
+
+
+/** Dump a kit's log into memory exactly as the firmware would send it:
+    @param kit the kit whose log to dump
+    @param out where to place the dump */
+static void dump_kit (SimKit* kit, Bytes* out)
+{
+    capture = out;
+    recorder = kit->recorder;
+    record_dump(capture_byte);
+}
+
+
+/** Write each kit's trace ring to its own file, as the firmware would send it:
+    @param kits the two kits
+    @param prefix path prefix, kit n's trace goes to prefix followed by n.trace
+    @return 1 on success, else 0 */
+static int write_traces (SimKit kits[], const char* prefix)
+{
+    for (uint8_t i = 0; i < 2; i++) {
+        Bytes bytes = {NULL, 0, 0};
+        char path[FILENAME_MAX];
+        capture = &bytes;
+        tracer = kits[i].tracer;
+        trace_dump(capture_byte);
+        snprintf(path, sizeof(path), "%s%u.trace", prefix, i);
+        FILE* file = fopen(path, "wb");
+        if (!file || fwrite(bytes.data, 1, bytes.size, file) != bytes.size) {
+            perror(path);
+            return 0;
+        }
+        fclose(file);
+        free(bytes.data);
+    }
+    return 1;
+}
+
+
+/** Read a varint from a dump:
+    @param bytes the dump
+    @param size length of the dump
+    @param offset position to read from, advanced past the varint
+    @param value where to place the value
+    @return 1 on success, 0 if the dump ends early */
+static int read_varint (const uint8_t* bytes, size_t size, size_t* offset, uint32_t* value)
+{
+    uint8_t shift = 0;
+    uint8_t byte;
+    *value = 0;
+    do {
+        if (*offset >= size || shift > 28) {
+            return 0;
+        }
+        byte = bytes[(*offset)++];
+        *value |= (uint32_t) (byte & VARINT_MASK) << shift;
+        shift += 7;
+    } while (byte & VARINT_MORE);
+    return 1;
+}
+
+
+/** Decode a dump into events with absolute ticks:
+    @param bytes the dump
+    @param size length of the dump
+    @param log where to place the events
+    @return 1 on success, else 0 */
+static int decode_dump (const uint8_t* bytes, size_t size, Log* log)
+{
+    size_t offset = RECORD_HEADER_LENGTH;
+    uint32_t tick;
+    uint32_t length;
+    memset(log, 0, sizeof(Log));
+    if (size < RECORD_HEADER_LENGTH || bytes[0] != RECORD_MAGIC_0 || bytes[1] != RECORD_MAGIC_1
+        || bytes[2] != RECORD_VERSION) {
+        return 0;
+    }
+    if (!read_varint(bytes, size, &offset, &tick) || offset >= size) {
+        return 0;
+    }
+    log->full = bytes[offset++];
+    if (!read_varint(bytes, size, &offset, &log->full_tick) || !read_varint(bytes, size, &offset, &length)
+        || offset + length > size) {
+        return 0;
+    }
+
+    size_t end = offset + length;
+    while (offset < end) {
+        uint8_t header = bytes[offset++];
+        uint32_t delta = header >> RECORD_TYPE_BITS;
+        uint32_t extra;
+        Event event;
+        if (delta == RECORD_SHORT_DELTA) {
+            if (!read_varint(bytes, end, &offset, &extra)) {
+                return 0;
+            }
+            delta += extra;
+        }
+        tick += delta;
+        event.tick = tick;
+        event.type = header & RECORD_TYPE_MASK;
+        uint8_t payload = event.type == RECORD_SNAPSHOT ? RECORD_SNAPSHOT_LENGTH : 1;
+        if (event.type > RECORD_SNAPSHOT || offset + payload > end) {
+            return 0;
+        }
+        memset(event.data, 0, sizeof(event.data));
+        memcpy(event.data, bytes + offset, payload);
+        offset += payload;
+
+        if (log->count == log->cap) {
+            log->cap = log->cap ? 2 * log->cap : 1024;
+            log->events = realloc(log->events, log->cap * sizeof(Event));
+        }
+        log->events[log->count++] = event;
+    }
+    return 1;
+}
+
+
+static void print_event (const Event* event)
+{
+    printf("%8u %-8s", event->tick, type_names[event->type]);
+    if (event->type == RECORD_SNAPSHOT) {
+        const uint8_t* data = event->data;
+        printf(" mode %u, score %c-%c, paddle %u, ball timer %u, round %u, flags 0x%02x, ball speed %u,"
+               " ai paddle %u target %u reaction %u move %u serve %u level %u random 0x%04x\n",
+               data[RECORD_SNAP_MODE], data[RECORD_SNAP_SCORE], data[RECORD_SNAP_OPPONENT_SCORE],
+               data[RECORD_SNAP_PADDLE], data[RECORD_SNAP_BALL_TIMER], data[RECORD_SNAP_ROUND],
+               data[RECORD_SNAP_FLAGS], data[RECORD_SNAP_BALL_SPEED], data[RECORD_SNAP_AI_PADDLE],
+               data[RECORD_SNAP_AI_TARGET], data[RECORD_SNAP_AI_REACTION], data[RECORD_SNAP_AI_MOVE_COUNTER],
+               data[RECORD_SNAP_AI_SERVE_COUNTER], data[RECORD_SNAP_AI_LEVEL],
+               data[RECORD_SNAP_AI_RANDOM] | data[RECORD_SNAP_AI_RANDOM + 1] << 8);
+    } else {
+        printf(" 0x%02x\n", event->data[0]);
+    }
+}
+
+
+/** Kit firmware for a replay: start from a snapshot rather than power-on. The snapshot
+    is logged again once restored, so a state it leaves out shows up as a mismatch:
+    @param kit the replaying kit, its user pointer is the snapshot event */
+static void replay_loop (SimKit* kit)
+{
+    const uint8_t* data = ((const Event*) kit->user)->data;
+    Game* game = &kit->game;
+    init_led_matrix();
+    game_init(game, &kit->paddle, kit->bitmap);
+    game->game_mode = data[RECORD_SNAP_MODE];
+    game->score = data[RECORD_SNAP_SCORE];
+    game->opponent_score = data[RECORD_SNAP_OPPONENT_SCORE];
+    kit->paddle.pos = data[RECORD_SNAP_PADDLE];
+    game->round = data[RECORD_SNAP_ROUND];
+    game->single_player = (data[RECORD_SNAP_FLAGS] & RECORD_FLAG_SINGLE_PLAYER) != 0;
+    game->multi_ball = (data[RECORD_SNAP_FLAGS] & RECORD_FLAG_MULTI_BALL) != 0;
+    game->ring_mode = (data[RECORD_SNAP_FLAGS] & RECORD_FLAG_RING) != 0;
+    game->lockstep_mode = (data[RECORD_SNAP_FLAGS] & RECORD_FLAG_LOCKSTEP) != 0;
+    ball_set_speed(&kit->ball, data[RECORD_SNAP_BALL_SPEED]);
+    kit->ball.timer = (uint16_t) data[RECORD_SNAP_BALL_TIMER] << BALL_FRACTION_BITS;
+    game->ai.paddle.pos = data[RECORD_SNAP_AI_PADDLE];
+    game->ai.target = data[RECORD_SNAP_AI_TARGET];
+    game->ai.reaction = data[RECORD_SNAP_AI_REACTION];
+    game->ai.move_counter = data[RECORD_SNAP_AI_MOVE_COUNTER];
+    game->ai.serve_counter = data[RECORD_SNAP_AI_SERVE_COUNTER];
+    game->ai.level = data[RECORD_SNAP_AI_LEVEL];
+    game->ai.random = data[RECORD_SNAP_AI_RANDOM] | data[RECORD_SNAP_AI_RANDOM + 1] << 8;
+    record_init(((const Event*) kit->user)->tick);
+    RECORD_SNAPSHOT_OF(game, &kit->paddle, kit->ball.speed, kit->ball.timer >> BALL_FRACTION_BITS);
+    while (1) {
+        pacer_wait();
+        game_update(&kit->game, &kit->ball, &kit->paddle, kit->bitmap);
+    }
+}
+
+
+/** Feed a log's inputs back through the game logic and compare its outputs:
+    @param log the recorded session
+    @param verbose 1 to print every event
+    @return 0 if the replay reproduced the log, else 1 */
+static int replay (const Log* log, int verbose)
+{
+    size_t start = 0;
+    while (start < log->count && log->events[start].type != RECORD_SNAPSHOT) {
+        start++;
+    }
+    if (start == log->count) {
+        fprintf(stderr, "log holds no snapshot to start from\n");
+        return 1;
+    }
+
+    SimKit kit;
+    SimWorld world = {&kit, 1, NULL, 0, 0};
+    struct timespec begin, finish;
+    // a kit that turned records away kept every tick before that one whole
+    uint32_t last_tick = log->full ? log->full_tick - 1 : log->events[log->count - 1].tick;
+    size_t end = log->count; //one past the last event compared
+    while (end > start + 1 && log->events[end - 1].tick > last_tick) {
+        end--;
+    }
+    size_t next = start + 1;
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    sim_kit_init(&kit, 0, replay_loop);
+    kit.user = &log->events[start];
+    sim_world_step(&world); //run up to the first pacer wait
+
+    while (kit.blocked || kit.recorder->tick < last_tick) {
+        // a kit blocked in ir_uart_getc is still inside the tick it started
+        uint32_t upcoming = kit.blocked ? kit.recorder->tick : kit.recorder->tick + 1;
+        kit.nav_pending = 0;
+        while (next < end && log->events[next].tick <= upcoming) {
+            const Event* event = &log->events[next];
+            if (event->type == RECORD_RX) {
+                if (kit.fifo_count == SIM_RX_FIFO) {
+                    break;
+                }
+                kit.fifo[kit.fifo_count++] = event->data[0];
+            } else if (event->type == RECORD_NAV) {
+                kit.nav_pending |= event->data[0];
+            }
+            next++;
+        }
+        if (kit.blocked && !kit.fifo_count && next == end) {
+            break; //the recording ended with the kit waiting on a byte that never came
+        }
+        sim_world_step(&world);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+
+    Bytes dump = {NULL, 0, 0};
+    Log replayed;
+    dump_kit(&kit, &dump);
+    decode_dump(dump.data, dump.size, &replayed);
+    sim_kit_free(&kit);
+    while (replayed.count && replayed.events[replayed.count - 1].tick > last_tick) {
+        replayed.count--;
+    }
+
+    // the replay logs the snapshot it restored too, so that is compared first
+    size_t expected = end - start;
+    size_t matched = 0;
+    while (matched < expected && matched < replayed.count) {
+        const Event* a = &log->events[start + matched];
+        const Event* b = &replayed.events[matched];
+        if (a->tick != b->tick || a->type != b->type || memcmp(a->data, b->data, sizeof(a->data))) {
+            break;
+        }
+        matched++;
+    }
+
+    if (verbose) {
+        for (size_t i = start; i < log->count; i++) {
+            print_event(&log->events[i]);
+        }
+    }
+    double seconds = (finish.tv_sec - begin.tv_sec) + (finish.tv_nsec - begin.tv_nsec) * 1e-9;
+    uint32_t ticks = last_tick - log->events[start].tick;
+    printf("replayed %u ticks (%.1f s of play) from tick %u in %.3f s, %.0fx real time\n",
+           ticks, (double) ticks / PACER_RATE, log->events[start].tick, seconds,
+           seconds > 0 ? ticks / (seconds * PACER_RATE) : 0);
+    if (log->full) {
+        printf("the log filled at tick %u and kept its snapshot, later events were not recorded\n", log->full_tick);
+    }
+
+    int ok = matched == expected && replayed.count == expected;
+    if (ok) {
+        printf("all %zu events reproduced\n", expected);
+    } else {
+        printf("diverged after %zu of %zu events\n", matched, expected);
+        if (matched < expected) {
+            printf("recorded: ");
+            print_event(&log->events[start + matched]);
+        }
+        if (matched < replayed.count) {
+            printf("replayed: ");
+            print_event(&replayed.events[matched]);
+        }
+    }
+    free(replayed.events);
+    free(dump.data);
+    return !ok;
+}
+
+
+/** Record a session between two bots, as kit 0 would log it:
+    @param seconds length of the session
+    @param channel IR conditions between the kits
+    @param miss_rate probability a bot misses each approach
+    @param seed random seed
+    @param out where to place kit 0's dump
+    @param trace_prefix where to write both kits' traces, NULL for none
+    @return 1 on success, else 0 */
+static int generate (double seconds, const SimChannel* channel, double miss_rate, uint64_t seed, Bytes* out,
+                     const char* trace_prefix)
+{
+    SimWorld world;
+    SimKit kits[2];
+    SimLink links[2];
+    SimBot bots[2];
+    uint64_t ticks = seconds * PACER_RATE;
+
+    sim_world_init_pair(&world, kits, links, channel, seed);
+    for (uint8_t i = 0; i < 2; i++) {
+        sim_bot_init(&bots[i], miss_rate, seed, i);
+    }
+    while (world.tick < ticks) {
+        sim_bot_input(&bots[0], &kits[0], 1, 1);
+        sim_bot_input(&bots[1], &kits[1], 0, 0);
+        sim_world_step(&world);
+    }
+    dump_kit(&kits[0], out);
+    int ok = !trace_prefix || write_traces(kits, trace_prefix);
+    for (uint8_t i = 0; i < 2; i++) {
+        sim_kit_free(&kits[i]);
+    }
+    return ok;
+}
+
+
+static void usage (const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options] [dump]\n"
+        "  replays a record mode dump (make RECORD=1) and checks the game logic reproduces it\n"
+        "  -g seconds  record a session between two simulated bots instead of reading a dump\n"
+        "  -o file     write the recorded session's dump to file\n"
+        "  -t prefix   also write each kit's trace to prefix0.trace and prefix1.trace, for trace_json\n"
+        "  -l loss     IR byte loss probability while recording (default 0)\n"
+        "  -m rate     probability a bot misses the ball (default %g)\n"
+        "  -s seed     random seed for recording (default %d)\n"
+        "  -v          list every event from the replay's starting snapshot on\n",
+        program, DEFAULT_MISS, DEFAULT_SEED);
+}
+
+
+int main (int argc, char* argv[])
+{
+    SimChannel channel = {2400, 0, 0, 0, 0};
+    double seconds = 0;
+    double miss_rate = DEFAULT_MISS;
+    uint64_t seed = DEFAULT_SEED;
+    const char* out_path = NULL;
+    const char* trace_prefix = NULL;
+    int verbose = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "g:o:t:l:m:s:vh")) != -1) {
+        switch (opt) {
+            case 'g' : seconds = atof(optarg); break;
+            case 'o' : out_path = optarg; break;
+            case 't' : trace_prefix = optarg; break;
+            case 'l' : channel.loss = atof(optarg); break;
+            case 'm' : miss_rate = atof(optarg); break;
+            case 's' : seed = strtoull(optarg, NULL, 0); break;
+            case 'v' : verbose = 1; break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+
+    Bytes dump = {NULL, 0, 0};
+    if (seconds > 0) {
+        if (!generate(seconds, &channel, miss_rate, seed, &dump, trace_prefix)) {
+            return 1;
+        }
+        if (out_path) {
+            FILE* file = fopen(out_path, "wb");
+            if (!file || fwrite(dump.data, 1, dump.size, file) != dump.size) {
+                perror(out_path);
+                return 1;
+            }
+            fclose(file);
+        }
+        printf("recorded %.0f s session, %zu byte dump\n", seconds, dump.size);
+    } else if (optind < argc) {
+        FILE* file = fopen(argv[optind], "rb");
+        int byte;
+        if (!file) {
+            perror(argv[optind]);
+            return 1;
+        }
+        while ((byte = fgetc(file)) != EOF) {
+            append_byte(&dump, byte);
+        }
+        fclose(file);
+    } else {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Log log;
+    if (!decode_dump(dump.data, dump.size, &log) || !log.count) {
+        fprintf(stderr, "not a valid record mode dump\n");
+        return 1;
+    }
+    int result = replay(&log, verbose);
+    free(log.events);
+    free(dump.data);
+    return result;
+}
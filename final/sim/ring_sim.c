@@ -0,0 +1,329 @@
+/** @file ring_sim.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief ring mode simulator: N virtual kits in a ring, handoff latency and throughput as N grows
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_bot.h"
+#include "sim_kit.h"
+#include "sim_util.h"
+#include "navswitch.h"
+#include "pong_display.h"
+
+#define DEFAULT_GAMES 200
+#define DEFAULT_SEED 260
+#define DEFAULT_MISS 0.1
+#define DEFAULT_BAUD 2400
+#define MIN_KITS 2
+#define GAME_TIMEOUT (1200 * PACER_RATE) //ticks before a game counts as stalled
+#define LATENCY_BINS 256 //ticks, longer handoffs go in the last bin
+#define MS_PER_TICK (1000.0 / PACER_RATE)
+#define MISS_OFFSET 3 //columns a player aims away from the ball when missing
+
+
+/** Scripted player. Unlike SimBot, which always meets the ball with the centre
+    of the paddle, it picks a paddle column for each approach so balls leave at
+    every angle and reach every kit on the ring */
+typedef struct {
+    SimRng rng;
+    uint32_t mode_ticks;
+    uint8_t mode;
+    uint8_t on_screen;
+    int8_t aim; //paddle column offset from the landing column for this approach
+} Player;
+
+
+/** Read-only run settings */
+typedef struct {
+    uint64_t games;
+    uint64_t seed;
+    double miss_rate;
+    uint8_t max_kits;
+    SimChannel channel;
+} Run;
+
+
+/** Results for one ring size */
+typedef struct {
+    uint64_t games;
+    uint64_t stalls;
+    uint64_t disagreements; //finished games where the kits' score tables differ
+    uint64_t formed; //games where every kit learned the ring size
+    uint64_t form_ticks;
+    uint64_t ticks;
+    uint64_t handoffs;
+    uint64_t hops;
+    uint64_t latency_ticks;
+    uint64_t latency_max;
+    uint64_t bytes;
+    uint64_t forwarded;
+    uint64_t duplicates;
+    uint64_t gaps;
+    uint64_t latency[LATENCY_BINS];
+} SizeStats;
+
+
+/** Per-thread results, merged at the end */
+typedef struct {
+    SizeStats sizes[RING_MAX_NODES + 1];
+} Stats;
+
+
+/** Script the navswitch events a kit sees on its next tick:
+    @param player pointer to player
+    @param kit the kit the player is holding
+    @param miss_rate probability of missing each approach */
+static void player_input (Player* player, SimKit* kit, double miss_rate)
+{
+    uint8_t mode = kit->game.game_mode;
+    if (mode != player->mode) {
+        player->mode = mode;
+        player->mode_ticks = 0;
+    }
+    player->mode_ticks++;
+
+    if (mode == PADDLE_MODE && ring_may_serve(&kit->game.ring) && player->mode_ticks == SIM_BOT_SERVE_DELAY) {
+        kit->nav_pending |= 1 << NAVSWITCH_PUSH;
+    } else if (mode == PLAY_MODE) {
+        Ball* ball = &kit->ball;
+        if (ball->on_screen && !player->on_screen) {
+            player->aim = sim_rng_below(&player->rng, PADDLE_WIDTH) - 1;
+            if (sim_rng_uniform(&player->rng) < miss_rate) {
+                player->aim = sim_rng_below(&player->rng, 2) ? MISS_OFFSET : -MISS_OFFSET;
+            }
+        }
+        player->on_screen = ball->on_screen;
+        if (ball->on_screen && player->mode_ticks % SIM_BOT_MOVE_INTERVAL == 0) {
+            int8_t target = sim_bot_predict_landing(ball) + player->aim;
+            int8_t pos = get_paddle_location(&kit->paddle);
+            if (pos < target) {
+                kit->nav_pending |= 1 << NAVSWITCH_NORTH;
+            } else if (pos > target) {
+                kit->nav_pending |= 1 << NAVSWITCH_SOUTH;
+            }
+        }
+    }
+}
+
+
+/** Play one ring game from power on until every kit shows game over:
+    @param run run settings
+    @param num_kits kits on the ring
+    @param index game number, used as the random stream
+    @param stats where to count the results */
+static void play_game (const Run* run, uint8_t num_kits, uint64_t index, SizeStats* stats)
+{
+    SimKit kits[RING_MAX_NODES];
+    SimLink links[RING_MAX_NODES];
+    Player players[RING_MAX_NODES];
+    SimWorld world;
+    uint8_t was_on_screen[RING_MAX_NODES] = {0};
+    uint64_t departure_tick = 0;
+    uint8_t departure_kit = 0;
+    uint8_t in_flight = 0;
+    uint64_t formed = 0;
+
+    sim_world_init_ring(&world, kits, links, num_kits, &run->channel, run->seed + index);
+    memset(players, 0, sizeof(players));
+    for (uint8_t i = 0; i < num_kits; i++) {
+        sim_rng_seed(&players[i].rng, run->seed, index * RING_MAX_NODES + i);
+    }
+
+    uint8_t over = 0;
+    while (!over && world.tick < GAME_TIMEOUT) {
+        for (uint8_t i = 0; i < num_kits; i++) {
+            SimKit* kit = &kits[i];
+            if (kit->game.game_mode == START_MENU) {
+                if (i == 0 && world.tick == SIM_BOT_START_DELAY) {
+                    kit->nav_pending |= 1 << NAVSWITCH_NORTH;
+                }
+            } else {
+                player_input(&players[i], kit, run->miss_rate);
+            }
+        }
+        sim_world_step(&world);
+
+        over = 1;
+        uint8_t all_formed = 1;
+        for (uint8_t i = 0; i < num_kits; i++) {
+            Game* game = &kits[i].game;
+            Ball* ball = &kits[i].ball;
+            uint8_t on_screen = game->game_mode == PLAY_MODE && ball->on_screen && !ball->dead;
+            if (was_on_screen[i] && !on_screen && game->game_mode == PLAY_MODE) {
+                // gone off the top, routed to another kit
+                departure_tick = world.tick;
+                departure_kit = i;
+                in_flight = 1;
+            } else if (!was_on_screen[i] && on_screen && in_flight && ball->direction_y == DOWN) {
+                uint64_t latency = world.tick - departure_tick;
+                stats->handoffs++;
+                stats->hops += (i + num_kits - departure_kit) % num_kits;
+                stats->latency_ticks += latency;
+                stats->latency[latency < LATENCY_BINS ? latency : LATENCY_BINS - 1]++;
+                if (latency > stats->latency_max) {
+                    stats->latency_max = latency;
+                }
+                in_flight = 0;
+            }
+            if (game->game_mode == DISPLAY_SCORE_MODE) {
+                in_flight = 0; //the round is over
+            }
+            was_on_screen[i] = on_screen;
+            over &= game->game_mode == GAME_OVER_MODE;
+            all_formed &= game->ring.size == num_kits;
+        }
+        if (all_formed && !formed) {
+            formed = world.tick;
+        }
+    }
+
+    if (!over) {
+        stats->stalls++;
+    } else {
+        for (uint8_t i = 1; i < num_kits; i++) {
+            if (memcmp(kits[i].game.ring.scores, kits[0].game.ring.scores, RING_MAX_NODES)) {
+                stats->disagreements++;
+                break;
+            }
+        }
+    }
+    stats->games++;
+    if (formed) {
+        stats->formed++;
+        stats->form_ticks += formed - SIM_BOT_START_DELAY;
+    }
+    stats->ticks += world.tick;
+    for (uint8_t i = 0; i < num_kits; i++) {
+        stats->bytes += links[i].sent;
+        stats->forwarded += kits[i].game.ring.forwarded;
+        stats->duplicates += kits[i].game.ring.duplicates;
+        stats->gaps += kits[i].game.ring.gaps;
+        sim_kit_free(&kits[i]);
+    }
+}
+
+
+/** Play one game per chunk, working through the ring sizes in turn:
+    @param context the Run
+    @param accumulator this thread's Stats
+    @param chunk ring size and game number */
+static void run_chunk (void* context, void* accumulator, uint64_t chunk)
+{
+    const Run* run = context;
+    Stats* stats = accumulator;
+    uint8_t num_kits = MIN_KITS + chunk / run->games;
+    play_game(run, num_kits, chunk % run->games, &stats->sizes[num_kits]);
+}
+
+
+/** Add one thread's results into the total. Every field is a count, summed word by word, except the maxima:
+    @param total the total Stats
+    @param accumulator one thread's Stats */
+static void merge_stats (void* total, const void* accumulator)
+{
+    Stats* to = total;
+    const Stats* from = accumulator;
+    for (uint8_t n = 0; n <= RING_MAX_NODES; n++) {
+        // maxima do not add up
+        uint64_t latency_max = to->sizes[n].latency_max;
+        if (from->sizes[n].latency_max > latency_max) {
+            latency_max = from->sizes[n].latency_max;
+        }
+        const uint64_t* words = (const uint64_t*) &from->sizes[n];
+        uint64_t* sums = (uint64_t*) &to->sizes[n];
+        for (size_t j = 0; j < sizeof(SizeStats) / sizeof(uint64_t); j++) {
+            sums[j] += words[j];
+        }
+        to->sizes[n].latency_max = latency_max;
+    }
+}
+
+
+/** Return the latency below which the given fraction of handoffs fall, in ticks:
+    @param stats results for one ring size
+    @param fraction eg 0.5 for the median */
+static unsigned percentile (const SizeStats* stats, double fraction)
+{
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < LATENCY_BINS; i++) {
+        seen += stats->latency[i];
+        if (seen > fraction * stats->handoffs) {
+            return i;
+        }
+    }
+    return LATENCY_BINS - 1;
+}
+
+
+static void usage (const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -k kits     largest ring to simulate, from 2 up to %d (default %d)\n"
+        "  -n games    games per ring size (default %d)\n"
+        "  -b baud     IR UART rate (default %d)\n"
+        "  -l loss     probability each byte is lost (default 0)\n"
+        "  -m rate     probability a scripted player misses the ball (default %g)\n"
+        "  -s seed     random seed (default %d)\n"
+        "  -t threads  worker threads (default: number of cores)\n",
+        program, RING_MAX_NODES, RING_MAX_NODES, DEFAULT_GAMES, DEFAULT_BAUD, DEFAULT_MISS, DEFAULT_SEED);
+}
+
+
+int main (int argc, char* argv[])
+{
+    Run run = {DEFAULT_GAMES, DEFAULT_SEED, DEFAULT_MISS, RING_MAX_NODES, {DEFAULT_BAUD, 0, 0, 0, 0}};
+    unsigned num_threads = sim_default_threads();
+    uint64_t value;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "k:n:b:l:m:s:t:h")) != -1) {
+        int ok = 1;
+        switch (opt) {
+            case 'k' : run.max_kits = atoi(optarg); ok = run.max_kits >= MIN_KITS && run.max_kits <= RING_MAX_NODES; break;
+            case 'n' : ok = sim_parse_count(optarg, &run.games) && run.games; break;
+            case 'b' : run.channel.baud = atoi(optarg); ok = run.channel.baud > 0; break;
+            case 'l' : run.channel.loss = atof(optarg); break;
+            case 'm' : run.miss_rate = atof(optarg); break;
+            case 's' : run.seed = strtoull(optarg, NULL, 0); break;
+            case 't' : ok = sim_parse_count(optarg, &value) && value; num_threads = value; break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    Stats total;
+    uint64_t chunks = (run.max_kits - MIN_KITS + 1) * run.games;
+    memset(&total, 0, sizeof(total));
+    sim_parallel_for(chunks, num_threads, run_chunk, &run, sizeof(Stats), merge_stats, &total);
+
+    uint64_t problems = 0;
+    printf("%llu ring games per size, %u baud, byte loss %g, player miss rate %g\n",
+           (unsigned long long) run.games, run.channel.baud, run.channel.loss, run.miss_rate);
+    printf(" kits  form ms  hops  handoff ms: mean  p50  p99   max  handoffs/s  bytes/handoff  "
+           "fwd/handoff  link load  dups  gaps  stalls  disagree\n");
+    for (uint8_t n = MIN_KITS; n <= run.max_kits; n++) {
+        const SizeStats* s = &total.sizes[n];
+        double handoffs = s->handoffs ? s->handoffs : 1;
+        printf("%5u  %7.1f  %4.2f  %16.1f %4.0f %4.0f %5.0f  %10.2f  %13.1f  %11.2f  %8.2f%%  %4llu  %4llu  %6llu  %8llu\n",
+               n, s->formed ? s->form_ticks * MS_PER_TICK / s->formed : 0, s->hops / handoffs,
+               s->latency_ticks * MS_PER_TICK / handoffs, percentile(s, 0.5) * MS_PER_TICK,
+               percentile(s, 0.99) * MS_PER_TICK, s->latency_max * MS_PER_TICK,
+               s->handoffs / (s->ticks / (double) PACER_RATE), s->bytes / handoffs, s->forwarded / handoffs,
+               100.0 * s->bytes / n / (s->ticks / (double) PACER_RATE) / (run.channel.baud / SIM_UART_FRAME_BITS),
+               (unsigned long long) s->duplicates, (unsigned long long) s->gaps,
+               (unsigned long long) s->stalls, (unsigned long long) s->disagreements);
+        problems += s->stalls + s->disagreements;
+    }
+    return run.channel.loss == 0 && problems != 0;
+}
@@ -0,0 +1,94 @@
+/** @file sim_bot.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief scripted player that drives a virtual kit's navswitch
+ */
+
+
+#include "sim_bot.h"
+#include "navswitch.h"
+
+#define PREDICT_STEPS 16
+#define MISS_OFFSET 3 //columns the bot moves away from the ball when missing
+
+
+/** Initialise a bot:
+    @param bot pointer to bot
+    @param miss_rate probability the bot misses the ball on each approach
+    @param seed random seed
+    @param stream stream index, eg the kit id */
+void sim_bot_init (SimBot* bot, double miss_rate, uint64_t seed, uint64_t stream)
+{
+    sim_bot_reset(bot);
+    bot->miss_rate = miss_rate;
+    bot->start_button = NAVSWITCH_PUSH;
+    sim_rng_seed(&bot->rng, seed, stream);
+}
+
+
+/** Forget what mode the kit was in, eg after the kit is reset:
+    @param bot pointer to bot */
+void sim_bot_reset (SimBot* bot)
+{
+    bot->mode = START_MENU;
+    bot->mode_ticks = 0;
+    bot->on_screen = 0;
+    bot->miss = 0;
+}
+
+
+/** Predict the column the ball will be in when it reaches the paddle row:
+    @param ball ball currently on screen
+    @return predicted x coordinate, or the ball's x if it never comes down */
+uint8_t sim_bot_predict_landing (const Ball* ball)
+{
+    Ball copy = *ball;
+    for (uint8_t i = 0; i < PREDICT_STEPS && copy.on_screen && !copy.dead; i++) {
+        if (copy.y == GROUND + 1 && copy.direction_y == DOWN) {
+            return copy.x;
+        }
+        update_location(&copy, UINT8_MAX); //paddle nowhere, only walls deflect
+    }
+    return ball->x;
+}
+
+
+/** Script the navswitch events a kit sees on its next tick:
+    @param bot pointer to bot
+    @param kit the kit the bot is playing
+    @param starter 1 if this bot pushes start on the menu
+    @param server 1 if this bot fires the ball when a round is waiting to start */
+void sim_bot_input (SimBot* bot, SimKit* kit, uint8_t starter, uint8_t server)
+{
+    uint8_t mode = kit->game.game_mode;
+
+    if (mode != bot->mode) {
+        bot->mode = mode;
+        bot->mode_ticks = 0;
+    }
+    bot->mode_ticks++;
+
+    if (mode == START_MENU && starter && bot->mode_ticks == SIM_BOT_START_DELAY) {
+        kit->nav_pending |= 1 << bot->start_button;
+    } else if (mode == PADDLE_MODE && server && bot->mode_ticks == SIM_BOT_SERVE_DELAY) {
+        kit->nav_pending |= 1 << NAVSWITCH_PUSH;
+    } else if (mode == PLAY_MODE) {
+        Ball* ball = &kit->ball;
+        if (ball->on_screen && !bot->on_screen) {
+            bot->miss = sim_rng_uniform(&bot->rng) < bot->miss_rate;
+        }
+        bot->on_screen = ball->on_screen;
+        if (ball->on_screen && bot->mode_ticks % SIM_BOT_MOVE_INTERVAL == 0) {
+            uint8_t target = sim_bot_predict_landing(ball);
+            if (bot->miss) {
+                target = target > RIGHT_WALL / 2 ? target - MISS_OFFSET : target + MISS_OFFSET;
+            }
+            uint8_t pos = get_paddle_location(&kit->paddle);
+            if (pos < target) {
+                kit->nav_pending |= 1 << NAVSWITCH_NORTH;
+            } else if (pos > target) {
+                kit->nav_pending |= 1 << NAVSWITCH_SOUTH;
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+/** @file sim_bot.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief scripted player that drives a virtual kit's navswitch
+ */
+
+
+#ifndef SIM_BOT_H
+#define SIM_BOT_H
+
+#include "sim_kit.h"
+
+#define SIM_BOT_START_DELAY (PACER_RATE / 20) //ticks the bot waits before pushing start, 50 ms
+#define SIM_BOT_SERVE_DELAY (PACER_RATE / 10) //ticks the bot waits before firing the ball, 100 ms
+#define SIM_BOT_MOVE_INTERVAL (PACER_RATE / 30) //ticks between paddle moves, 33 ms, roughly a quick human
+
+
+/** Scripted player for one kit */
+typedef struct {
+    uint8_t mode;
+    uint32_t mode_ticks;
+    uint8_t on_screen;
+    uint8_t miss; //1 if the bot has decided to miss the current approach
+    double miss_rate; //probability of missing each approach
+    uint8_t start_button; //navswitch button pushed on the start menu, which picks the game mode
+    SimRng rng;
+} SimBot;
+
+
+/** Initialise a bot:
+    @param bot pointer to bot
+    @param miss_rate probability the bot misses the ball on each approach
+    @param seed random seed
+    @param stream stream index, eg the kit id */
+void sim_bot_init (SimBot* bot, double miss_rate, uint64_t seed, uint64_t stream);
+
+
+/** Forget what mode the kit was in, eg after the kit is reset:
+    @param bot pointer to bot */
+void sim_bot_reset (SimBot* bot);
+
+
+/** Predict the column the ball will be in when it reaches the paddle row:
+    @param ball ball currently on screen
+    @return predicted x coordinate, or the ball's x if it never comes down */
+uint8_t sim_bot_predict_landing (const Ball* ball);
+
+
+/** Script the navswitch events a kit sees on its next tick:
+    @param bot pointer to bot
+    @param kit the kit the bot is playing
+    @param starter 1 if this bot pushes start on the menu
+    @param server 1 if this bot fires the ball when a round is waiting to start */
+void sim_bot_input (SimBot* bot, SimKit* kit, uint8_t starter, uint8_t server);
+
+
+#endif
@@ -0,0 +1,288 @@
+/** @file sim_energy.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief LED duty cycle and charge model for virtual kits
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_energy.h"
+#include "game.h"
+#include "pong_display.h"
+#include "system.h"
+
+#define LED_MA 4.0 //(3.3 V - 1.9 V red LED drop) / 330 ohm series resistor
+#define SUPPLY_V 3.3
+#define ACTIVE_MA 5.0 //ATmega32U2 at 8 MHz and 3.3 V, USB off
+#define IDLE_MA 1.5 //idle sleep, timer 1 left running
+#define CAPACITY_MAH 1000.0 //two AAA cells
+#define TICK_CYCLES (F_CPU / PACER_RATE)
+#define NUM_LEDS (LEDMAT_COLS_NUM * LEDMAT_ROWS_NUM)
+#define SECONDS_PER_HOUR 3600.0
+
+
+/* game_update cycles per tick in each mode. These are estimates for -Os
+ * builds: replace them with the game_update means make profile reports
+ * (-c mode=cycles) before trusting the MCU figures. */
+static const uint32_t default_cycles[SIM_ENERGY_MODES] = {1400, 600, 900, 1200, 1400};
+
+static const char* mode_names[SIM_ENERGY_MODES] = {"START_MENU", "PADDLE_MODE", "PLAY_MODE",
+                                                   "DISPLAY_SCORE_MODE", "GAME_OVER_MODE"};
+
+
+/** Set the default parameters: UCFK4 LEDs through their series resistors on a 3.3 V supply:
+    @param power parameters to fill in */
+void sim_energy_defaults (SimPower* power)
+{
+    power->led_ma = LED_MA;
+    power->supply_v = SUPPLY_V;
+    power->active_ma = ACTIVE_MA;
+    power->idle_ma = IDLE_MA;
+    power->capacity_mah = CAPACITY_MAH;
+    memcpy(power->mode_cycles, default_cycles, sizeof(default_cycles));
+}
+
+
+/** Parse a "mode=cycles" setting for one game mode, mode being its number or name:
+    @param power parameters to change
+    @param text the setting
+    @return 1 on success, else 0 */
+int sim_energy_parse_cycles (SimPower* power, const char* text)
+{
+    const char* equals = strchr(text, '=');
+    if (!equals || equals == text) {
+        return 0;
+    }
+    size_t length = equals - text;
+    for (uint8_t mode = 0; mode < SIM_ENERGY_MODES; mode++) {
+        char number = '0' + mode;
+        if ((length == 1 && text[0] == number) ||
+            (length == strlen(mode_names[mode]) && !strncmp(text, mode_names[mode], length))) {
+            char* end;
+            unsigned long cycles = strtoul(equals + 1, &end, 0);
+            if (*end || end == equals + 1 || cycles > TICK_CYCLES) {
+                return 0;
+            }
+            power->mode_cycles[mode] = cycles;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/** Clear every counter:
+    @param energy counters to clear */
+void sim_energy_init (SimEnergy* energy)
+{
+    memset(energy, 0, sizeof(*energy));
+}
+
+
+/** Find a bucket by label, adding it if there is room:
+    @param energy counters to search
+    @param label bucket label
+    @return the bucket, or NULL if every bucket is taken */
+static SimEnergyBucket* find_bucket (SimEnergy* energy, const char* label)
+{
+    for (uint8_t i = 0; i < energy->num_buckets; i++) {
+        if (!strcmp(energy->buckets[i].label, label)) {
+            return &energy->buckets[i];
+        }
+    }
+    if (energy->num_buckets == SIM_ENERGY_BUCKETS) {
+        return NULL;
+    }
+    SimEnergyBucket* bucket = &energy->buckets[energy->num_buckets++];
+    memset(bucket, 0, sizeof(*bucket));
+    snprintf(bucket->label, sizeof(bucket->label), "%s", label);
+    return bucket;
+}
+
+
+/** Label the time a kit is spending now:
+    @param kit the kit
+    @param label where to write the label, SIM_ENERGY_LABEL bytes */
+static void bucket_label (const SimKit* kit, char label[])
+{
+    switch (kit->game.game_mode) {
+        case START_MENU :
+        case GAME_OVER_MODE : {
+            // the messages end in a space so they scroll apart, which the label can do without
+            size_t length = strlen(kit->text);
+            while (length && kit->text[length - 1] == ' ') {
+                length--;
+            }
+            snprintf(label, SIM_ENERGY_LABEL, "scroll \"%.*s\"", (int) length, kit->text);
+            break;
+        }
+        case PADDLE_MODE : snprintf(label, SIM_ENERGY_LABEL, "paddle screen"); break;
+        case PLAY_MODE : snprintf(label, SIM_ENERGY_LABEL, "game play"); break;
+        default : snprintf(label, SIM_ENERGY_LABEL, "score screen"); break;
+    }
+}
+
+
+/** Count one pacer tick of a kit, call after each sim_world_step:
+    @param energy counters to add to
+    @param power parameters, for the cycles of the kit's mode
+    @param kit the kit */
+void sim_energy_sample (SimEnergy* energy, const SimPower* power, const SimKit* kit)
+{
+    char label[SIM_ENERGY_LABEL];
+    bucket_label(kit, label);
+    SimEnergyBucket* bucket = find_bucket(energy, label);
+    if (!bucket) {
+        energy->dropped_ticks++;
+        return;
+    }
+
+    uint8_t rows = kit->frame[kit->lit_column];
+    for (uint8_t row = 0; row < LEDMAT_ROWS_NUM; row++) {
+        if ((rows >> row) & 1) {
+            bucket->led_on[kit->lit_column][row]++;
+            bucket->led_ticks++;
+        }
+    }
+    bucket->ticks++;
+    if (kit->blocked) {
+        bucket->blocked_ticks++;
+        bucket->active_cycles += TICK_CYCLES;
+    } else {
+        uint8_t mode = kit->game.game_mode < SIM_ENERGY_MODES ? kit->game.game_mode : START_MENU;
+        bucket->active_cycles += power->mode_cycles[mode];
+    }
+}
+
+
+/** Add one set of counters into another, matching buckets by label:
+    @param to counters added to
+    @param from counters added */
+void sim_energy_merge (SimEnergy* to, const SimEnergy* from)
+{
+    to->dropped_ticks += from->dropped_ticks;
+    for (uint8_t i = 0; i < from->num_buckets; i++) {
+        const SimEnergyBucket* source = &from->buckets[i];
+        SimEnergyBucket* bucket = find_bucket(to, source->label);
+        if (!bucket) {
+            to->dropped_ticks += source->ticks;
+            continue;
+        }
+        bucket->ticks += source->ticks;
+        bucket->led_ticks += source->led_ticks;
+        bucket->blocked_ticks += source->blocked_ticks;
+        bucket->active_cycles += source->active_cycles;
+        for (uint8_t column = 0; column < LEDMAT_COLS_NUM; column++) {
+            for (uint8_t row = 0; row < LEDMAT_ROWS_NUM; row++) {
+                bucket->led_on[column][row] += source->led_on[column][row];
+            }
+        }
+    }
+}
+
+
+/** Charge drawn over one bucket, in millicoulombs (mA s):
+    @param bucket the bucket
+    @param power parameters
+    @param sleeping 1 if the MCU sleeps when it has nothing to do, 0 for the busy-wait pacer
+    @param led where to add the LED share of the charge, or NULL */
+static double bucket_charge (const SimEnergyBucket* bucket, const SimPower* power, uint8_t sleeping, double* led)
+{
+    double seconds = (double) bucket->ticks / PACER_RATE;
+    double led_charge = power->led_ma * bucket->led_ticks / PACER_RATE;
+    double mcu_charge = power->active_ma * seconds;
+    if (sleeping) {
+        double active = (double) bucket->active_cycles / F_CPU;
+        mcu_charge = power->active_ma * active + power->idle_ma * (seconds - active);
+    }
+    if (led) {
+        *led += led_charge;
+    }
+    return led_charge + mcu_charge;
+}
+
+
+/** Print how often each LED was lit in one bucket, as a share of its ticks:
+    @param bucket the bucket */
+static void print_heat_map (const SimEnergyBucket* bucket)
+{
+    printf("\nLED duty in %s, %% of ticks lit (row 0 at the top):\n", bucket->label);
+    for (uint8_t row = 0; row < LEDMAT_ROWS_NUM; row++) {
+        printf("  ");
+        for (uint8_t column = 0; column < LEDMAT_COLS_NUM; column++) {
+            printf(" %5.1f", 100.0 * bucket->led_on[column][row] / bucket->ticks);
+        }
+        printf("\n");
+    }
+}
+
+
+/** Print charge, duty and current for each bucket, a heat map of game play and battery life:
+    @param energy counters to report
+    @param power parameters
+    @param matches number of kit-matches the counters cover, for the per-match figures */
+void sim_energy_report (const SimEnergy* energy, const SimPower* power, uint64_t matches)
+{
+    SimEnergyBucket total;
+    double led_total = 0;
+    double busy_total = 0;
+    double sleep_total = 0;
+    const SimEnergyBucket* play = NULL;
+
+    memset(&total, 0, sizeof(total));
+    printf("LED %.1f mA, supply %.2f V, MCU %.1f mA active, %.1f mA idle, %u cycles per tick\n",
+           power->led_ma, power->supply_v, power->active_ma, power->idle_ma, TICK_CYCLES);
+    printf("game_update cycles:");
+    for (uint8_t mode = 0; mode < SIM_ENERGY_MODES; mode++) {
+        printf(" %s=%u", mode_names[mode], power->mode_cycles[mode]);
+    }
+    printf("\n\n%-30s %8s %6s %6s %6s %9s %9s %9s %8s %8s\n", "per match", "time s", "LEDs", "duty%",
+           "MCU%", "LED mC", "built mC", "sleep mC", "built mA", "sleep mA");
+
+    for (uint8_t i = 0; i < energy->num_buckets; i++) {
+        const SimEnergyBucket* bucket = &energy->buckets[i];
+        double led = 0;
+        double busy = bucket_charge(bucket, power, 0, &led);
+        double sleep = bucket_charge(bucket, power, 1, NULL);
+        double seconds = (double) bucket->ticks / PACER_RATE;
+        printf("%-30s %8.2f %6.2f %6.2f %6.1f %9.1f %9.1f %9.1f %8.2f %8.2f\n", bucket->label,
+               seconds / matches, (double) bucket->led_ticks / bucket->ticks,
+               100.0 * bucket->led_ticks / bucket->ticks / NUM_LEDS,
+               100.0 * bucket->active_cycles / bucket->ticks / TICK_CYCLES,
+               led / matches, busy / matches, sleep / matches, busy / seconds, sleep / seconds);
+        total.ticks += bucket->ticks;
+        total.led_ticks += bucket->led_ticks;
+        total.active_cycles += bucket->active_cycles;
+        led_total += led;
+        busy_total += busy;
+        sleep_total += sleep;
+        if (!strcmp(bucket->label, "game play")) {
+            play = bucket;
+        }
+    }
+
+    double seconds = (double) total.ticks / PACER_RATE;
+    printf("%-30s %8.2f %6.2f %6.2f %6.1f %9.1f %9.1f %9.1f %8.2f %8.2f\n", "whole match",
+           seconds / matches, (double) total.led_ticks / total.ticks,
+           100.0 * total.led_ticks / total.ticks / NUM_LEDS,
+           100.0 * total.active_cycles / total.ticks / TICK_CYCLES, led_total / matches,
+           busy_total / matches, sleep_total / matches, busy_total / seconds, sleep_total / seconds);
+    if (energy->dropped_ticks) {
+        printf("%llu ticks not counted, more than %u buckets\n",
+               (unsigned long long) energy->dropped_ticks, SIM_ENERGY_BUCKETS);
+    }
+    if (play && play->ticks) {
+        print_heat_map(play);
+    }
+
+    // mC is mA s, so energy in mJ is charge times volts
+    double busy_ma = busy_total / seconds;
+    double sleep_ma = sleep_total / seconds;
+    printf("\nper match: %.1f mJ as built, %.1f mJ with the MCU sleeping between ticks\n",
+           busy_total / matches * power->supply_v, sleep_total / matches * power->supply_v);
+    printf("battery life at %.0f mAh, playing non-stop: %.1f h as built, %.1f h sleeping (%.0f%% longer)\n",
+           power->capacity_mah, power->capacity_mah / busy_ma, power->capacity_mah / sleep_ma,
+           100.0 * (busy_ma / sleep_ma - 1));
+}
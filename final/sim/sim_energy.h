@@ -0,0 +1,97 @@
+/** @file sim_energy.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief LED duty cycle and charge model for virtual kits
+ */
+
+
+#ifndef SIM_ENERGY_H
+#define SIM_ENERGY_H
+
+#include "sim_kit.h"
+
+#define SIM_ENERGY_BUCKETS 8 //scroll messages and game screens tracked
+#define SIM_ENERGY_LABEL 40
+#define SIM_ENERGY_MODES 5 //game modes, START_MENU to GAME_OVER_MODE
+
+
+/* The matrix is strobed one column at a time, so the LEDs lit during a tick
+ * are the lit rows of the column driven last, each drawing the configured
+ * LED current until the next column is driven. The MCU is taken as active
+ * for the cycles game_update spends in the kit's mode and idle for the rest
+ * of the tick, except on ticks the kit spends blocked in ir_uart_getc, which
+ * are active throughout. The firmware's pacer busy-waits, so as built the
+ * MCU never idles; the report gives the charge both ways.
+ *
+ * Time is split into buckets: each scrolled message on the start menu and
+ * game over screen, the paddle screen, game play and the score screen. */
+
+
+/** Electrical parameters, all configurable from the command line */
+typedef struct {
+    double led_ma; //current through one lit LED
+    double supply_v;
+    double active_ma; //MCU running
+    double idle_ma; //MCU in idle sleep between ticks
+    double capacity_mah; //battery capacity, for the battery life estimate
+    uint32_t mode_cycles[SIM_ENERGY_MODES]; //game_update cycles per tick in each mode, see make profile
+} SimPower;
+
+
+/** Time spent in one bucket */
+typedef struct {
+    char label[SIM_ENERGY_LABEL];
+    uint64_t ticks;
+    uint64_t led_ticks; //sum over ticks of the LEDs lit
+    uint64_t led_on[LEDMAT_COLS_NUM][LEDMAT_ROWS_NUM]; //ticks each LED was lit
+    uint64_t blocked_ticks; //ticks spent blocked in ir_uart_getc
+    uint64_t active_cycles; //MCU cycles spent running
+} SimEnergyBucket;
+
+
+/** Energy counters for one or more kits */
+typedef struct {
+    SimEnergyBucket buckets[SIM_ENERGY_BUCKETS];
+    uint8_t num_buckets;
+    uint64_t dropped_ticks; //ticks with no free bucket
+} SimEnergy;
+
+
+/** Set the default parameters: UCFK4 LEDs through their series resistors on a 3.3 V supply:
+    @param power parameters to fill in */
+void sim_energy_defaults (SimPower* power);
+
+
+/** Parse a "mode=cycles" setting for one game mode, mode being its number or name:
+    @param power parameters to change
+    @param text the setting
+    @return 1 on success, else 0 */
+int sim_energy_parse_cycles (SimPower* power, const char* text);
+
+
+/** Clear every counter:
+    @param energy counters to clear */
+void sim_energy_init (SimEnergy* energy);
+
+
+/** Count one pacer tick of a kit, call after each sim_world_step:
+    @param energy counters to add to
+    @param power parameters, for the cycles of the kit's mode
+    @param kit the kit */
+void sim_energy_sample (SimEnergy* energy, const SimPower* power, const SimKit* kit);
+
+
+/** Add one set of counters into another, matching buckets by label:
+    @param to counters added to
+    @param from counters added */
+void sim_energy_merge (SimEnergy* to, const SimEnergy* from);
+
+
+/** Print charge, duty and current for each bucket, a heat map of game play and battery life:
+    @param energy counters to report
+    @param power parameters
+    @param matches number of kit-matches the counters cover, for the per-match figures */
+void sim_energy_report (const SimEnergy* energy, const SimPower* power, uint64_t matches);
+
+
+#endif
@@ -0,0 +1,471 @@
+/** @file sim_kit.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief virtual fun kits running the real game logic over a simulated IR link
+ */
+
+
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_kit.h"
+#include "pong_display.h"
+#include "navswitch.h"
+
+#define SIM_STACK_SIZE (64 * 1024)
+#define ALL_PINS_HIGH 0xFF
+#define EEPROM_ERASED 0xFF
+
+
+/* Coroutines are started with makecontext but switched with _setjmp/_longjmp,
+ * which unlike swapcontext does not make a signal mask system call per switch. */
+static __thread SimKit* current_kit;
+static __thread jmp_buf scheduler_jump;
+
+
+/** Return the kit whose code is currently running, NULL outside any kit */
+SimKit* sim_current_kit (void)
+{
+    return current_kit;
+}
+
+
+/** Hand control back to the scheduler from inside a kit, resuming next tick */
+void sim_kit_yield (void)
+{
+    if (!_setjmp(current_kit->jump)) {
+        _longjmp(scheduler_jump, 1);
+    }
+}
+
+
+/** Pacer ticks taken to clock one byte out at the given rate:
+    @param baud UART rate in bits per second */
+double sim_byte_ticks (uint32_t baud)
+{
+    return (double) SIM_UART_FRAME_BITS * PACER_RATE / baud;
+}
+
+
+/** Default kit firmware: the same init and pacer loop as main() in game.c:
+    @param kit the kit being run */
+void sim_firmware_loop (SimKit* kit)
+{
+    init_led_matrix();
+    RECORD_INIT();
+    TRACE_INIT();
+    ball_init(&kit->ball, 0, HEIGHT, STRAIGHT, UP, OFF_SCREEN);
+    game_init(&kit->game, &kit->paddle, kit->bitmap);
+    while (1) {
+        pacer_wait();
+        game_update(&kit->game, &kit->ball, &kit->paddle, kit->bitmap);
+    }
+}
+
+
+/** Coroutine entry point, the kit is passed through current_kit */
+static void kit_trampoline (void)
+{
+    SimKit* kit = current_kit;
+    kit->entry(kit);
+    // firmware loops never return, but park the kit forever if one does
+    while (1) {
+        sim_kit_yield();
+    }
+}
+
+
+/** Point a kit's coroutine back at the start of its firmware:
+    @param kit pointer to kit */
+static void start_context (SimKit* kit)
+{
+    getcontext(&kit->context);
+    kit->context.uc_stack.ss_sp = kit->stack;
+    kit->context.uc_stack.ss_size = SIM_STACK_SIZE;
+    kit->context.uc_link = NULL;
+    makecontext(&kit->context, kit_trampoline, 0);
+    kit->started = 0;
+}
+
+
+/** Clear driver state to its power-on values:
+    @param kit pointer to kit */
+static void reset_drivers (SimKit* kit)
+{
+    kit->nav_pending = 0;
+    kit->nav_events = 0;
+    kit->row_pins = ALL_PINS_HIGH;
+    kit->col_pins = ALL_PINS_HIGH;
+    memset(kit->frame, 0, sizeof(kit->frame));
+    kit->lit_column = 0;
+    sim_tinygl_reset(kit);
+    kit->fifo_count = 0;
+    kit->blocked = 0;
+}
+
+
+/** Initialise a kit and start its coroutine:
+    @param kit pointer to kit being initialised
+    @param id index of the kit in its world
+    @param entry firmware loop to run, eg sim_firmware_loop */
+void sim_kit_init (SimKit* kit, uint8_t id, void (*entry) (SimKit* kit))
+{
+    memset(kit, 0, sizeof(SimKit));
+    kit->id = id;
+    kit->entry = entry;
+    kit->stack = malloc(SIM_STACK_SIZE);
+    kit->recorder = malloc(sizeof(Recorder));
+    kit->tracer = malloc(sizeof(Tracer));
+    memset(kit->eeprom, EEPROM_ERASED, EEPROM_SIZE);
+    reset_drivers(kit);
+    start_context(kit);
+}
+
+
+/** Restart a kit as if its reset button was pressed, dropping anything in its FIFO:
+    @param kit pointer to kit */
+void sim_kit_reset (SimKit* kit)
+{
+    memset(&kit->game, 0, sizeof(kit->game));
+    memset(&kit->ball, 0, sizeof(kit->ball));
+    memset(&kit->display, 0, sizeof(kit->display));
+    reset_drivers(kit);
+    start_context(kit);
+}
+
+
+/** Release a kit's stack:
+    @param kit pointer to kit */
+void sim_kit_free (SimKit* kit)
+{
+    free(kit->stack);
+    free(kit->recorder);
+    free(kit->tracer);
+    kit->stack = NULL;
+    kit->recorder = NULL;
+    kit->tracer = NULL;
+}
+
+
+/** Initialise one direction of a link:
+    @param link pointer to link being initialised
+    @param to kit receiving bytes sent over the link
+    @param channel channel conditions
+    @param seed random seed for losses, corruption and jitter */
+void sim_link_init (SimLink* link, SimKit* to, const SimChannel* channel, uint64_t seed)
+{
+    memset(link, 0, sizeof(SimLink));
+    link->channel = *channel;
+    link->to = to;
+    sim_rng_seed(&link->rng, seed, to->id);
+}
+
+
+/** Drop every byte currently in the air:
+    @param link pointer to link */
+void sim_link_clear (SimLink* link)
+{
+    link->head = 0;
+    link->count = 0;
+}
+
+
+/** Wire up two kits facing each other:
+    @param world world to initialise, with room for two kits and two links
+    @param kits array of two kits
+    @param links array of two links
+    @param channel conditions applied to both directions
+    @param seed random seed for the links */
+void sim_world_init_pair (SimWorld* world, SimKit kits[], SimLink links[], const SimChannel* channel, uint64_t seed)
+{
+    sim_world_init_ring(world, kits, links, 2, channel, seed);
+}
+
+
+/** Wire up kits in a ring, kit n transmitting to kit n + 1 and the last kit to kit 0:
+    @param world world to initialise
+    @param kits array of num_kits kits
+    @param links array of num_kits links, link n carrying what kit n transmits
+    @param num_kits number of kits, two for a pair facing each other
+    @param channel conditions applied to every link
+    @param seed random seed for the links */
+void sim_world_init_ring (SimWorld* world, SimKit kits[], SimLink links[], uint8_t num_kits,
+                          const SimChannel* channel, uint64_t seed)
+{
+    world->kits = kits;
+    world->num_kits = num_kits;
+    world->links = links;
+    world->num_links = num_kits;
+    world->tick = 0;
+    for (uint8_t i = 0; i < num_kits; i++) {
+        sim_kit_init(&kits[i], i, sim_firmware_loop);
+        kits[i].tx = &links[i];
+    }
+    for (uint8_t i = 0; i < num_kits; i++) {
+        sim_link_init(&links[i], &kits[(i + 1) % num_kits], channel, seed);
+    }
+}
+
+
+/** Put a transmitted byte in the air, applying loss, corruption and delay:
+    @param link link the byte is sent on
+    @param byte the byte as transmitted
+    @param now current pacer tick */
+static void link_send (SimLink* link, uint8_t byte, uint64_t now)
+{
+    const SimChannel* channel = &link->channel;
+    double start = link->busy_until > now ? link->busy_until : now;
+    link->busy_until = start + sim_byte_ticks(channel->baud);
+    link->sent++;
+
+    if (sim_rng_uniform(&link->rng) < channel->loss || link->count == SIM_FLIGHT_MAX) {
+        link->lost++;
+        return;
+    }
+    if (channel->ber > 0) {
+        uint8_t original = byte;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            if (sim_rng_uniform(&link->rng) < channel->ber) {
+                byte ^= 1 << bit;
+            }
+        }
+        link->corrupted += byte != original;
+    }
+
+    double arrival = link->busy_until + channel->delay;
+    if (channel->jitter > 0) {
+        arrival += channel->jitter * sim_rng_uniform(&link->rng);
+    }
+    // the receiving UART takes a whole byte time to clock each byte in, however they were delayed
+    if (arrival < link->last_arrival + sim_byte_ticks(channel->baud)) {
+        arrival = link->last_arrival + sim_byte_ticks(channel->baud);
+    }
+    link->last_arrival = arrival;
+
+    SimByte* slot = &link->flight[(link->head + link->count) % SIM_FLIGHT_MAX];
+    slot->byte = byte;
+    slot->arrival = arrival;
+    link->count++;
+}
+
+
+/** Move bytes that have arrived into the receiving kit's FIFO:
+    @param link link to deliver from
+    @param now current pacer tick */
+static void link_deliver (SimLink* link, uint64_t now)
+{
+    SimKit* kit = link->to;
+    while (link->count && link->flight[link->head].arrival <= now) {
+        if (kit->fifo_count < SIM_RX_FIFO) {
+            kit->fifo[kit->fifo_count++] = link->flight[link->head].byte;
+        } else {
+            kit->overruns++;
+        }
+        link->head = (link->head + 1) % SIM_FLIGHT_MAX;
+        link->count--;
+    }
+}
+
+
+/** Resume a kit's firmware until it next waits on the pacer or the UART:
+    @param kit pointer to kit */
+static void run_kit (SimKit* kit)
+{
+    current_kit = kit;
+    pong_display = &kit->display;
+#ifdef RECORD
+    recorder = kit->recorder;
+#endif
+#ifdef TRACE
+    // stamp with world time: the stand-in pacer_wait does not catch up after a blocking read like the real one
+    tracer = kit->tracer;
+    tracer->tick = kit->tick;
+#endif
+    if (!_setjmp(scheduler_jump)) {
+        if (kit->started) {
+            _longjmp(kit->jump, 1);
+        }
+        kit->started = 1;
+        setcontext(&kit->context);
+    }
+    current_kit = NULL;
+}
+
+
+/** Advance the world by one pacer tick: deliver arrived bytes and run each kit's loop once:
+    @param world pointer to world */
+void sim_world_step (SimWorld* world)
+{
+    world->tick++;
+    for (uint8_t i = 0; i < world->num_links; i++) {
+        link_deliver(&world->links[i], world->tick);
+    }
+    for (uint8_t i = 0; i < world->num_kits; i++) {
+        world->kits[i].tick = world->tick;
+        run_kit(&world->kits[i]);
+    }
+}
+
+
+/* Driver stand-ins. Each acts on whichever kit is currently running. */
+
+
+void system_init (void)
+{
+}
+
+
+void pacer_init (uint16_t pacer_rate)
+{
+    (void) pacer_rate;
+}
+
+
+void pacer_wait (void)
+{
+    sim_kit_yield();
+}
+
+
+void navswitch_init (void)
+{
+}
+
+
+void navswitch_update (void)
+{
+    current_kit->nav_events = current_kit->nav_pending;
+    current_kit->nav_pending = 0;
+}
+
+
+bool navswitch_push_event_p (uint8_t navswitch)
+{
+    return (current_kit->nav_events >> navswitch) & 1;
+}
+
+
+bool navswitch_release_event_p (uint8_t navswitch)
+{
+    (void) navswitch;
+    return 0;
+}
+
+
+bool navswitch_down_p (uint8_t navswitch)
+{
+    return navswitch_push_event_p(navswitch);
+}
+
+
+int8_t ir_uart_init (void)
+{
+    return 1;
+}
+
+
+void ir_uart_putc (char ch)
+{
+    SimKit* kit = current_kit;
+    kit->tx_bytes++;
+    if (kit->tx) {
+        link_send(kit->tx, (uint8_t) ch, kit->tick);
+    }
+}
+
+
+char ir_uart_getc (void)
+{
+    SimKit* kit = current_kit;
+    while (!kit->fifo_count) {
+        // busy waits on hardware, so the kit does nothing else until a byte lands
+        kit->blocked = 1;
+        kit->blocked_ticks++;
+        sim_kit_yield();
+    }
+    kit->blocked = 0;
+    kit->rx_bytes++;
+    uint8_t byte = kit->fifo[0];
+    kit->fifo_count--;
+    memmove(kit->fifo, kit->fifo + 1, kit->fifo_count);
+    return byte;
+}
+
+
+bool ir_uart_read_ready_p (void)
+{
+    return current_kit->fifo_count != 0;
+}
+
+
+bool ir_uart_write_ready_p (void)
+{
+    return 1;
+}
+
+
+bool pio_config_set (pio_t pio, pio_config_t config)
+{
+    if (config == PIO_OUTPUT_LOW) {
+        pio_output_low(pio);
+    } else {
+        pio_output_high(pio);
+    }
+    return 1;
+}
+
+
+void pio_output_high (pio_t pio)
+{
+    if (pio >= LEDMAT_COL_PIO_BASE) {
+        current_kit->col_pins |= 1 << (pio - LEDMAT_COL_PIO_BASE);
+    } else {
+        current_kit->row_pins |= 1 << pio;
+    }
+}
+
+
+void pio_output_low (pio_t pio)
+{
+    SimKit* kit = current_kit;
+    if (pio >= LEDMAT_COL_PIO_BASE) {
+        uint8_t column = pio - LEDMAT_COL_PIO_BASE;
+        kit->col_pins &= ~(1 << column);
+        // rows are active low, latch what this column now shows
+        kit->frame[column] = ~kit->row_pins & ((1 << LEDMAT_ROWS_NUM) - 1);
+        kit->lit_column = column;
+    } else {
+        kit->row_pins &= ~(1 << pio);
+    }
+}
+
+
+void eeprom_async_init (void)
+{
+}
+
+
+void eeprom_async_read (uint16_t address, uint8_t data[], uint8_t length)
+{
+    memcpy(data, current_kit->eeprom + address, length);
+}
+
+
+uint8_t eeprom_async_write (uint16_t address, const uint8_t data[], uint8_t length)
+{
+    // finishes at once, a block takes a few ticks on hardware but nothing reads it back meanwhile
+    SimKit* kit = current_kit;
+    for (uint8_t i = 0; i < length; i++) {
+        if (kit->eeprom[address + i] != data[i]) {
+            kit->eeprom[address + i] = data[i];
+            kit->eeprom_writes++;
+        }
+    }
+    return 1;
+}
+
+
+uint8_t eeprom_async_busy (void)
+{
+    return 0;
+}
@@ -0,0 +1,204 @@
+/** @file sim_kit.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief virtual fun kits running the real game logic over a simulated IR link
+ */
+
+
+#ifndef SIM_KIT_H
+#define SIM_KIT_H
+
+#include <setjmp.h>
+#include <ucontext.h>
+#include "game.h"
+#include "recorder.h"
+#include "tracer.h"
+#include "pong_display.h"
+#include "eeprom_async.h"
+#include "font.h"
+#include "sim_util.h"
+
+#define SIM_RX_FIFO 2 //bytes the USART holds before further bytes overrun
+#define SIM_FLIGHT_MAX 64 //bytes that can be in the air on one link
+#define SIM_TEXT_MAX 32
+#define SIM_UART_FRAME_BITS 10 //start + 8 data + stop
+
+
+/* Each kit runs its firmware loop as a coroutine on its own stack. The
+ * stand-in pacer_wait() and a blocking ir_uart_getc() hand control back to
+ * the scheduler, so the game code runs unmodified and a kit stuck waiting
+ * for a lost byte stays stuck, exactly as it would on hardware. */
+
+
+/** IR channel conditions for one direction of a link */
+typedef struct {
+    uint32_t baud; //UART rate, sets the air time of each byte
+    double delay; //fixed propagation and processing delay in pacer ticks
+    double jitter; //extra uniformly distributed delay in [0, jitter) ticks
+    double loss; //probability a byte is never received
+    double ber; //probability each bit of a received byte is inverted
+} SimChannel;
+
+
+typedef struct {
+    uint8_t byte;
+    double arrival; //pacer tick at which the byte lands in the receiver's FIFO
+} SimByte;
+
+
+typedef struct sim_kit_s SimKit;
+
+
+/** One direction of an IR link: bytes transmitted by one kit towards another */
+typedef struct {
+    SimChannel channel;
+    SimRng rng;
+    SimKit* to;
+    double busy_until; //end of the byte currently being clocked out
+    double last_arrival; //a UART cannot reorder bytes or take in two at once, so arrivals are a byte time apart
+    SimByte flight[SIM_FLIGHT_MAX];
+    uint8_t head;
+    uint8_t count;
+    uint64_t sent;
+    uint64_t lost;
+    uint64_t corrupted;
+} SimLink;
+
+
+/** A virtual fun kit: the game objects main() would own plus the state of every driver */
+struct sim_kit_s {
+    uint8_t id;
+    Game game;
+    Ball ball;
+    Paddle paddle;
+    uint8_t bitmap[HEIGHT];
+
+    void (*entry) (SimKit* kit); //firmware loop run as the kit's coroutine
+    void* user; //owned by the tool driving the simulation
+    SimLink* tx; //link carrying bytes this kit transmits, NULL if none
+    uint64_t tick;
+
+    uint8_t nav_pending; //bitmask of navswitch events scripted for the next update
+    uint8_t nav_events; //events latched by the last navswitch_update
+    uint8_t row_pins; //bit n high if row n is high (led off)
+    uint8_t col_pins;
+    uint8_t frame[LEDMAT_COLS_NUM]; //lit rows latched each time a column is driven
+    uint8_t lit_column; //column driven last, which stays lit until the next one is
+    char text[SIM_TEXT_MAX]; //last string handed to tinygl
+    uint8_t text_mode;
+    const font_t* font;
+    uint16_t text_period; //tinygl updates between scroll steps
+    uint16_t text_ticks; //tinygl updates since the last scroll step
+    uint16_t text_offset; //first pixel column of the text on screen
+    uint8_t text_column; //next column tinygl refreshes
+    uint16_t tinygl_rate;
+
+    uint8_t fifo[SIM_RX_FIFO];
+    uint8_t fifo_count;
+    uint8_t blocked; //1 while waiting in ir_uart_getc
+    uint64_t blocked_ticks;
+    uint64_t overruns;
+    uint64_t tx_bytes;
+    uint64_t rx_bytes;
+    Recorder* recorder; //this kit's record mode log
+    Tracer* tracer; //this kit's trace ring
+    PongDisplay display; //this kit's display state, cleared on reset as static data is
+    uint8_t eeprom[EEPROM_SIZE]; //kept across resets, as on hardware
+    uint64_t eeprom_writes; //bytes written, unchanged bytes are skipped as on hardware
+
+    ucontext_t context; //initial context at the top of the firmware loop
+    jmp_buf jump; //where the kit last yielded
+    uint8_t started;
+    char* stack;
+};
+
+
+/** Set of kits and links advanced together one pacer tick at a time */
+typedef struct {
+    SimKit* kits;
+    uint8_t num_kits;
+    SimLink* links;
+    uint8_t num_links;
+    uint64_t tick;
+} SimWorld;
+
+
+/** Clear a kit's tinygl state, see sim_tinygl.c:
+    @param kit pointer to kit */
+void sim_tinygl_reset (SimKit* kit);
+
+
+/** Default kit firmware: the same init and pacer loop as main() in game.c:
+    @param kit the kit being run */
+void sim_firmware_loop (SimKit* kit);
+
+
+/** Initialise a kit and start its coroutine:
+    @param kit pointer to kit being initialised
+    @param id index of the kit in its world
+    @param entry firmware loop to run, eg sim_firmware_loop */
+void sim_kit_init (SimKit* kit, uint8_t id, void (*entry) (SimKit* kit));
+
+
+/** Restart a kit as if its reset button was pressed, dropping anything in its FIFO:
+    @param kit pointer to kit */
+void sim_kit_reset (SimKit* kit);
+
+
+/** Release a kit's stack:
+    @param kit pointer to kit */
+void sim_kit_free (SimKit* kit);
+
+
+/** Initialise one direction of a link:
+    @param link pointer to link being initialised
+    @param to kit receiving bytes sent over the link
+    @param channel channel conditions
+    @param seed random seed for losses, corruption and jitter */
+void sim_link_init (SimLink* link, SimKit* to, const SimChannel* channel, uint64_t seed);
+
+
+/** Drop every byte currently in the air:
+    @param link pointer to link */
+void sim_link_clear (SimLink* link);
+
+
+/** Wire up two kits facing each other:
+    @param world world to initialise, with room for two kits and two links
+    @param kits array of two kits
+    @param links array of two links
+    @param channel conditions applied to both directions
+    @param seed random seed for the links */
+void sim_world_init_pair (SimWorld* world, SimKit kits[], SimLink links[], const SimChannel* channel, uint64_t seed);
+
+
+/** Wire up kits in a ring, kit n transmitting to kit n + 1 and the last kit to kit 0:
+    @param world world to initialise
+    @param kits array of num_kits kits
+    @param links array of num_kits links, link n carrying what kit n transmits
+    @param num_kits number of kits, two for a pair facing each other
+    @param channel conditions applied to every link
+    @param seed random seed for the links */
+void sim_world_init_ring (SimWorld* world, SimKit kits[], SimLink links[], uint8_t num_kits,
+                          const SimChannel* channel, uint64_t seed);
+
+
+/** Advance the world by one pacer tick: deliver arrived bytes and run each kit's loop once:
+    @param world pointer to world */
+void sim_world_step (SimWorld* world);
+
+
+/** Return the kit whose code is currently running, NULL outside any kit */
+SimKit* sim_current_kit (void);
+
+
+/** Hand control back to the scheduler from inside a kit, resuming next tick */
+void sim_kit_yield (void);
+
+
+/** Pacer ticks taken to clock one byte out at the given rate:
+    @param baud UART rate in bits per second */
+double sim_byte_ticks (uint32_t baud);
+
+
+#endif
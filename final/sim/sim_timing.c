@@ -0,0 +1,14 @@
+/** @file sim_timing.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief the simulator's timing settings, see timing.h
+ */
+
+
+#include "timing.h"
+
+
+/* Each thread starts with the firmware's settings. Only timing_tune
+ * changes them, before it starts a thread's kits. */
+TIMING_STORAGE Timing timing = {TIMING_PACER_RATE, TIMING_BALL_RATE, TIMING_DISPLAY_RATE,
+                                TIMING_DISPLAY_CYCLES, TIMING_MESSAGE_RATE};
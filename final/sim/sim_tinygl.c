@@ -0,0 +1,167 @@
+/** @file sim_tinygl.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief host stand-in for tinygl that draws text on a virtual kit's LED matrix
+ */
+
+
+#include <string.h>
+#include "sim_kit.h"
+#include "pong_display.h"
+
+#define GLYPH_COLUMNS 5
+#define CHAR_GAP 1 //blank pixel columns after each character
+#define SPEED_SCALE 10 //tinygl text speeds are in characters per 10 seconds
+
+
+/* Text is drawn through display_column one column per tinygl_update, as
+ * tinygl's display module does, so the pins and the energy model see the
+ * same column strobing as in game play. The UCFK4 fonts are not part of this
+ * tree, so the glyphs below are a common 5x7 design and a 3x5 set of digits
+ * for the characters the game shows. Others are drawn blank. Lit pixel
+ * counts are close to the real fonts, not exact. */
+
+
+/** One glyph: a bit per row in each column, row 0 in bit 0 */
+typedef struct {
+    char character;
+    uint8_t columns[GLYPH_COLUMNS];
+} Glyph;
+
+
+static const Glyph glyphs5x7[] = {
+    {' ', {0x00, 0x00, 0x00, 0x00, 0x00}},
+    {'(', {0x00, 0x1C, 0x22, 0x41, 0x00}},
+    {')', {0x00, 0x41, 0x22, 0x1C, 0x00}},
+    {':', {0x00, 0x36, 0x36, 0x00, 0x00}},
+    {'A', {0x7E, 0x11, 0x11, 0x11, 0x7E}},
+    {'E', {0x7F, 0x49, 0x49, 0x49, 0x41}},
+    {'G', {0x3E, 0x41, 0x49, 0x49, 0x7A}},
+    {'H', {0x7F, 0x08, 0x08, 0x08, 0x7F}},
+    {'I', {0x00, 0x41, 0x7F, 0x41, 0x00}},
+    {'L', {0x7F, 0x40, 0x40, 0x40, 0x40}},
+    {'N', {0x7F, 0x04, 0x08, 0x10, 0x7F}},
+    {'O', {0x3E, 0x41, 0x41, 0x41, 0x3E}},
+    {'P', {0x7F, 0x09, 0x09, 0x09, 0x06}},
+    {'R', {0x7F, 0x09, 0x19, 0x29, 0x46}},
+    {'S', {0x46, 0x49, 0x49, 0x49, 0x31}},
+    {'T', {0x01, 0x01, 0x7F, 0x01, 0x01}},
+    {'U', {0x3F, 0x40, 0x40, 0x40, 0x3F}},
+    {'W', {0x3F, 0x40, 0x38, 0x40, 0x3F}},
+    {0, {0}}
+};
+
+
+static const Glyph glyphs3x5[] = {
+    {'0', {0x1F, 0x11, 0x1F}},
+    {'1', {0x00, 0x1F, 0x00}},
+    {'2', {0x1D, 0x15, 0x17}},
+    {'3', {0x15, 0x15, 0x1F}},
+    {'4', {0x07, 0x04, 0x1F}},
+    {'5', {0x17, 0x15, 0x1D}},
+    {'6', {0x1F, 0x15, 0x1D}},
+    {'7', {0x01, 0x01, 0x1F}},
+    {'8', {0x1F, 0x15, 0x1F}},
+    {'9', {0x17, 0x15, 0x1F}},
+    {0, {0}}
+};
+
+
+const font_t font5x7_1 = {0, 5, 7, 0, 0, 0, NULL};
+const font_t font3x5_1 = {0, 3, 5, 0, 0, 0, NULL};
+
+
+/** Clear a kit's tinygl state, see sim_tinygl.c:
+    @param kit pointer to kit */
+void sim_tinygl_reset (SimKit* kit)
+{
+    kit->text[0] = '\0';
+    kit->text_mode = TINYGL_TEXT_MODE_STEP;
+    kit->font = &font5x7_1;
+    kit->text_period = 0;
+    kit->text_ticks = 0;
+    kit->text_offset = 0;
+    kit->text_column = 0;
+    kit->tinygl_rate = PACER_RATE;
+}
+
+
+/** Lit rows of one pixel column of a kit's text:
+    @param kit the kit
+    @param position pixel column counted from the start of the text
+    @return bit n set if row n is lit */
+static uint8_t text_column (const SimKit* kit, uint16_t position)
+{
+    uint8_t pitch = kit->font->width + CHAR_GAP;
+    uint16_t index = position / pitch;
+    uint8_t column = position % pitch;
+    if (index >= strlen(kit->text) || column >= kit->font->width) {
+        return 0;
+    }
+    const Glyph* glyph = kit->font == &font3x5_1 ? glyphs3x5 : glyphs5x7;
+    for (; glyph->character; glyph++) {
+        if (glyph->character == kit->text[index]) {
+            return glyph->columns[column];
+        }
+    }
+    return 0;
+}
+
+
+void tinygl_init (const uint16_t update_rate)
+{
+    SimKit* kit = sim_current_kit();
+    kit->tinygl_rate = update_rate;
+    kit->text_column = 0;
+}
+
+
+void tinygl_font_set (const font_t* font)
+{
+    sim_current_kit()->font = font;
+}
+
+
+void tinygl_text_speed_set (uint8_t speed)
+{
+    SimKit* kit = sim_current_kit();
+    // one pixel column at a time, each character being its width and a gap
+    uint32_t steps = (uint32_t) (speed ? speed : 1) * (kit->font->width + CHAR_GAP);
+    kit->text_period = (uint32_t) kit->tinygl_rate * SPEED_SCALE / steps;
+}
+
+
+void tinygl_text (const char* string)
+{
+    SimKit* kit = sim_current_kit();
+    strncpy(kit->text, string, SIM_TEXT_MAX - 1);
+    kit->text[SIM_TEXT_MAX - 1] = '\0';
+    kit->text_offset = 0;
+    kit->text_ticks = 0;
+}
+
+
+void tinygl_text_mode_set (tinygl_text_mode_t text_mode)
+{
+    sim_current_kit()->text_mode = text_mode;
+}
+
+
+void tinygl_update (void)
+{
+    SimKit* kit = sim_current_kit();
+    if (kit->text_mode == TINYGL_TEXT_MODE_SCROLL && kit->text[0] && ++kit->text_ticks >= kit->text_period) {
+        // scroll left a pixel column, starting again once the text has gone by
+        uint16_t length = strlen(kit->text) * (kit->font->width + CHAR_GAP);
+        kit->text_ticks = 0;
+        kit->text_offset = kit->text_offset + 1 < length ? kit->text_offset + 1 : 0;
+    }
+    display_column(text_column(kit, kit->text_offset + kit->text_column), kit->text_column);
+    kit->text_column = kit->text_column + 1 < LEDMAT_COLS_NUM ? kit->text_column + 1 : 0;
+}
+
+
+void tinygl_clear (void)
+{
+    sim_current_kit()->text[0] = '\0';
+}
@@ -0,0 +1,244 @@
+/** @file sim_util.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief shared helpers for the host-side simulation tools
+ */
+
+
+#include "sim_util.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CACHE_LINE 64 //bytes, on every x86-64 and most ARM64 hosts
+
+
+/** Per-thread state for the worker pool. Each worker owns a range of chunks,
+    takes from its front and, once empty, steals the back half of the busiest
+    other worker's range */
+typedef struct worker_s Worker;
+struct worker_s {
+    pthread_mutex_t lock;
+    uint64_t begin; //next chunk this worker will run, written under lock but read by thieves without it
+    uint64_t end; //one past the last chunk it owns, likewise
+    Worker* pool;
+    unsigned num_workers;
+    SimChunkFunc func;
+    void* context;
+    void* accumulator;
+};
+
+
+/** splitmix64 step, used to expand seeds into full generator state:
+    @param state pointer to 64 bit state to advance
+    @return the next mixed value */
+static uint64_t splitmix64 (uint64_t* state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+
+static uint64_t rotl (uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+
+/** Seed a generator for an independent stream:
+    @param rng pointer to generator being seeded
+    @param seed run seed given on the command line
+    @param stream index of the stream (eg sweep point and chunk number) */
+void sim_rng_seed (SimRng* rng, uint64_t seed, uint64_t stream)
+{
+    uint64_t state = seed ^ splitmix64(&stream);
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = splitmix64(&state);
+    }
+}
+
+
+/** Return the next 64 random bits:
+    @param rng pointer to generator */
+uint64_t sim_rng_next (SimRng* rng)
+{
+    uint64_t* s = rng->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+
+/** Return a uniformly distributed double in [0, 1):
+    @param rng pointer to generator */
+double sim_rng_uniform (SimRng* rng)
+{
+    return (sim_rng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+
+/** Return a uniformly distributed integer in [0, bound):
+    @param rng pointer to generator
+    @param bound exclusive upper limit, must be non-zero */
+uint32_t sim_rng_below (SimRng* rng, uint32_t bound)
+{
+    // multiply-shift reduction, bias is below 2^-32 and irrelevant here
+    return (uint32_t) (((sim_rng_next(rng) >> 32) * bound) >> 32);
+}
+
+
+/** Return the number of online cores, used as the default thread count */
+unsigned sim_default_threads (void)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (unsigned) cores : 1;
+}
+
+
+/** Take the next chunk from a worker's own range:
+    @param worker the worker
+    @param chunk where to place the chunk index
+    @return 1 if a chunk was taken, else 0 */
+static int take_own (Worker* worker, uint64_t* chunk)
+{
+    int taken = 0;
+    pthread_mutex_lock(&worker->lock);
+    if (worker->begin < worker->end) {
+        *chunk = worker->begin;
+        __atomic_store_n(&worker->begin, *chunk + 1, __ATOMIC_RELAXED);
+        taken = 1;
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return taken;
+}
+
+
+/** Move the back half of the busiest other worker's range to this worker:
+    @param worker the idle worker
+    @return 1 if work was stolen, 0 if every worker is out of work */
+static int steal (Worker* worker)
+{
+    Worker* victim = NULL;
+    uint64_t most = 0;
+    for (unsigned i = 0; i < worker->num_workers; i++) {
+        Worker* other = &worker->pool[i];
+        // unlocked read is only a hint, it is checked again under the lock. Every store
+        // is atomic too, so the hint never races with the owner's update
+        uint64_t remaining = __atomic_load_n(&other->end, __ATOMIC_RELAXED)
+                             - __atomic_load_n(&other->begin, __ATOMIC_RELAXED);
+        if (other != worker && remaining > most && remaining < UINT64_MAX / 2) {
+            most = remaining;
+            victim = other;
+        }
+    }
+    if (!victim) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&victim->lock);
+    uint64_t remaining = victim->end - victim->begin;
+    uint64_t take = (remaining + 1) / 2;
+    uint64_t end = victim->end;
+    __atomic_store_n(&victim->end, end - take, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&victim->lock);
+
+    pthread_mutex_lock(&worker->lock);
+    __atomic_store_n(&worker->begin, end - take, __ATOMIC_RELAXED);
+    __atomic_store_n(&worker->end, end, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&worker->lock);
+    // the victim may have emptied meanwhile, the caller simply tries again
+    return 1;
+}
+
+
+/** Worker loop: run own chunks, then steal until no worker has any left:
+    @param arg pointer to this thread's Worker */
+static void* run_worker (void* arg)
+{
+    Worker* worker = arg;
+    uint64_t chunk;
+    do {
+        while (take_own(worker, &chunk)) {
+            worker->func(worker->context, worker->accumulator, chunk);
+        }
+    } while (steal(worker));
+    return NULL;
+}
+
+
+/** Run every chunk in [0, num_chunks) across a work-stealing pool of threads. Each thread
+    gets its own zeroed accumulator slot, starting on a cache line of its own, and the
+    slots are merged into the total in thread order once every chunk has run:
+    @param num_chunks number of chunks of work
+    @param num_threads number of worker threads to use
+    @param func function run for each chunk
+    @param context passed unchanged to every call of func
+    @param accumulator_size size of one accumulator slot in bytes
+    @param merge function adding one slot into the total
+    @param total merged results, as set up by the caller before the first merge */
+void sim_parallel_for (uint64_t num_chunks, unsigned num_threads, SimChunkFunc func, void* context,
+                       size_t accumulator_size, SimMergeFunc merge, void* total)
+{
+    pthread_t* threads = calloc(num_threads, sizeof(pthread_t));
+    Worker* workers = calloc(num_threads, sizeof(Worker));
+    // rounding each slot up to whole cache lines keeps one thread's writes off the next slot's lines
+    size_t stride = (accumulator_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    char* slots = aligned_alloc(CACHE_LINE, num_threads * stride);
+    memset(slots, 0, num_threads * stride);
+
+    for (unsigned i = 0; i < num_threads; i++) {
+        pthread_mutex_init(&workers[i].lock, NULL);
+        workers[i].begin = num_chunks * i / num_threads;
+        workers[i].end = num_chunks * (i + 1) / num_threads;
+        workers[i].pool = workers;
+        workers[i].num_workers = num_threads;
+        workers[i].func = func;
+        workers[i].context = context;
+        workers[i].accumulator = slots + i * stride;
+    }
+    // the calling thread acts as worker 0
+    for (unsigned i = 1; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, run_worker, &workers[i]);
+    }
+    run_worker(&workers[0]);
+    for (unsigned i = 1; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (unsigned i = 0; i < num_threads; i++) {
+        pthread_mutex_destroy(&workers[i].lock);
+        merge(total, slots + i * stride);
+    }
+    free(slots);
+    free(workers);
+    free(threads);
+}
+
+
+/** Parse a count such as "1000000", "1e9" or "2G":
+    @param text the string to parse
+    @param value where to place the parsed value
+    @return 1 on success, else 0 */
+int sim_parse_count (const char* text, uint64_t* value)
+{
+    char* end;
+    double parsed = strtod(text, &end);
+    switch (*end) {
+        case 'k': case 'K': parsed *= 1e3; end++; break;
+        case 'M': parsed *= 1e6; end++; break;
+        case 'G': parsed *= 1e9; end++; break;
+    }
+    if (end == text || *end != '\0' || parsed < 0 || parsed > 1.8e19) {
+        return 0;
+    }
+    *value = (uint64_t) parsed;
+    return 1;
+}
@@ -0,0 +1,83 @@
+/** @file sim_util.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief shared helpers for the host-side simulation tools
+ */
+
+
+#ifndef SIM_UTIL_H
+#define SIM_UTIL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/** xoshiro256** generator state. Every chunk of work seeds its own generator
+    from (seed, stream) so results do not depend on the number of threads */
+typedef struct {
+    uint64_t s[4];
+} SimRng;
+
+
+/** Function run once per chunk of work:
+    @param context shared read-only data for the run
+    @param accumulator per-thread results slot for the thread running this chunk
+    @param chunk index of the chunk to run */
+typedef void (*SimChunkFunc) (void* context, void* accumulator, uint64_t chunk);
+
+
+/** Function that adds one thread's results into the total once every chunk has run:
+    @param total merged results
+    @param accumulator one thread's results slot */
+typedef void (*SimMergeFunc) (void* total, const void* accumulator);
+
+
+/** Seed a generator for an independent stream:
+    @param rng pointer to generator being seeded
+    @param seed run seed given on the command line
+    @param stream index of the stream (eg sweep point and chunk number) */
+void sim_rng_seed (SimRng* rng, uint64_t seed, uint64_t stream);
+
+
+/** Return the next 64 random bits:
+    @param rng pointer to generator */
+uint64_t sim_rng_next (SimRng* rng);
+
+
+/** Return a uniformly distributed double in [0, 1):
+    @param rng pointer to generator */
+double sim_rng_uniform (SimRng* rng);
+
+
+/** Return a uniformly distributed integer in [0, bound):
+    @param rng pointer to generator
+    @param bound exclusive upper limit, must be non-zero */
+uint32_t sim_rng_below (SimRng* rng, uint32_t bound);
+
+
+/** Return the number of online cores, used as the default thread count */
+unsigned sim_default_threads (void);
+
+
+/** Run every chunk in [0, num_chunks) across a work-stealing pool of threads. Each thread
+    gets its own zeroed accumulator slot, starting on a cache line of its own, and the
+    slots are merged into the total in thread order once every chunk has run:
+    @param num_chunks number of chunks of work
+    @param num_threads number of worker threads to use
+    @param func function run for each chunk
+    @param context passed unchanged to every call of func
+    @param accumulator_size size of one accumulator slot in bytes
+    @param merge function adding one slot into the total
+    @param total merged results, as set up by the caller before the first merge */
+void sim_parallel_for (uint64_t num_chunks, unsigned num_threads, SimChunkFunc func, void* context,
+                       size_t accumulator_size, SimMergeFunc merge, void* total);
+
+
+/** Parse a count such as "1000000", "1e9" or "2G":
+    @param text the string to parse
+    @param value where to place the parsed value
+    @return 1 on success, else 0 */
+int sim_parse_count (const char* text, uint64_t* value);
+
+
+#endif
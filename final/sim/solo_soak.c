@@ -0,0 +1,178 @@
+/** @file solo_soak.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief soak test of single player mode: one virtual kit against its own AI, many games in parallel
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_bot.h"
+#include "sim_kit.h"
+#include "sim_util.h"
+#include "navswitch.h"
+#include "pong_display.h"
+
+#define DEFAULT_GAMES 2000
+#define DEFAULT_SEED 260
+#define DEFAULT_MISS 0.1
+#define GAME_TIMEOUT (600 * PACER_RATE) //ticks before a game counts as stalled
+#define MAX_MENU_DELAY 256 //extra ticks the bot may wait on the menu, which seeds the AI
+#define POINTS_TO_WIN 3
+
+
+/** Read-only run settings */
+typedef struct {
+    uint64_t games;
+    uint64_t seed;
+    double miss_rate;
+    uint8_t level;
+} Run;
+
+
+/** Per-thread results, merged at the end */
+typedef struct {
+    uint64_t games;
+    uint64_t player_wins;
+    uint64_t ai_wins;
+    uint64_t stalls;
+    uint64_t points;
+    uint64_t player_returns;
+    uint64_t ai_returns;
+    uint64_t ticks;
+} Stats;
+
+
+/** Play one game from power on to the game over screen:
+    @param run run settings
+    @param index game number, used as the random stream
+    @param stats where to count the results */
+static void play_game (const Run* run, uint64_t index, Stats* stats)
+{
+    SimKit kit;
+    SimWorld world = {&kit, 1, NULL, 0, 0};
+    SimBot bot;
+    SimRng rng;
+    uint8_t player_on_screen = 0;
+    uint8_t ai_on_screen = 0;
+    uint8_t previous_mode = START_MENU;
+
+    sim_rng_seed(&rng, run->seed, index);
+    uint32_t menu_ticks = SIM_BOT_START_DELAY + sim_rng_below(&rng, MAX_MENU_DELAY);
+    uint8_t player_serves = sim_rng_below(&rng, 2);
+    sim_bot_init(&bot, run->miss_rate, run->seed, index);
+    sim_kit_init(&kit, 0, sim_firmware_loop);
+    sim_world_step(&world); //run up to the first pacer wait
+
+    while (kit.game.game_mode != GAME_OVER_MODE && world.tick < GAME_TIMEOUT) {
+        if (kit.game.game_mode == START_MENU) {
+            if (world.tick == menu_ticks) {
+                kit.game.ai.level = run->level;
+                kit.nav_pending |= 1 << NAVSWITCH_EAST;
+            }
+        } else {
+            sim_bot_input(&bot, &kit, 0, player_serves);
+        }
+        sim_world_step(&world);
+
+        // apart from a serve, a ball appearing on either half is a return by the other side
+        uint8_t mode = kit.game.game_mode;
+        if (mode == PLAY_MODE && previous_mode == PLAY_MODE) {
+            stats->ai_returns += kit.ball.on_screen && !player_on_screen;
+            stats->player_returns += kit.game.ai.ball.on_screen && !ai_on_screen;
+        }
+        previous_mode = mode;
+        player_on_screen = kit.ball.on_screen;
+        ai_on_screen = kit.game.ai.ball.on_screen;
+    }
+
+    if (kit.game.game_mode != GAME_OVER_MODE) {
+        stats->stalls++;
+    } else if (kit.game.score - '0' == POINTS_TO_WIN) {
+        stats->player_wins++;
+    } else {
+        stats->ai_wins++;
+    }
+    stats->points += kit.game.score - '0' + kit.game.opponent_score - '0';
+    stats->ticks += world.tick;
+    stats->games++;
+    sim_kit_free(&kit);
+}
+
+
+/** Play one game per chunk:
+    @param context the Run
+    @param accumulator this thread's Stats
+    @param chunk game number */
+static void run_chunk (void* context, void* accumulator, uint64_t chunk)
+{
+    play_game(context, chunk, accumulator);
+}
+
+
+/** Add one thread's counts into the total. Every field is a count, so the slots can be summed word by word:
+    @param total the total Stats
+    @param accumulator one thread's Stats */
+static void merge_stats (void* total, const void* accumulator)
+{
+    const uint64_t* from = accumulator;
+    uint64_t* to = total;
+    for (size_t j = 0; j < sizeof(Stats) / sizeof(uint64_t); j++) {
+        to[j] += from[j];
+    }
+}
+
+
+static void usage (const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -n games    games to play (default %d)\n"
+        "  -l level    AI level: 0 easy, 1 normal, 2 hard (default %d)\n"
+        "  -m rate     probability the scripted player misses the ball (default %g)\n"
+        "  -s seed     random seed (default %d)\n"
+        "  -t threads  worker threads (default: number of cores)\n",
+        program, DEFAULT_GAMES, AI_LEVEL, DEFAULT_MISS, DEFAULT_SEED);
+}
+
+
+int main (int argc, char* argv[])
+{
+    Run run = {DEFAULT_GAMES, DEFAULT_SEED, DEFAULT_MISS, AI_LEVEL};
+    unsigned num_threads = sim_default_threads();
+    uint64_t value;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:l:m:s:t:h")) != -1) {
+        int ok = 1;
+        switch (opt) {
+            case 'n' : ok = sim_parse_count(optarg, &run.games) && run.games; break;
+            case 'l' : run.level = atoi(optarg); ok = run.level <= AI_HARD; break;
+            case 'm' : run.miss_rate = atof(optarg); break;
+            case 's' : run.seed = strtoull(optarg, NULL, 0); break;
+            case 't' : ok = sim_parse_count(optarg, &value) && value; num_threads = value; break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    Stats total;
+    memset(&total, 0, sizeof(total));
+    sim_parallel_for(run.games, num_threads, run_chunk, &run, sizeof(Stats), merge_stats, &total);
+
+    double games = total.games;
+    printf("%llu single player games, AI level %u, player miss rate %g\n",
+           (unsigned long long) total.games, run.level, run.miss_rate);
+    printf("player won %.1f%%, AI won %.1f%%, stalled %llu\n", 100 * total.player_wins / games,
+           100 * total.ai_wins / games, (unsigned long long) total.stalls);
+    printf("per game: %.2f points, %.1f player returns, %.1f AI returns, %.1f s\n", total.points / games,
+           total.player_returns / games, total.ai_returns / games, total.ticks / games / PACER_RATE);
+    return total.stalls != 0;
+}
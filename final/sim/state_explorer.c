@@ -0,0 +1,455 @@
+/** @file state_explorer.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief exhaustive parallel search of every ball and paddle state reachable through update_location
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ball.h"
+#include "paddle.h"
+#include "sim_util.h"
+
+// packed state: x in bits 0-2, y in 3-5, direction_x + 1 in 6-7, direction_y == UP in 8, paddle in 9-11
+#define X_SHIFT 0
+#define Y_SHIFT 3
+#define DX_SHIFT 6
+#define DY_SHIFT 8
+#define PADDLE_SHIFT 9
+#define FIELD_MASK 7
+#define DX_MASK 3
+#define NUM_STATES (1 << 12) //every encoding, valid or not
+#define NUM_WORDS (NUM_STATES / 64)
+#define MAX_OOB_LISTED 32
+
+// where a single step leads
+#define STEP_STATE 0 //ball still on this half
+#define STEP_HANDOFF 1 //ball left the top of the screen
+#define STEP_DEAD 2 //ball hit the ground
+#define STEP_OOB 3 //coordinates left the grid
+
+
+/** Read-only data shared by the workers for one pass */
+typedef struct {
+    uint64_t valid[NUM_WORDS]; //encodings that describe a real state
+    uint64_t from[NUM_WORDS]; //states to expand this pass
+    uint64_t target[NUM_WORDS]; //set the pass is testing successors against
+    uint8_t moves; //paddle moves the player can make between ball steps
+    uint8_t pass; //which pass is running
+} Explorer;
+
+#define PASS_EXPAND 0 //collect successors of from
+#define PASS_CAN_EXIT 1 //collect states with some input reaching an exit or target
+#define PASS_MUST_EXIT 2 //collect states with every input reaching an exit or target
+
+
+/** Per-thread results for one pass */
+typedef struct {
+    uint64_t found[NUM_WORDS];
+    uint64_t transitions;
+    uint64_t handoffs;
+    uint64_t deaths;
+    uint64_t oob;
+    uint32_t oob_state[MAX_OOB_LISTED]; //first out-of-bounds transitions seen
+    uint8_t oob_paddle[MAX_OOB_LISTED];
+    Ball oob_ball[MAX_OOB_LISTED];
+} Found;
+
+
+static uint32_t pack (const Ball* ball, uint8_t paddle)
+{
+    return ball->x << X_SHIFT | ball->y << Y_SHIFT | (ball->direction_x + 1) << DX_SHIFT
+           | (ball->direction_y == UP) << DY_SHIFT | paddle << PADDLE_SHIFT;
+}
+
+
+static void unpack (uint32_t state, Ball* ball, uint8_t* paddle)
+{
+    ball_init(ball, state >> X_SHIFT & FIELD_MASK, state >> Y_SHIFT & FIELD_MASK,
+              (int8_t) (state >> DX_SHIFT & DX_MASK) - 1, state >> DY_SHIFT & 1 ? UP : DOWN, ON_SCREEN);
+    *paddle = state >> PADDLE_SHIFT & FIELD_MASK;
+}
+
+
+/** Return 1 if an encoding describes a ball on screen with the paddle on the grid */
+static int is_valid (uint32_t state)
+{
+    Ball ball;
+    uint8_t paddle;
+    unpack(state, &ball, &paddle);
+    return ball.x <= RIGHT_WALL && ball.y < HEIGHT && ball.direction_x <= RIGHT && paddle <= PADDLE_LIMIT_RIGHT;
+}
+
+
+/** Apply one player input and one ball step:
+    @param state state before the step
+    @param paddle_to column the player steers the paddle towards
+    @param moves paddle moves allowed before the ball steps
+    @param next where to place the state after the step
+    @param ball where to place the ball after the step
+    @param paddle_used where to place the paddle position the ball met
+    @return one of the STEP_ outcomes */
+static uint8_t step (uint32_t state, uint8_t paddle_to, uint8_t moves, uint32_t* next, Ball* ball,
+                     uint8_t* paddle_used)
+{
+    Paddle paddle;
+    unpack(state, ball, &paddle.pos);
+    for (uint8_t i = 0; i < moves && paddle.pos != paddle_to; i++) {
+        if (paddle.pos < paddle_to) {
+            paddle_move_right(&paddle);
+        } else {
+            paddle_move_left(&paddle);
+        }
+    }
+    *paddle_used = paddle.pos;
+    update_location(ball, paddle.pos);
+
+    if (ball->dead) {
+        return STEP_DEAD;
+    }
+    if (ball->x > RIGHT_WALL || ball->y > HEIGHT) {
+        return STEP_OOB;
+    }
+    if (!ball->on_screen) {
+        return STEP_HANDOFF;
+    }
+    *next = pack(ball, paddle.pos);
+    return STEP_STATE;
+}
+
+
+static int test_bit (const uint64_t set[], uint32_t state)
+{
+    return set[state / 64] >> (state % 64) & 1;
+}
+
+
+static void set_bit (uint64_t set[], uint32_t state)
+{
+    set[state / 64] |= 1ULL << (state % 64);
+}
+
+
+static uint32_t count_bits (const uint64_t set[])
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < NUM_WORDS; i++) {
+        count += __builtin_popcountll(set[i]);
+    }
+    return count;
+}
+
+
+/** Run one pass over the 64 states in a word of the from set:
+    @param context the Explorer
+    @param accumulator this thread's Found
+    @param chunk word index */
+static void run_word (void* context, void* accumulator, uint64_t chunk)
+{
+    const Explorer* explorer = context;
+    Found* found = accumulator;
+    uint64_t word = explorer->from[chunk];
+
+    while (word) {
+        uint32_t state = chunk * 64 + __builtin_ctzll(word);
+        uint8_t any = 0;
+        uint8_t all = 1;
+        word &= word - 1;
+
+        for (uint8_t input = PADDLE_LIMIT_LEFT; input <= PADDLE_LIMIT_RIGHT; input++) {
+            uint32_t next = 0;
+            uint8_t paddle;
+            Ball ball;
+            uint8_t outcome = step(state, input, explorer->moves, &next, &ball, &paddle);
+            uint8_t exits = outcome == STEP_HANDOFF || outcome == STEP_DEAD
+                            || (outcome == STEP_STATE && test_bit(explorer->target, next));
+            any |= exits;
+            all &= exits;
+
+            if (explorer->pass != PASS_EXPAND) {
+                continue;
+            }
+            found->transitions++;
+            if (outcome == STEP_STATE) {
+                set_bit(found->found, next);
+            } else if (outcome == STEP_HANDOFF) {
+                found->handoffs++;
+            } else if (outcome == STEP_DEAD) {
+                found->deaths++;
+            } else {
+                if (found->oob < MAX_OOB_LISTED) {
+                    found->oob_state[found->oob] = state;
+                    found->oob_paddle[found->oob] = paddle;
+                    found->oob_ball[found->oob] = ball;
+                }
+                found->oob++;
+            }
+        }
+        if ((explorer->pass == PASS_CAN_EXIT && any) || (explorer->pass == PASS_MUST_EXIT && all)) {
+            set_bit(found->found, state);
+        }
+    }
+}
+
+
+/** Add one thread's results into the pass total:
+    @param total the total Found
+    @param accumulator one thread's Found */
+static void merge_found (void* total, const void* accumulator)
+{
+    Found* to = total;
+    const Found* from = accumulator;
+    for (uint32_t i = 0; i < NUM_WORDS; i++) {
+        to->found[i] |= from->found[i];
+    }
+    for (uint64_t i = 0; i < from->oob && to->oob + i < MAX_OOB_LISTED && i < MAX_OOB_LISTED; i++) {
+        to->oob_state[to->oob + i] = from->oob_state[i];
+        to->oob_paddle[to->oob + i] = from->oob_paddle[i];
+        to->oob_ball[to->oob + i] = from->oob_ball[i];
+    }
+    to->transitions += from->transitions;
+    to->handoffs += from->handoffs;
+    to->deaths += from->deaths;
+    to->oob += from->oob;
+}
+
+
+/** Run a pass over every state in explorer->from and merge the threads' results:
+    @param explorer pass settings
+    @param num_threads number of worker threads
+    @param total where to place merged results */
+static void run_pass (Explorer* explorer, unsigned num_threads, Found* total)
+{
+    memset(total, 0, sizeof(Found));
+    sim_parallel_for(NUM_WORDS, num_threads, run_word, explorer, sizeof(Found), merge_found, total);
+}
+
+
+/** Grow a set to its fixed point under a backward pass, eg every state that can reach an exit:
+    @param explorer explorer, its from set is overwritten
+    @param pass PASS_CAN_EXIT or PASS_MUST_EXIT
+    @param num_threads number of worker threads
+    @param set the set to grow, starts empty */
+static uint32_t fixed_point (Explorer* explorer, uint8_t pass, unsigned num_threads, uint64_t set[])
+{
+    Found total;
+    uint32_t rounds = 0;
+    explorer->pass = pass;
+    memset(set, 0, NUM_WORDS * sizeof(uint64_t));
+    while (1) {
+        // only states not yet in the set need testing again
+        for (uint32_t i = 0; i < NUM_WORDS; i++) {
+            explorer->from[i] = explorer->valid[i] & ~set[i];
+            explorer->target[i] = set[i];
+        }
+        run_pass(explorer, num_threads, &total);
+        rounds++;
+        if (!count_bits(total.found)) {
+            return rounds;
+        }
+        for (uint32_t i = 0; i < NUM_WORDS; i++) {
+            set[i] |= total.found[i];
+        }
+    }
+}
+
+
+static void print_state (uint32_t state)
+{
+    Ball ball;
+    uint8_t paddle;
+    unpack(state, &ball, &paddle);
+    printf("x=%u y=%u dx=%+d dy=%+d paddle=%u", ball.x, ball.y, ball.direction_x, ball.direction_y, paddle);
+}
+
+
+/** Print a set of states, up to a limit:
+    @param title heading
+    @param set the states
+    @param limit most states to list */
+static void print_set (const char* title, const uint64_t set[], uint32_t limit)
+{
+    uint32_t count = count_bits(set);
+    uint32_t listed = 0;
+    printf("%s: %u\n", title, count);
+    for (uint32_t state = 0; state < NUM_STATES && listed < limit; state++) {
+        if (test_bit(set, state)) {
+            printf("    ");
+            print_state(state);
+            printf("\n");
+            listed++;
+        }
+    }
+    if (count > listed && limit) {
+        printf("    ... %u more\n", count - listed);
+    }
+}
+
+
+static void usage (const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -m moves    paddle moves between ball steps (default %u, ie any column)\n"
+        "  -t threads  worker threads (default: number of cores)\n"
+        "  -o file     write the reachability table as CSV\n"
+        "  -v          list every state in each category\n",
+        program, PADDLE_LIMIT_RIGHT - PADDLE_LIMIT_LEFT);
+}
+
+
+int main (int argc, char* argv[])
+{
+    Explorer explorer;
+    unsigned num_threads = sim_default_threads();
+    const char* csv_name = NULL;
+    uint32_t limit = 8;
+    uint64_t value;
+    int opt;
+
+    memset(&explorer, 0, sizeof(explorer));
+    explorer.moves = PADDLE_LIMIT_RIGHT - PADDLE_LIMIT_LEFT;
+    while ((opt = getopt(argc, argv, "m:t:o:vh")) != -1) {
+        switch (opt) {
+            case 'm' : explorer.moves = atoi(optarg); break;
+            case 't' :
+                if (!sim_parse_count(optarg, &value) || !value) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                num_threads = value;
+                break;
+            case 'o' : csv_name = optarg; break;
+            case 'v' : limit = NUM_STATES; break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+
+    struct timespec begin, finish;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    static uint16_t depth[NUM_STATES];
+    uint64_t reached[NUM_WORDS] = {0};
+    uint64_t roots[NUM_WORDS] = {0};
+    Found total;
+    Found sweep;
+    uint64_t transitions = 0;
+    uint64_t handoffs = 0;
+    uint64_t deaths = 0;
+    uint64_t oob = 0;
+
+    for (uint32_t state = 0; state < NUM_STATES; state++) {
+        if (is_valid(state)) {
+            set_bit(explorer.valid, state);
+        }
+    }
+
+    // roots: a serve from any paddle position as game.c fires it, and any ball receive_ball can place
+    for (uint8_t paddle = PADDLE_LIMIT_LEFT; paddle <= PADDLE_LIMIT_RIGHT; paddle++) {
+        Ball ball;
+        ball_init(&ball, paddle, GROUND + 1, STRAIGHT, UP, ON_SCREEN);
+        set_bit(roots, pack(&ball, paddle));
+        for (uint8_t x = LEFT_WALL; x <= RIGHT_WALL; x++) {
+            for (int8_t dx = LEFT; dx <= RIGHT; dx++) {
+                ball_init(&ball, x, HEIGHT - 1, dx, DOWN, ON_SCREEN);
+                set_bit(roots, pack(&ball, paddle));
+            }
+        }
+    }
+
+    // level-synchronous BFS: each level's frontier is split by 64-state word across the pool
+    uint32_t levels[NUM_STATES];
+    uint32_t num_levels = 0;
+    memcpy(explorer.from, roots, sizeof(roots));
+    memcpy(reached, roots, sizeof(roots));
+    explorer.pass = PASS_EXPAND;
+    while (count_bits(explorer.from)) {
+        levels[num_levels] = count_bits(explorer.from);
+        run_pass(&explorer, num_threads, &total);
+        transitions += total.transitions;
+        handoffs += total.handoffs;
+        deaths += total.deaths;
+        oob += total.oob;
+        for (uint32_t i = 0; i < NUM_WORDS; i++) {
+            explorer.from[i] = total.found[i] & ~reached[i];
+            reached[i] |= explorer.from[i];
+        }
+        for (uint32_t state = 0; state < NUM_STATES; state++) {
+            if (test_bit(explorer.from, state)) {
+                depth[state] = num_levels + 1;
+            }
+        }
+        num_levels++;
+    }
+
+    // one more expansion over every valid state, reachable or not, to catch out-of-bounds steps anywhere
+    memcpy(explorer.from, explorer.valid, sizeof(explorer.valid));
+    run_pass(&explorer, num_threads, &sweep);
+
+    uint64_t can_exit[NUM_WORDS];
+    uint64_t must_exit[NUM_WORDS];
+    uint32_t can_rounds = fixed_point(&explorer, PASS_CAN_EXIT, num_threads, can_exit);
+    uint32_t must_rounds = fixed_point(&explorer, PASS_MUST_EXIT, num_threads, must_exit);
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+
+    uint64_t unreachable[NUM_WORDS];
+    uint64_t stuck[NUM_WORDS];
+    uint64_t looping[NUM_WORDS];
+    for (uint32_t i = 0; i < NUM_WORDS; i++) {
+        unreachable[i] = explorer.valid[i] & ~reached[i];
+        stuck[i] = reached[i] & ~can_exit[i];
+        looping[i] = reached[i] & ~must_exit[i];
+    }
+
+    printf("%u encodings, %u valid states, %u roots, paddle moves per step %u, %u threads\n",
+           NUM_STATES, count_bits(explorer.valid), count_bits(roots), explorer.moves, num_threads);
+    printf("explored in %.3f ms: %u BFS levels, %u + %u fixed point rounds\n",
+           (finish.tv_sec - begin.tv_sec) * 1e3 + (finish.tv_nsec - begin.tv_nsec) * 1e-6,
+           num_levels, can_rounds, must_rounds);
+    printf("\nfrontier per level:");
+    for (uint32_t i = 0; i < num_levels; i++) {
+        printf(" %u", levels[i]);
+    }
+    printf("\nreachable states: %u\n", count_bits(reached));
+    printf("transitions from reachable states: %llu (%llu hand off, %llu die, %llu out of bounds)\n",
+           (unsigned long long) transitions, (unsigned long long) handoffs,
+           (unsigned long long) deaths, (unsigned long long) oob);
+    print_set("unreachable states", unreachable, limit);
+    print_set("reachable states with no way to exit (stuck forever)", stuck, limit);
+    print_set("reachable states where some inputs can keep the ball on this half forever", looping, limit);
+
+    printf("out of bounds transitions over all valid states: %llu\n", (unsigned long long) sweep.oob);
+    for (uint64_t i = 0; i < sweep.oob && i < MAX_OOB_LISTED; i++) {
+        const Ball* ball = &sweep.oob_ball[i];
+        printf("    %s ", test_bit(reached, sweep.oob_state[i]) ? "reachable  " : "unreachable");
+        print_state(sweep.oob_state[i]);
+        printf(", paddle met at %u -> x=%u y=%u\n", sweep.oob_paddle[i], ball->x, ball->y);
+    }
+
+    if (csv_name) {
+        FILE* csv = fopen(csv_name, "w");
+        if (!csv) {
+            perror(csv_name);
+            return 1;
+        }
+        fprintf(csv, "x,y,dx,dy,paddle,reachable,depth,can_exit,must_exit\n");
+        for (uint32_t state = 0; state < NUM_STATES; state++) {
+            if (test_bit(explorer.valid, state)) {
+                Ball ball;
+                uint8_t paddle;
+                unpack(state, &ball, &paddle);
+                fprintf(csv, "%u,%u,%d,%d,%u,%d,%d,%d,%d\n", ball.x, ball.y, ball.direction_x,
+                        ball.direction_y, paddle, test_bit(reached, state),
+                        test_bit(reached, state) ? depth[state] : -1, test_bit(can_exit, state),
+                        test_bit(must_exit, state));
+            }
+        }
+        fclose(csv);
+    }
+    return sweep.oob || count_bits(stuck) ? 2 : 0;
+}
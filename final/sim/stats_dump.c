@@ -0,0 +1,166 @@
+/** @file stats_dump.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief decode the match statistics log from a dumped EEPROM image
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+#include "stats_log.h"
+#include "eeprom_async.h"
+
+#define EEPROM_ERASED 0xFF
+#define ENDURANCE 100000 //write cycles each EEPROM cell is rated for
+
+
+/* The image is read with the same scan the firmware runs at power on, over
+ * an EEPROM stand-in holding the dumped bytes, so the totals printed are the
+ * ones the kit will carry on from. Every slot is listed too: valid records
+ * with their totals, erased slots, and slots whose CRC fails, which is what
+ * a write cut short by a power loss leaves behind. */
+
+
+static uint8_t image[EEPROM_SIZE];
+
+
+void eeprom_async_init (void)
+{
+}
+
+
+void eeprom_async_read (uint16_t address, uint8_t data[], uint8_t length)
+{
+    memcpy(data, image + address, length);
+}
+
+
+uint8_t eeprom_async_write (uint16_t address, const uint8_t data[], uint8_t length)
+{
+    memcpy(image + address, data, length);
+    return 1;
+}
+
+
+uint8_t eeprom_async_busy (void)
+{
+    return 0;
+}
+
+
+/** Load an image, leaving anything past its end erased:
+    @param path file written by dfu-programmer dump-eeprom
+    @return 1 if it was read, else 0 */
+static int load_image (const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return 0;
+    }
+    memset(image, EEPROM_ERASED, sizeof(image));
+    size_t length = fread(image, 1, sizeof(image), file);
+    fclose(file);
+    if (length < STATS_BASE + STATS_SLOTS * STATS_RECORD_SIZE) {
+        fprintf(stderr, "%s: only %zu bytes, the rest is taken as erased\n", path, length);
+    }
+    return 1;
+}
+
+
+/** Print one slot of the log:
+    @param slot slot number
+    @param newest slot the firmware would carry on from */
+static void print_slot (uint8_t slot, uint8_t newest)
+{
+    const uint8_t* record = image + STATS_BASE + slot * STATS_RECORD_SIZE;
+    StatsLog log;
+    uint8_t erased = 1;
+    for (uint8_t i = 0; i < STATS_RECORD_SIZE; i++) {
+        erased &= record[i] == EEPROM_ERASED;
+    }
+
+    printf("%4u  ", slot);
+    if (stats_log_unpack(&log, record)) {
+        printf("%6u %6u %6u %7u %7u %6u %6u%s\n", log.seq, log.wins, log.losses, log.rallies,
+               log.returns, log.longest_rally, log.link_errors, slot == newest ? "  <- newest" : "");
+    } else if (erased) {
+        printf("  erased\n");
+    } else {
+        printf("  corrupt:");
+        for (uint8_t i = 0; i < STATS_RECORD_SIZE; i++) {
+            printf(" %02x", record[i]);
+        }
+        printf("\n");
+    }
+}
+
+
+static void usage (const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options] image\n"
+        "  image is the EEPROM read with dfu-programmer atmega32u2 dump-eeprom\n"
+        "  -a          list erased slots as well\n",
+        program);
+}
+
+
+int main (int argc, char* argv[])
+{
+    int all = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "ah")) != -1) {
+        switch (opt) {
+            case 'a' : all = 1; break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    if (argc - optind != 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!load_image(argv[optind])) {
+        return 1;
+    }
+
+    StatsLog log;
+    stats_log_init(&log);
+
+    printf("slot     seq   wins losses rallies returns  longest  link errors\n");
+    uint8_t valid = 0;
+    uint8_t corrupt = 0;
+    for (uint8_t slot = 0; slot < STATS_SLOTS; slot++) {
+        StatsLog record;
+        const uint8_t* bytes = image + STATS_BASE + slot * STATS_RECORD_SIZE;
+        if (stats_log_unpack(&record, bytes)) {
+            valid++;
+        } else if (bytes[0] != EEPROM_ERASED || memcmp(bytes, bytes + 1, STATS_RECORD_SIZE - 1)) {
+            corrupt++;
+        } else if (!all) {
+            continue;
+        }
+        print_slot(slot, log.slot);
+    }
+
+    printf("\n%u valid, %u corrupt, %u erased of %u slots\n", valid, corrupt,
+           STATS_SLOTS - valid - corrupt, STATS_SLOTS);
+    if (log.slot == STATS_NO_SLOT) {
+        printf("no games recorded\n");
+        return 0;
+    }
+    uint16_t games = log.wins + log.losses;
+    printf("games %u: won %u, lost %u\n", games, log.wins, log.losses);
+    printf("rallies %u, %.2f returns each, longest %u\n", log.rallies,
+           log.rallies ? (double) log.returns / log.rallies : 0.0, log.longest_rally);
+    printf("link errors %u, %.2f a game\n", log.link_errors, games ? (double) log.link_errors / games : 0.0);
+    // records are written one per game, round the slots in turn
+    printf("wear: %u records written, about %u per slot, %.3f%% of rated endurance\n", log.seq,
+           (log.seq + STATS_SLOTS - 1) / STATS_SLOTS,
+           100.0 * ((log.seq + STATS_SLOTS - 1) / STATS_SLOTS) / ENDURANCE);
+    return 0;
+}
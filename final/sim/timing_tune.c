@@ -0,0 +1,579 @@
+/** @file timing_tune.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief sweep the timing constants in timing.h through simulated matches and list the Pareto-optimal settings
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_bot.h"
+#include "sim_energy.h"
+#include "sim_kit.h"
+#include "sim_util.h"
+#include "pong_display.h"
+
+#define DEFAULT_GAMES 8
+#define DEFAULT_SEED 260
+#define DEFAULT_MISS 0.1
+#define DEFAULT_BAUD 2400
+#define DEFAULT_TOLERANCE 10.0 //percent the serve speed, score screen and scroll speed may move
+#define GAME_TIMEOUT (600 * PACER_RATE) //ticks before a game counts as stalled
+#define NUM_PARAMS 5
+#define MAX_VALUES 256
+#define COUNTER_MAX 254 //largest value an 8 bit counter can be compared against and still pass
+#define NO_TICK UINT64_MAX
+#define MS_PER_S 1000.0
+#define GLYPH_PITCH 6 //5x7 characters are five columns and a gap wide
+
+
+/* Each combination of settings is run as matches between two bots, at the
+ * same seeds for every combination so their differences are not noise. The
+ * kits read the settings from the thread-local Timing in timing.h. Scores:
+ *
+ * flicker: the longest time a display column went unlit during play. A frame
+ *     takes 5 ticks, more when a kit stalls waiting in ir_uart_getc.
+ * input latency: from a navswitch press until the paddle column is next
+ *     driven. A press is read on the tick after it lands, half a tick later
+ *     on average, and is shown the next time the loop drives that column.
+ *     Every tick of play is taken as a possible press: the bots move on a
+ *     fixed beat, which would always catch the display at the same column.
+ * handoff latency: from the ball leaving one kit to appearing on the other.
+ * CPU headroom: the share of the tick budget left in the busiest mode, from
+ *     the per-mode game_update cycles energy_sim uses (set them with -c).
+ * feel: how far the serve speed, score screen time and scroll speed are from
+ *     the shipped settings, which most changes to PACER_RATE upset.
+ *
+ * Combinations a counter cannot hold, that overrun the tick, or whose serve
+ * speed is beyond the tolerance are dropped before they are simulated. */
+
+
+enum {PARAM_PACER, PARAM_BALL, PARAM_DISPLAY_RATE, PARAM_DISPLAY_CYCLES, PARAM_MESSAGE};
+
+static const char* default_grids[NUM_PARAMS] = {"400,500,600,750,1000,1200", "60:200:20", "150,200,250",
+                                                "5,10,20", "8,10,12"};
+
+
+/** Why a combination was not scored */
+typedef enum {
+    POINT_SCORED,
+    POINT_LIMIT, //a value does not fit its counter
+    POINT_OVERRUN, //the busiest mode does not fit in a tick
+    POINT_SERVE, //serve speed beyond tolerance
+    POINT_FEEL, //score screen or scroll speed beyond tolerance
+    POINT_STALLED, //a match never finished
+    NUM_OUTCOMES
+} Outcome;
+
+
+/** Sums kept while one combination is simulated, then its scores */
+typedef struct {
+    Timing timing;
+    Outcome outcome;
+    uint8_t shipped;
+    uint8_t pareto;
+    uint64_t stalls;
+    uint64_t gap_max; //longest a column went unlit, in ticks
+    uint64_t gap_sum;
+    uint64_t gaps;
+    uint64_t input_sum; //twice the ticks, a press waiting on average n / 2 of the n ticks between paddle columns
+    uint64_t inputs;
+    uint64_t handoff_sum; //ticks
+    uint64_t handoffs;
+    uint64_t score_sum; //ticks on the score screen
+    uint64_t scores;
+    uint64_t scroll_period_sum; //tinygl updates per scroll step of the result message
+    uint64_t scrolls;
+
+    double refresh_hz;
+    double flicker_ms;
+    double input_ms;
+    double handoff_ms;
+    double headroom; //percent of the tick budget
+    double serve_s;
+    double score_s;
+    double scroll_cps; //characters per second
+    double feel; //percent, largest of the three changes
+} Point;
+
+
+/** What is watched on one kit between ticks */
+typedef struct {
+    uint8_t prev_mode;
+    uint8_t column; //column lit last tick
+    uint64_t last_lit[LEDMAT_COLS_NUM];
+    uint64_t paddle_lit; //tick the paddle column was last driven
+    uint8_t on_screen;
+    uint64_t handoff_start; //tick the ball left the other kit for this one
+    uint64_t score_start;
+} Probe;
+
+
+/** Read-only run settings */
+typedef struct {
+    Point* points;
+    uint64_t games;
+    uint64_t seed;
+    double miss_rate;
+    SimChannel channel;
+    SimPower power;
+    uint32_t f_cpu;
+} Run;
+
+
+/** Per-thread results, merged at the end */
+typedef struct {
+    uint64_t matches;
+    double seconds; //of play, the combinations running at different pacer rates
+} Stats;
+
+
+/** Parse a list of values, "a,b,c" or "first:last:step":
+    @param text the list
+    @param values where to place the values, MAX_VALUES long
+    @param count where to place the number of values
+    @return 1 on success, else 0 */
+static int parse_grid (const char* text, uint16_t values[], uint16_t* count)
+{
+    char* end;
+    unsigned long first = strtoul(text, &end, 0);
+    *count = 0;
+    if (*end == ':') {
+        unsigned long last = strtoul(end + 1, &end, 0);
+        unsigned long step = *end == ':' ? strtoul(end + 1, &end, 0) : 1;
+        if (*end || !step || last < first || last > UINT16_MAX || (last - first) / step >= MAX_VALUES) {
+            return 0;
+        }
+        for (unsigned long value = first; value <= last; value += step) {
+            values[(*count)++] = value;
+        }
+        return 1;
+    }
+    while (1) {
+        if (end == text || first > UINT16_MAX || *count == MAX_VALUES || (*end && *end != ',')) {
+            return 0;
+        }
+        values[(*count)++] = first;
+        if (!*end) {
+            return 1;
+        }
+        text = end + 1;
+        first = strtoul(text, &end, 0);
+    }
+}
+
+
+/** Time a served ball takes per step:
+    @param timing settings
+    @return seconds */
+static double serve_seconds (const Timing* timing)
+{
+    return (timing->ball_rate + 1.0) / timing->pacer_rate;
+}
+
+
+/** Decide whether a combination is worth simulating:
+    @param run run settings
+    @param point the combination
+    @param tolerance largest change in serve speed, as a fraction
+    @return POINT_SCORED if it is, else why not */
+static Outcome screen_point (const Run* run, Point* point, double tolerance)
+{
+    const Timing* timing = &point->timing;
+    uint32_t busiest = 0;
+    for (uint8_t mode = 0; mode < SIM_ENERGY_MODES; mode++) {
+        busiest = run->power.mode_cycles[mode] > busiest ? run->power.mode_cycles[mode] : busiest;
+    }
+    point->headroom = 100.0 * (1 - (double) busiest * timing->pacer_rate / run->f_cpu);
+    point->serve_s = serve_seconds(timing);
+
+    if (!timing->pacer_rate || !timing->message_rate || timing->ball_rate > COUNTER_MAX ||
+        timing->display_rate > COUNTER_MAX || timing->display_cycles > COUNTER_MAX) {
+        return POINT_LIMIT;
+    }
+    if (point->headroom <= 0) {
+        return POINT_OVERRUN;
+    }
+    Timing shipped = {TIMING_PACER_RATE, TIMING_BALL_RATE, TIMING_DISPLAY_RATE, TIMING_DISPLAY_CYCLES,
+                      TIMING_MESSAGE_RATE};
+    double change = point->serve_s / serve_seconds(&shipped) - 1;
+    if (change > tolerance || change < -tolerance) {
+        return POINT_SERVE;
+    }
+    return POINT_SCORED;
+}
+
+
+/** Watch one kit after a tick:
+    @param probes both kits' probes
+    @param kits both kits
+    @param side the kit to watch
+    @param tick current tick
+    @param point where to add the measurements */
+static void observe (Probe probes[], const SimKit kits[], uint8_t side, uint64_t tick, Point* point)
+{
+    Probe* probe = &probes[side];
+    const SimKit* kit = &kits[side];
+    uint8_t mode = kit->game.game_mode;
+    uint8_t column = kit->lit_column;
+    uint8_t on_screen = mode == PLAY_MODE && kit->ball.on_screen && !kit->ball.dead;
+
+    if (mode != probe->prev_mode) {
+        for (uint8_t i = 0; i < LEDMAT_COLS_NUM; i++) {
+            probe->last_lit[i] = NO_TICK;
+        }
+        probe->paddle_lit = NO_TICK;
+        if (mode == DISPLAY_SCORE_MODE) {
+            probe->score_start = tick;
+        } else if (probe->prev_mode == DISPLAY_SCORE_MODE) {
+            point->score_sum += tick - probe->score_start;
+            point->scores++;
+        }
+    } else if (mode == PLAY_MODE) {
+        // a column that is still lit has not gone dark, only a change of column is a refresh
+        if (column != probe->column && probe->last_lit[column] != NO_TICK) {
+            uint64_t gap = tick - probe->last_lit[column];
+            point->gap_sum += gap;
+            point->gaps++;
+            point->gap_max = gap > point->gap_max ? gap : point->gap_max;
+        }
+        if (column == PADDLE_COL && column != probe->column && probe->paddle_lit != NO_TICK) {
+            // presses read on each of the n ticks since wait n - 1 down to 0 ticks, plus half a tick
+            uint64_t waited = tick - probe->paddle_lit;
+            point->input_sum += waited * waited;
+            point->inputs += waited;
+        }
+        if (probe->on_screen && !kit->ball.on_screen && !kit->ball.dead) {
+            probes[1 - side].handoff_start = tick;
+        } else if (!probe->on_screen && on_screen && probe->handoff_start != NO_TICK) {
+            point->handoff_sum += tick - probe->handoff_start;
+            point->handoffs++;
+            probe->handoff_start = NO_TICK;
+        }
+    }
+    if (mode != PLAY_MODE) {
+        probe->handoff_start = NO_TICK;
+    }
+    probe->last_lit[column] = tick;
+    if (column == PADDLE_COL && column != probe->column) {
+        probe->paddle_lit = tick;
+    }
+    probe->column = column;
+    probe->prev_mode = mode;
+    probe->on_screen = on_screen;
+}
+
+
+/** Play one match between two bots, from power on until both kits show the result:
+    @param run run settings
+    @param point the combination, whose settings the thread's kits are running
+    @param index match number, the same for every combination
+    @param stats where to count the ticks played */
+static void play_match (const Run* run, Point* point, uint64_t index, Stats* stats)
+{
+    SimWorld world;
+    SimKit kits[2];
+    SimLink links[2];
+    SimBot bots[2];
+    Probe probes[2];
+    uint8_t over = 0;
+
+    memset(probes, 0, sizeof(probes));
+    sim_world_init_pair(&world, kits, links, &run->channel, run->seed + index);
+    for (uint8_t i = 0; i < 2; i++) {
+        sim_bot_init(&bots[i], run->miss_rate, run->seed, 2 * index + i);
+        probes[i].handoff_start = NO_TICK;
+        probes[i].paddle_lit = NO_TICK;
+    }
+    while (!over && world.tick < GAME_TIMEOUT) {
+        sim_bot_input(&bots[0], &kits[0], 1, index & 1);
+        sim_bot_input(&bots[1], &kits[1], 0, !(index & 1));
+        sim_world_step(&world);
+        for (uint8_t i = 0; i < 2; i++) {
+            observe(probes, kits, i, world.tick, point);
+        }
+        over = kits[0].game.game_mode == GAME_OVER_MODE && kits[1].game.game_mode == GAME_OVER_MODE;
+    }
+
+    if (over) {
+        for (uint8_t i = 0; i < 2; i++) {
+            point->scroll_period_sum += kits[i].text_period;
+            point->scrolls++;
+        }
+    } else {
+        point->stalls++;
+    }
+    stats->matches++;
+    stats->seconds += (double) world.tick / PACER_RATE;
+    for (uint8_t i = 0; i < 2; i++) {
+        sim_kit_free(&kits[i]);
+    }
+}
+
+
+/** Simulate one combination, each chunk being a different one so its sums are its own:
+    @param context the Run
+    @param accumulator this thread's Stats
+    @param chunk index of the combination */
+static void run_chunk (void* context, void* accumulator, uint64_t chunk)
+{
+    const Run* run = context;
+    Point* point = &run->points[chunk];
+    if (point->outcome != POINT_SCORED) {
+        return;
+    }
+    timing = point->timing;
+    for (uint64_t game = 0; game < run->games; game++) {
+        play_match(run, point, game, accumulator);
+    }
+
+    double ms_per_tick = MS_PER_S / timing.pacer_rate;
+    point->refresh_hz = point->gaps ? timing.pacer_rate * (double) point->gaps / point->gap_sum : 0;
+    point->flicker_ms = point->gap_max * ms_per_tick;
+    point->input_ms = point->inputs ? point->input_sum / 2.0 / point->inputs * ms_per_tick : 0;
+    point->handoff_ms = point->handoffs ? (double) point->handoff_sum / point->handoffs * ms_per_tick : 0;
+    point->score_s = point->scores ? (double) point->score_sum / point->scores / timing.pacer_rate : 0;
+    point->scroll_cps = point->scroll_period_sum ?
+        (double) timing.pacer_rate * point->scrolls / point->scroll_period_sum / GLYPH_PITCH : 0;
+    if (point->stalls) {
+        point->outcome = POINT_STALLED;
+    }
+}
+
+
+/** Add one thread's totals into the run's:
+    @param total the total Stats
+    @param accumulator one thread's Stats */
+static void merge_stats (void* total, const void* accumulator)
+{
+    Stats* to = total;
+    const Stats* from = accumulator;
+    to->matches += from->matches;
+    to->seconds += from->seconds;
+}
+
+
+/** Compare one score of two combinations, lower being better:
+    @return -1 if a is better, 1 if b is, 0 if equal */
+static int compare_score (double a, double b)
+{
+    return (a > b) - (a < b);
+}
+
+
+/** Decide whether one combination dominates another:
+    @param a combination that may dominate
+    @param b combination that may be dominated
+    @return 1 if a is no worse than b on every score and better on one */
+static int dominates (const Point* a, const Point* b)
+{
+    int better = 0;
+    int scores[] = {
+        compare_score(a->flicker_ms, b->flicker_ms),
+        compare_score(a->input_ms, b->input_ms),
+        compare_score(a->handoff_ms, b->handoff_ms),
+        compare_score(-a->headroom, -b->headroom),
+        compare_score(a->feel, b->feel),
+    };
+    for (size_t i = 0; i < sizeof(scores) / sizeof(scores[0]); i++) {
+        if (scores[i] > 0) {
+            return 0;
+        }
+        better |= scores[i] < 0;
+    }
+    return better;
+}
+
+
+/** Relative change of a measurement from the shipped settings:
+    @param value measurement
+    @param reference the shipped settings' measurement
+    @return absolute change as a fraction */
+static double change (double value, double reference)
+{
+    double fraction = reference ? value / reference - 1 : 0;
+    return fraction < 0 ? -fraction : fraction;
+}
+
+
+static void print_header (void)
+{
+    printf("  %6s %5s %5s %5s %5s  %8s %8s %8s %8s %8s  %6s %6s %6s %6s\n", "pacer", "ball", "drate",
+           "dcyc", "msg", "refresh", "flicker", "input", "handoff", "headroom", "feel", "serve", "score",
+           "scroll");
+    printf("  %6s %5s %5s %5s %5s  %8s %8s %8s %8s %8s  %6s %6s %6s %6s\n", "Hz", "ticks", "ticks", "", "",
+           "Hz", "ms", "ms", "ms", "%", "%", "ms", "s", "chr/s");
+}
+
+
+/** Print one combination's settings and scores:
+    @param point the combination
+    @param marker character to mark it with */
+static void print_point (const Point* point, char marker)
+{
+    const Timing* t = &point->timing;
+    printf("%c %6u %5u %5u %5u %5u  %8.1f %8.2f %8.2f %8.2f %8.1f  %6.1f %6.0f %6.2f %6.2f\n",
+           marker, t->pacer_rate, t->ball_rate, t->display_rate, t->display_cycles,
+           t->message_rate, point->refresh_hz, point->flicker_ms, point->input_ms, point->handoff_ms,
+           point->headroom, point->feel, point->serve_s * MS_PER_S, point->score_s, point->scroll_cps);
+}
+
+
+static void usage (const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  value lists are a,b,c or first:last[:step]\n"
+        "  -P list     PACER_RATE values (default %s)\n"
+        "  -B list     BALL_RATE values (default %s)\n"
+        "  -D list     DISPLAY_RATE values (default %s)\n"
+        "  -Y list     DISPLAY_CYCLES values (default %s)\n"
+        "  -M list     MESSAGE_RATE values (default %s)\n"
+        "  -g games    matches simulated for each combination (default %d)\n"
+        "  -F percent  largest change in serve speed, score screen time and scroll speed (default %g)\n"
+        "  -f hz       target board's clock (default %d)\n"
+        "  -c mode=n   game_update cycles per tick in a game mode, by number or name, from make profile\n"
+        "  -b baud     IR UART rate (default %d)\n"
+        "  -l loss     IR byte loss probability (default 0)\n"
+        "  -m rate     probability a bot misses the ball (default %g)\n"
+        "  -a          list every combination simulated, not just the Pareto set\n"
+        "  -s seed     random seed (default %d)\n"
+        "  -t threads  worker threads (default: number of cores)\n",
+        program, default_grids[0], default_grids[1], default_grids[2], default_grids[3], default_grids[4],
+        DEFAULT_GAMES, DEFAULT_TOLERANCE, F_CPU, DEFAULT_BAUD, DEFAULT_MISS, DEFAULT_SEED);
+}
+
+
+int main (int argc, char* argv[])
+{
+    Run run = {NULL, DEFAULT_GAMES, DEFAULT_SEED, DEFAULT_MISS, {DEFAULT_BAUD, 0, 0, 0, 0},
+               {0, 0, 0, 0, 0, {0}}, F_CPU};
+    uint16_t grid[NUM_PARAMS][MAX_VALUES];
+    uint16_t counts[NUM_PARAMS];
+    double tolerance = DEFAULT_TOLERANCE;
+    unsigned num_threads = sim_default_threads();
+    uint8_t all = 0;
+    uint64_t value;
+    int opt;
+
+    sim_energy_defaults(&run.power);
+    for (uint8_t i = 0; i < NUM_PARAMS; i++) {
+        parse_grid(default_grids[i], grid[i], &counts[i]);
+    }
+    while ((opt = getopt(argc, argv, "P:B:D:Y:M:g:F:f:c:b:l:m:as:t:h")) != -1) {
+        int ok = 1;
+        switch (opt) {
+            case 'P' : ok = parse_grid(optarg, grid[PARAM_PACER], &counts[PARAM_PACER]); break;
+            case 'B' : ok = parse_grid(optarg, grid[PARAM_BALL], &counts[PARAM_BALL]); break;
+            case 'D' : ok = parse_grid(optarg, grid[PARAM_DISPLAY_RATE], &counts[PARAM_DISPLAY_RATE]); break;
+            case 'Y' : ok = parse_grid(optarg, grid[PARAM_DISPLAY_CYCLES], &counts[PARAM_DISPLAY_CYCLES]); break;
+            case 'M' : ok = parse_grid(optarg, grid[PARAM_MESSAGE], &counts[PARAM_MESSAGE]); break;
+            case 'g' : ok = sim_parse_count(optarg, &run.games) && run.games; break;
+            case 'F' : tolerance = atof(optarg); ok = tolerance >= 0; break;
+            case 'f' : ok = sim_parse_count(optarg, &value) && value && value <= UINT32_MAX; run.f_cpu = value; break;
+            case 'c' : ok = sim_energy_parse_cycles(&run.power, optarg); break;
+            case 'b' : run.channel.baud = atoi(optarg); ok = run.channel.baud > 0; break;
+            case 'l' : run.channel.loss = atof(optarg); break;
+            case 'm' : run.miss_rate = atof(optarg); break;
+            case 'a' : all = 1; break;
+            case 's' : run.seed = strtoull(optarg, NULL, 0); break;
+            case 't' : ok = sim_parse_count(optarg, &value) && value; num_threads = value; break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // the shipped settings come first, as the reference for feel
+    uint64_t combinations = 1;
+    uint64_t num_points = 1;
+    for (uint8_t i = 0; i < NUM_PARAMS; i++) {
+        combinations *= counts[i];
+    }
+    run.points = calloc(combinations + 1, sizeof(Point));
+    Point* shipped = &run.points[0];
+    shipped->timing = timing;
+    shipped->shipped = 1;
+    for (uint64_t n = 0; n < combinations; n++) {
+        uint64_t rest = n;
+        uint16_t values[NUM_PARAMS];
+        for (int i = NUM_PARAMS - 1; i >= 0; i--) {
+            values[i] = grid[i][rest % counts[i]];
+            rest /= counts[i];
+        }
+        Timing candidate = {values[PARAM_PACER], values[PARAM_BALL], values[PARAM_DISPLAY_RATE],
+                            values[PARAM_DISPLAY_CYCLES], values[PARAM_MESSAGE]};
+        if (memcmp(&candidate, &shipped->timing, sizeof(Timing))) {
+            run.points[num_points++].timing = candidate;
+        }
+    }
+
+    uint64_t outcomes[NUM_OUTCOMES] = {0};
+    for (uint64_t i = 0; i < num_points; i++) {
+        run.points[i].outcome = screen_point(&run, &run.points[i], tolerance / 100);
+    }
+    Stats total = {0, 0};
+    sim_parallel_for(num_points, num_threads, run_chunk, &run, sizeof(Stats), merge_stats, &total);
+
+    if (shipped->outcome != POINT_SCORED) {
+        fprintf(stderr, "the shipped settings could not be scored, so there is nothing to compare with\n");
+        return 1;
+    }
+    for (uint64_t i = 0; i < num_points; i++) {
+        Point* point = &run.points[i];
+        if (point->outcome == POINT_SCORED) {
+            double serve = change(point->serve_s, shipped->serve_s);
+            double score = change(point->score_s, shipped->score_s);
+            double scroll = change(point->scroll_cps, shipped->scroll_cps);
+            double worst = serve > score ? serve : score;
+            worst = scroll > worst ? scroll : worst;
+            point->feel = 100 * worst;
+            if (worst > tolerance / 100 && !point->shipped) {
+                point->outcome = POINT_FEEL;
+            }
+        }
+        outcomes[point->outcome]++;
+    }
+    for (uint64_t i = 0; i < num_points; i++) {
+        Point* point = &run.points[i];
+        point->pareto = point->outcome == POINT_SCORED;
+        for (uint64_t j = 0; j < num_points && point->pareto; j++) {
+            point->pareto = run.points[j].outcome != POINT_SCORED || !dominates(&run.points[j], point);
+        }
+    }
+
+    printf("%llu combinations at %u Hz, %llu matches each, feel tolerance %g%%\n",
+           (unsigned long long) num_points, run.f_cpu, (unsigned long long) run.games, tolerance);
+    printf("dropped: %llu past a counter's limit, %llu overrun the tick, %llu serve speed, "
+           "%llu score screen or scroll speed, %llu stalled\n",
+           (unsigned long long) outcomes[POINT_LIMIT], (unsigned long long) outcomes[POINT_OVERRUN],
+           (unsigned long long) outcomes[POINT_SERVE], (unsigned long long) outcomes[POINT_FEEL],
+           (unsigned long long) outcomes[POINT_STALLED]);
+    printf("simulated %llu matches, %.0f s of play\n\n", (unsigned long long) total.matches, total.seconds);
+
+    uint64_t front = 0;
+    for (uint64_t i = 0; i < num_points; i++) {
+        front += run.points[i].pareto;
+    }
+    printf("%s (%llu), * the shipped settings:\n", all ? "every combination scored, Pareto set marked +" :
+           "Pareto set", (unsigned long long) front);
+    print_header();
+    for (uint64_t i = 0; i < num_points; i++) {
+        const Point* point = &run.points[i];
+        if (point->shipped) {
+            print_point(point, '*');
+        } else if (all && point->outcome == POINT_SCORED) {
+            print_point(point, point->pareto ? '+' : ' ');
+        } else if (point->pareto) {
+            print_point(point, ' ');
+        }
+    }
+    free(run.points);
+    return 0;
+}
@@ -0,0 +1,457 @@
+/** @file trace_json.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief merge trace dumps from several kits into one Chrome trace-event JSON file on a common timeline
+ */
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tracer.h"
+#include "game.h"
+#include "pong_display.h"
+
+#define MAX_KITS 8
+#define VARINT_MORE 0x80
+#define VARINT_MASK 0x7F
+#define TICK_MASK 0xFFFF
+#define TICK_US (1e6 / PACER_RATE)
+#define IR_SLICE_US 100 //width drawn for an IR event, so flow arrows have something to attach to
+#define MAX_VOTES (1 << 22)
+#define VOTE_WINDOW 30 //ticks either side of a rough offset that a message may take to arrive
+#define TID_MODE 1
+#define TID_IR 2
+#define TID_DISPLAY 3
+
+
+/* Each kit counts pacer ticks from its own power on, so the timelines are
+ * lined up using the messages between them. Every message traced on one kit
+ * as sent and on another as read is a sample of offset + latency in one
+ * direction, or latency - offset in the other. A rough offset comes from the
+ * densest cluster of such differences over every send and read of the same
+ * kind and argument. Messages are then matched one to one near that offset,
+ * and as in NTP the offset is half the difference between the median
+ * samples in the two directions, assuming the link is equally fast both ways.
+ * With messages in one direction only, the latency is taken as zero. Kit 0
+ * sets the timeline and every other kit is aligned to it. */
+
+
+/** One traced event with its full tick */
+typedef struct {
+    uint32_t tick;
+    uint8_t event;
+    uint8_t arg;
+    int32_t peer; //index of the matching send or read on another kit, -1 if none
+    uint8_t peer_kit; //which kit that is
+} Entry;
+
+
+typedef struct {
+    const char* path;
+    Entry* entries;
+    uint32_t count;
+    uint32_t end_tick; //tick at the time of the dump
+    double offset; //ticks to subtract to land on kit 0's timeline
+} Trace;
+
+
+/** A message kind: the event traced when it is sent and the one traced when it is read */
+typedef struct {
+    uint8_t sent;
+    uint8_t read;
+} Message;
+
+
+static const Message messages[] = {
+    {TRACE_TX_START, TRACE_RX_START},
+    {TRACE_TX_BALL, TRACE_RX_BALL},
+    {TRACE_TX_DEAD, TRACE_RX_DEAD},
+    {TRACE_TX_ROUND, TRACE_RX_ROUND},
+    {TRACE_TX_BALLS, TRACE_RX_BALLS}
+};
+#define NUM_MESSAGES (sizeof(messages) / sizeof(messages[0]))
+
+
+static const char* const event_names[TRACE_EVENTS] = {
+    "", "mode", "tx start", "rx start", "tx ball", "rx ball", "tx dead", "rx dead",
+    "tx round", "rx round", "tx balls", "rx balls", "scroll", "frame"
+};
+
+static const char* const arg_names[TRACE_EVENTS] = {
+    "", "mode", "symbol", "symbol", "column", "column", "", "",
+    "digest", "digest", "balls", "balls", "first", "lit"
+};
+
+static const char* const mode_names[] = {
+    "start menu", "paddle", "play", "score", "game over"
+};
+
+
+/** Read a varint from a dump:
+    @param file the dump
+    @param value where to place the value
+    @return 1 on success, 0 if the dump ends early */
+static int read_varint (FILE* file, uint32_t* value)
+{
+    uint8_t shift = 0;
+    int byte;
+    *value = 0;
+    do {
+        if ((byte = fgetc(file)) == EOF || shift > 28) {
+            return 0;
+        }
+        *value |= (uint32_t) (byte & VARINT_MASK) << shift;
+        shift += 7;
+    } while (byte & VARINT_MORE);
+    return 1;
+}
+
+
+/** Load a dump, recovering each entry's full tick by working back from the dump tick:
+    @param trace where to place it, with path set
+    @return 1 on success, else 0 */
+static int load_trace (Trace* trace)
+{
+    FILE* file = fopen(trace->path, "rb");
+    if (!file) {
+        perror(trace->path);
+        return 0;
+    }
+    uint32_t count;
+    int ok = fgetc(file) == TRACE_MAGIC_0 && fgetc(file) == TRACE_MAGIC_1 && fgetc(file) == TRACE_VERSION
+        && read_varint(file, &trace->end_tick) && read_varint(file, &count);
+    trace->entries = calloc(count ? count : 1, sizeof(Entry));
+    trace->count = 0;
+    uint8_t raw[TRACE_ENTRY_LENGTH];
+    for (uint32_t i = 0; ok && i < count; i++) {
+        ok = fread(raw, 1, TRACE_ENTRY_LENGTH, file) == TRACE_ENTRY_LENGTH && raw[2] < TRACE_EVENTS;
+        trace->entries[i].tick = raw[0] | raw[1] << 8;
+        trace->entries[i].event = raw[2];
+        trace->entries[i].arg = raw[3];
+        trace->entries[i].peer = -1;
+    }
+    fclose(file);
+    if (!ok) {
+        fprintf(stderr, "%s: not a valid trace dump\n", trace->path);
+        return 0;
+    }
+    trace->count = count;
+
+    uint32_t tick = trace->end_tick;
+    uint16_t low = tick & TICK_MASK;
+    for (uint32_t i = count; i-- > 0;) {
+        tick -= (uint16_t) (low - trace->entries[i].tick);
+        low = trace->entries[i].tick;
+        trace->entries[i].tick = tick;
+    }
+    return 1;
+}
+
+
+static int compare_longs (const void* a, const void* b)
+{
+    long x = *(const long*) a;
+    long y = *(const long*) b;
+    return (x > y) - (x < y);
+}
+
+
+/** Rough offset + latency from one kit to another: the centre of the densest cluster of
+    read tick minus sent tick over every send and read of the same kind and argument:
+    @param from kit sending
+    @param to kit reading
+    @param estimate where to place the estimate
+    @return number of samples in the cluster, 0 if there were none */
+static uint32_t vote (const Trace* from, const Trace* to, long* estimate)
+{
+    long* votes = malloc(MAX_VOTES * sizeof(long));
+    uint32_t num_votes = 0;
+    for (uint32_t r = 0; r < to->count && num_votes < MAX_VOTES; r++) {
+        for (uint32_t m = 0; m < NUM_MESSAGES; m++) {
+            if (to->entries[r].event != messages[m].read) {
+                continue;
+            }
+            for (uint32_t s = 0; s < from->count && num_votes < MAX_VOTES; s++) {
+                if (from->entries[s].event == messages[m].sent && from->entries[s].arg == to->entries[r].arg) {
+                    votes[num_votes++] = (long) to->entries[r].tick - from->entries[s].tick;
+                }
+            }
+        }
+    }
+    qsort(votes, num_votes, sizeof(long), compare_longs);
+
+    uint32_t best = 0;
+    uint32_t first = 0;
+    for (uint32_t last = 0; last < num_votes; last++) {
+        while (votes[last] - votes[first] > 2 * VOTE_WINDOW) {
+            first++;
+        }
+        if (last - first + 1 > best) {
+            best = last - first + 1;
+            *estimate = votes[first + (last - first) / 2];
+        }
+    }
+    free(votes);
+    return best;
+}
+
+
+/** Match each unmatched read on one kit to the latest unmatched send of the same kind and
+    argument on another, near a rough offset, and collect read tick minus sent tick:
+    @param traces every kit
+    @param from_kit index of the kit sending
+    @param to_kit index of the kit reading
+    @param rough offset + latency from vote
+    @param samples where to place one sample per match
+    @return number of matches */
+static uint32_t match (Trace traces[], uint8_t from_kit, uint8_t to_kit, long rough, long samples[])
+{
+    Trace* from = &traces[from_kit];
+    Trace* to = &traces[to_kit];
+    uint32_t matched = 0;
+    for (uint32_t r = 0; r < to->count; r++) {
+        Entry* read = &to->entries[r];
+        for (uint32_t m = 0; m < NUM_MESSAGES; m++) {
+            if (read->event != messages[m].read || read->peer >= 0) {
+                continue;
+            }
+            int32_t best = -1;
+            for (uint32_t s = 0; s < from->count; s++) {
+                Entry* sent = &from->entries[s];
+                long delay = (long) read->tick - sent->tick;
+                if (delay < rough - VOTE_WINDOW) {
+                    break; //sends are in tick order, the rest are later still
+                }
+                if (sent->event == messages[m].sent && sent->arg == read->arg && sent->peer < 0
+                    && delay >= rough - VOTE_WINDOW && delay <= rough + VOTE_WINDOW) {
+                    best = s; //sends are in order, so the last one found is the latest
+                }
+            }
+            if (best >= 0) {
+                from->entries[best].peer = r;
+                from->entries[best].peer_kit = to_kit;
+                read->peer = best;
+                read->peer_kit = from_kit;
+                samples[matched++] = (long) read->tick - from->entries[best].tick;
+            }
+        }
+    }
+    return matched;
+}
+
+
+/** Median of some samples, which are sorted in place:
+    @param samples the samples
+    @param count how many, at least 1 */
+static double median (long samples[], uint32_t count)
+{
+    qsort(samples, count, sizeof(long), compare_longs);
+    return count % 2 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2.0;
+}
+
+
+/** Line a kit's timeline up with kit 0, printing how well it went:
+    @param traces every kit
+    @param kit index of the kit to align
+    @param shared 1 if the kits share a clock, so messages are matched but the offset stays 0 */
+static void align (Trace traces[], uint8_t kit, int shared)
+{
+    Trace* base = &traces[0];
+    Trace* trace = &traces[kit];
+    long forward_rough = 0;
+    long back_rough = 0;
+    uint32_t forward_votes = vote(base, trace, &forward_rough);
+    uint32_t back_votes = vote(trace, base, &back_rough);
+    long* forward = malloc((trace->count + 1) * sizeof(long));
+    long* back = malloc((base->count + 1) * sizeof(long));
+    uint32_t num_forward = forward_votes ? match(traces, 0, kit, forward_rough, forward) : 0;
+    uint32_t num_back = back_votes ? match(traces, kit, 0, back_rough, back) : 0;
+
+    if (shared) {
+        printf("%s: shares a clock with %s, %u + %u messages matched\n",
+               trace->path, base->path, num_forward, num_back);
+    } else if (num_forward && num_back) {
+        double out = median(forward, num_forward); //offset + latency
+        double in = median(back, num_back); //latency - offset
+        trace->offset = (out - in) / 2;
+        printf("%s: %+.1f ticks from %s, %u + %u messages matched, one-way latency %.1f ticks\n",
+               trace->path, trace->offset, base->path, num_forward, num_back, (out + in) / 2);
+    } else if (num_forward || num_back) {
+        trace->offset = num_forward ? median(forward, num_forward) : -median(back, num_back);
+        printf("%s: %+.1f ticks from %s, %u messages matched one way only, latency taken as 0\n",
+               trace->path, trace->offset, base->path, num_forward + num_back);
+    } else {
+        trace->offset = 0;
+        printf("%s: no messages in common with %s, not aligned\n", trace->path, base->path);
+    }
+    free(forward);
+    free(back);
+}
+
+
+/** Time of a tick on the common timeline in microseconds:
+    @param trace the kit
+    @param tick tick on the kit's own clock
+    @param order position among the kit's entries on that tick, to keep them apart */
+static double timestamp (const Trace* trace, uint32_t tick, uint32_t order)
+{
+    return (tick - trace->offset) * TICK_US + order;
+}
+
+
+/** Write one kit's events:
+    @param out JSON being written
+    @param traces every kit, for flow arrows to the kit a message went to
+    @param kit index of the kit to write
+    @param first 1 until the first event has been written, updated */
+static void write_kit (FILE* out, const Trace traces[], uint8_t kit, int* first)
+{
+    const Trace* trace = &traces[kit];
+    const char* threads[] = {"", "mode", "IR", "display"};
+    int pid = kit + 1;
+
+    fprintf(out, "%s{\"ph\":\"M\",\"pid\":%d,\"name\":\"process_name\",\"args\":{\"name\":\"kit %u (%s)\"}}",
+            *first ? "" : ",\n", pid, kit, trace->path);
+    *first = 0;
+    for (int tid = TID_MODE; tid <= TID_DISPLAY; tid++) {
+        fprintf(out, ",\n{\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+                pid, tid, threads[tid]);
+    }
+
+    uint32_t order = 0;
+    int32_t mode = -1;
+    double mode_start = 0;
+    for (uint32_t i = 0; i < trace->count; i++) {
+        const Entry* entry = &trace->entries[i];
+        order = i && entry->tick == trace->entries[i - 1].tick ? order + 1 : 0;
+        double ts = timestamp(trace, entry->tick, order);
+        const char* name = event_names[entry->event];
+
+        if (entry->event == TRACE_MODE) {
+            // each mode is a slice lasting until the next mode change
+            if (mode >= 0) {
+                fprintf(out, ",\n{\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"name\":\"%s\",\"ts\":%.1f,\"dur\":%.1f}",
+                        pid, TID_MODE, mode_names[mode], mode_start, ts - mode_start);
+            }
+            mode = entry->arg <= GAME_OVER_MODE ? entry->arg : -1;
+            mode_start = ts;
+        } else if (entry->event == TRACE_FRAME) {
+            fprintf(out, ",\n{\"ph\":\"C\",\"pid\":%d,\"tid\":%d,\"name\":\"lit LEDs\",\"ts\":%.1f,\"args\":{\"lit\":%u}}",
+                    pid, TID_DISPLAY, ts, entry->arg);
+        } else if (entry->event == TRACE_SCROLL) {
+            fprintf(out, ",\n{\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"name\":\"scroll\",\"ts\":%.1f,\"args\":{\"first\":\"%c\"}}",
+                    pid, TID_DISPLAY, ts, entry->arg >= ' ' && entry->arg < 0x7F && entry->arg != '"' && entry->arg != '\\' ? entry->arg : '?');
+        } else {
+            fprintf(out, ",\n{\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"name\":\"%s\",\"ts\":%.1f,\"dur\":%d,\"args\":{\"tick\":%u",
+                    pid, TID_IR, name, ts, IR_SLICE_US, entry->tick);
+            if (arg_names[entry->event][0]) {
+                fprintf(out, ",\"%s\":%u", arg_names[entry->event], entry->arg);
+            }
+            fprintf(out, "}}");
+        }
+    }
+    if (mode >= 0) {
+        double end = timestamp(trace, trace->end_tick, 0);
+        fprintf(out, ",\n{\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"name\":\"%s\",\"ts\":%.1f,\"dur\":%.1f}",
+                pid, TID_MODE, mode_names[mode], mode_start, end - mode_start);
+    }
+}
+
+
+/** Write an arrow from each matched send to its read:
+    @param out JSON being written
+    @param traces every kit
+    @param num_kits number of kits */
+static void write_flows (FILE* out, const Trace traces[], uint8_t num_kits)
+{
+    uint32_t id = 0;
+    for (uint8_t from = 0; from < num_kits; from++) {
+        for (uint32_t i = 0; i < traces[from].count; i++) {
+            const Entry* sent = &traces[from].entries[i];
+            uint8_t is_send = 0;
+            for (uint32_t m = 0; m < NUM_MESSAGES; m++) {
+                is_send |= sent->event == messages[m].sent;
+            }
+            if (!is_send || sent->peer < 0) {
+                continue;
+            }
+            const Trace* reader = &traces[sent->peer_kit];
+            fprintf(out, ",\n{\"ph\":\"s\",\"id\":%u,\"pid\":%d,\"tid\":%d,\"name\":\"message\",\"cat\":\"ir\",\"ts\":%.1f}",
+                    id, from + 1, TID_IR, timestamp(&traces[from], sent->tick, 0));
+            fprintf(out, ",\n{\"ph\":\"f\",\"bp\":\"e\",\"id\":%u,\"pid\":%d,\"tid\":%d,\"name\":\"message\",\"cat\":\"ir\",\"ts\":%.1f}",
+                    id, sent->peer_kit + 1, TID_IR, timestamp(reader, reader->entries[sent->peer].tick, 0));
+            id++;
+        }
+    }
+}
+
+
+static void usage (const char* program)
+{
+    fprintf(stderr,
+        "usage: %s [options] trace...\n"
+        "  each trace is a dump from one kit (make TRACE=1, push south on the game over screen)\n"
+        "  or from replay -t; open the output in chrome://tracing or ui.perfetto.dev\n"
+        "  -o file     JSON to write (default trace.json)\n"
+        "  -n          keep every kit's own ticks, for kits that share a clock such as simulated ones\n",
+        program);
+}
+
+
+int main (int argc, char* argv[])
+{
+    const char* out_path = "trace.json";
+    int aligned = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:nh")) != -1) {
+        switch (opt) {
+            case 'o' : out_path = optarg; break;
+            case 'n' : aligned = 0; break;
+            default :
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    int num_kits = argc - optind;
+    if (num_kits < 1 || num_kits > MAX_KITS) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Trace traces[MAX_KITS];
+    for (int kit = 0; kit < num_kits; kit++) {
+        traces[kit].path = argv[optind + kit];
+        traces[kit].offset = 0;
+        if (!load_trace(&traces[kit])) {
+            return 1;
+        }
+        printf("%s: %u events over ticks %u to %u\n", traces[kit].path, traces[kit].count,
+               traces[kit].count ? traces[kit].entries[0].tick : traces[kit].end_tick, traces[kit].end_tick);
+    }
+    for (int kit = 1; kit < num_kits; kit++) {
+        align(traces, kit, !aligned);
+    }
+
+    FILE* out = fopen(out_path, "w");
+    if (!out) {
+        perror(out_path);
+        return 1;
+    }
+    int first = 1;
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (int kit = 0; kit < num_kits; kit++) {
+        write_kit(out, traces, kit, &first);
+    }
+    write_flows(out, traces, num_kits);
+    fprintf(out, "\n]}\n");
+    fclose(out);
+    printf("wrote %s\n", out_path);
+
+    for (int kit = 0; kit < num_kits; kit++) {
+        free(traces[kit].entries);
+    }
+    return 0;
+}
@@ -0,0 +1,167 @@
+/** @file stats_log.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief match statistics kept across power cycles in a wear-levelled log in EEPROM
+ */
+
+
+#include "stats_log.h"
+#include "eeprom_async.h"
+
+#define CRC_INITIAL 0xFFFF
+#define CRC_POLYNOMIAL 0x1021
+#define CRC_OFFSET (STATS_RECORD_SIZE - 2)
+#define MAX_RALLY 0xFF
+
+
+/** Write a 16 bit field little endian:
+    @param record record being packed
+    @param offset position of the low byte
+    @param value field value */
+static void put_word (uint8_t record[], uint8_t offset, uint16_t value)
+{
+    record[offset] = value & 0xFF;
+    record[offset + 1] = value >> 8;
+}
+
+
+/** Read a 16 bit field stored little endian:
+    @param record record being unpacked
+    @param offset position of the low byte
+    @return field value */
+static uint16_t get_word (const uint8_t record[], uint8_t offset)
+{
+    return record[offset] | (uint16_t) record[offset + 1] << 8;
+}
+
+
+/** CRC-16/CCITT, polynomial 0x1021 starting from 0xFFFF:
+    @param data bytes to check
+    @param length number of bytes
+    @return the CRC */
+uint16_t stats_log_crc (const uint8_t data[], uint8_t length)
+{
+    uint16_t crc = CRC_INITIAL;
+    for (uint8_t i = 0; i < length; i++) {
+        crc ^= (uint16_t) data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = crc & 0x8000 ? crc << 1 ^ CRC_POLYNOMIAL : crc << 1;
+        }
+    }
+    return crc;
+}
+
+
+/** Lay out the totals as a record, CRC included:
+    @param log pointer to the log
+    @param record where to place STATS_RECORD_SIZE bytes */
+void stats_log_pack (const StatsLog* log, uint8_t record[])
+{
+    record[0] = STATS_MAGIC;
+    put_word(record, 1, log->seq);
+    put_word(record, 3, log->wins);
+    put_word(record, 5, log->losses);
+    put_word(record, 7, log->rallies);
+    put_word(record, 9, log->returns);
+    record[11] = log->longest_rally;
+    put_word(record, 12, log->link_errors);
+    put_word(record, CRC_OFFSET, stats_log_crc(record, CRC_OFFSET));
+}
+
+
+/** Take the totals from a record if it is valid:
+    @param log pointer to the log, unchanged if the record is not valid
+    @param record STATS_RECORD_SIZE bytes read from a slot
+    @return 1 if the record has the magic byte and a matching CRC, else 0 */
+uint8_t stats_log_unpack (StatsLog* log, const uint8_t record[])
+{
+    if (record[0] != STATS_MAGIC || get_word(record, CRC_OFFSET) != stats_log_crc(record, CRC_OFFSET)) {
+        return 0;
+    }
+    log->seq = get_word(record, 1);
+    log->wins = get_word(record, 3);
+    log->losses = get_word(record, 5);
+    log->rallies = get_word(record, 7);
+    log->returns = get_word(record, 9);
+    log->longest_rally = record[11];
+    log->link_errors = get_word(record, 12);
+    return 1;
+}
+
+
+/** Load the totals from the newest valid record in EEPROM, or start from zero:
+    @param log pointer to the log */
+void stats_log_init (StatsLog* log)
+{
+    StatsLog candidate;
+    uint8_t record[STATS_RECORD_SIZE];
+
+    log->seq = 0;
+    log->wins = 0;
+    log->losses = 0;
+    log->rallies = 0;
+    log->returns = 0;
+    log->longest_rally = 0;
+    log->link_errors = 0;
+    log->slot = STATS_NO_SLOT;
+    log->rally_returns = 0;
+
+    eeprom_async_init();
+    for (uint8_t slot = 0; slot < STATS_SLOTS; slot++) {
+        eeprom_async_read(STATS_BASE + slot * STATS_RECORD_SIZE, record, STATS_RECORD_SIZE);
+        if (!stats_log_unpack(&candidate, record)) {
+            continue;
+        }
+        //sequence numbers wrap, so newer means ahead by less than half the range
+        if (log->slot == STATS_NO_SLOT || (int16_t) (candidate.seq - log->seq) > 0) {
+            candidate.slot = slot;
+            candidate.rally_returns = 0;
+            *log = candidate;
+        }
+    }
+}
+
+
+/** Count a paddle return in the current rally:
+    @param log pointer to the log */
+void stats_log_return (StatsLog* log)
+{
+    if (log->rally_returns < MAX_RALLY) {
+        log->rally_returns++;
+    }
+}
+
+
+/** Count the end of a rally, keeping the longest:
+    @param log pointer to the log */
+void stats_log_rally_over (StatsLog* log)
+{
+    log->rallies++;
+    log->returns += log->rally_returns;
+    if (log->rally_returns > log->longest_rally) {
+        log->longest_rally = log->rally_returns;
+    }
+    log->rally_returns = 0;
+}
+
+
+/** Count a finished game and append the new totals to the log:
+    @param log pointer to the log
+    @param won 1 if this kit won
+    @param link_errors link errors seen during the game */
+void stats_log_game_over (StatsLog* log, uint8_t won, uint16_t link_errors)
+{
+    uint8_t record[STATS_RECORD_SIZE];
+
+    if (won) {
+        log->wins++;
+    } else {
+        log->losses++;
+    }
+    log->link_errors += link_errors;
+    log->seq++;
+    log->slot = log->slot + 1 < STATS_SLOTS ? log->slot + 1 : 0; //STATS_NO_SLOT wraps to slot 0 too
+    stats_log_pack(log, record);
+    //a game takes far longer than a record's 16 byte writes, so the queue is never full
+    eeprom_async_write(STATS_BASE + log->slot * STATS_RECORD_SIZE, record, STATS_RECORD_SIZE);
+}
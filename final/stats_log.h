@@ -0,0 +1,95 @@
+/** @file stats_log.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief match statistics kept across power cycles in a wear-levelled log in EEPROM
+ */
+
+
+#ifndef STATS_LOG_H
+#define STATS_LOG_H
+
+#include "system.h"
+
+#define STATS_RECORD_SIZE 16
+#define STATS_SLOTS 64 //records in the log, filling all of EEPROM
+#define STATS_BASE 0 //EEPROM address of the first slot
+#define STATS_MAGIC 0xA5 //first byte of every record, erased EEPROM reads 0xFF
+#define STATS_NO_SLOT 0xFF //slot of the newest record when the log is empty
+
+
+/* Rather than rewriting one set of counters, each finished game appends a
+ * whole record holding the running totals to the next slot, wrapping round,
+ * so every cell takes one write per STATS_SLOTS games and the 100,000 cycle
+ * endurance lasts for over six million games. Records carry a sequence
+ * number and a CRC, so a write cut short by a power loss leaves a record
+ * that fails its check and the one before it is used instead.
+ *
+ * Record layout, multi-byte fields little endian:
+ *   0      STATS_MAGIC
+ *   1-2    sequence number, one more than the record before it
+ *   3-4    games won
+ *   5-6    games lost
+ *   7-8    rallies played
+ *   9-10   paddle returns over all rallies
+ *   11     longest rally, in returns
+ *   12-13  link errors: resyncs, gaps and duplicates seen in ring mode
+ *   14-15  CRC-16/CCITT of bytes 0-13 */
+
+
+/** Running totals, and where the next record goes */
+typedef struct stats_log_s {
+    uint16_t seq; //sequence number of the newest record
+    uint16_t wins;
+    uint16_t losses;
+    uint16_t rallies;
+    uint16_t returns;
+    uint8_t longest_rally;
+    uint16_t link_errors;
+    uint8_t slot; //slot holding the newest record, STATS_NO_SLOT if none
+    uint8_t rally_returns; //returns so far in the current rally
+} StatsLog;
+
+
+/** Load the totals from the newest valid record in EEPROM, or start from zero:
+    @param log pointer to the log */
+void stats_log_init (StatsLog* log);
+
+
+/** Count a paddle return in the current rally:
+    @param log pointer to the log */
+void stats_log_return (StatsLog* log);
+
+
+/** Count the end of a rally, keeping the longest:
+    @param log pointer to the log */
+void stats_log_rally_over (StatsLog* log);
+
+
+/** Count a finished game and append the new totals to the log:
+    @param log pointer to the log
+    @param won 1 if this kit won
+    @param link_errors link errors seen during the game */
+void stats_log_game_over (StatsLog* log, uint8_t won, uint16_t link_errors);
+
+
+/** Lay out the totals as a record, CRC included:
+    @param log pointer to the log
+    @param record where to place STATS_RECORD_SIZE bytes */
+void stats_log_pack (const StatsLog* log, uint8_t record[]);
+
+
+/** Take the totals from a record if it is valid:
+    @param log pointer to the log, unchanged if the record is not valid
+    @param record STATS_RECORD_SIZE bytes read from a slot
+    @return 1 if the record has the magic byte and a matching CRC, else 0 */
+uint8_t stats_log_unpack (StatsLog* log, const uint8_t record[]);
+
+
+/** CRC-16/CCITT, polynomial 0x1021 starting from 0xFFFF:
+    @param data bytes to check
+    @param length number of bytes
+    @return the CRC */
+uint16_t stats_log_crc (const uint8_t data[], uint8_t length);
+
+
+#endif
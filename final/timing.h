@@ -0,0 +1,62 @@
+/** @file timing.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief timing constants of the game, kept together so they can be tuned together
+ */
+
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include "system.h"
+
+#define TIMING_PACER_RATE 600 //main loop passes per second, the display shows one column on each
+#define TIMING_BALL_RATE 100 //pacer ticks a served ball waits before each step, at most 254
+#define TIMING_DISPLAY_RATE 250 //ticks the score shows before display cycles are counted, at most 254
+#define TIMING_DISPLAY_CYCLES 10 //display cycles counted before play resumes, at most 254
+#define TIMING_MESSAGE_RATE 10 //scrolling text speed in characters per 10 seconds
+
+
+/* Everything but MESSAGE_RATE is counted in pacer ticks, so changing
+ * PACER_RATE changes how fast the ball moves and how long the score shows.
+ * The counters these are compared with are 8 bits, hence the limits.
+ *
+ * The simulator builds with TIMING_STORAGE set, which reads them from a
+ * thread-local Timing instead. sim/timing_tune.c can then run kits at
+ * other settings without a rebuild, and pick the settings worth putting
+ * here. */
+
+
+#ifdef TIMING_STORAGE
+
+/** Timing constants as variables, for the simulator */
+typedef struct {
+    uint16_t pacer_rate;
+    uint16_t ball_rate;
+    uint16_t display_rate;
+    uint16_t display_cycles;
+    uint16_t message_rate;
+} Timing;
+
+
+/** Settings the current thread's kits run with, see sim/sim_timing.c */
+extern TIMING_STORAGE Timing timing;
+
+#define PACER_RATE (timing.pacer_rate)
+#define BALL_RATE (timing.ball_rate)
+#define DISPLAY_RATE (timing.display_rate)
+#define DISPLAY_CYCLES (timing.display_cycles)
+#define MESSAGE_RATE (timing.message_rate)
+
+#else
+
+#define PACER_RATE TIMING_PACER_RATE
+#define BALL_RATE TIMING_BALL_RATE
+#define DISPLAY_RATE TIMING_DISPLAY_RATE
+#define DISPLAY_CYCLES TIMING_DISPLAY_CYCLES
+#define MESSAGE_RATE TIMING_MESSAGE_RATE
+
+#endif
+
+
+#endif
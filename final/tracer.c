@@ -0,0 +1,86 @@
+/** @file tracer.c
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief trace mode: timestamped tracepoints in a RAM ring, for timelines of both kits on a PC
+ */
+
+
+#include "tracer.h"
+
+#ifdef TRACE
+
+#define VARINT_MORE 0x80
+#define VARINT_MASK 0x7F
+
+
+static Tracer tracer_state;
+TRACE_POINTER_STORAGE Tracer* tracer = &tracer_state;
+
+
+/** Clear the ring and restart the tick count */
+void trace_init (void)
+{
+    tracer->head = 0;
+    tracer->count = 0;
+    tracer->tick = 0;
+}
+
+
+/** Count one pass of the main loop */
+void trace_tick (void)
+{
+    tracer->tick++;
+}
+
+
+/** Add an entry for the current tick:
+    @param event one of the TRACE_* event ids
+    @param arg one byte of detail */
+void trace_event (uint8_t event, uint8_t arg)
+{
+    uint16_t head = tracer->head;
+    TraceEntry* entry = &tracer->entries[head];
+    entry->tick = tracer->tick;
+    entry->event = event;
+    entry->arg = arg;
+    tracer->head = head + 1 < TRACE_BUFFER_SIZE ? head + 1 : 0;
+    if (tracer->count < TRACE_BUFFER_SIZE) {
+        tracer->count++;
+    }
+}
+
+
+/** Write a varint to a dump:
+    @param write function called with each byte
+    @param value value to write */
+static void dump_varint (void (*write) (char), uint32_t value)
+{
+    while (value > VARINT_MASK) {
+        write((value & VARINT_MASK) | VARINT_MORE);
+        value >>= 7;
+    }
+    write(value);
+}
+
+
+/** Write the ring out as a dump, oldest entry first:
+    @param write function called with each byte of the dump */
+void trace_dump (void (*write) (char))
+{
+    uint16_t index = tracer->count < TRACE_BUFFER_SIZE ? 0 : tracer->head;
+    write(TRACE_MAGIC_0);
+    write(TRACE_MAGIC_1);
+    write(TRACE_VERSION);
+    dump_varint(write, tracer->tick);
+    dump_varint(write, tracer->count);
+    for (uint16_t i = 0; i < tracer->count; i++) {
+        const TraceEntry* entry = &tracer->entries[index];
+        write(entry->tick & 0xFF);
+        write(entry->tick >> 8);
+        write(entry->event);
+        write(entry->arg);
+        index = index + 1 < TRACE_BUFFER_SIZE ? index + 1 : 0;
+    }
+}
+
+#endif
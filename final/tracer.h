@@ -0,0 +1,118 @@
+/** @file tracer.h
+ * @author Emma Hogan, Tom Rizzi
+ * @date 19 October 2026
+ * @brief trace mode: timestamped tracepoints in a RAM ring, for timelines of both kits on a PC
+ */
+
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include "system.h"
+
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 64 //entries kept, 4 bytes of SRAM each
+#endif
+
+#define TRACE_MAGIC_0 'P'
+#define TRACE_MAGIC_1 'T'
+#define TRACE_VERSION 1
+#define TRACE_ENTRY_LENGTH 4
+#define TRACE_LEVEL_DISPLAY 2 //make TRACE=2 adds a tracepoint per display frame
+
+#ifndef TRACE_POINTER_STORAGE
+#define TRACE_POINTER_STORAGE //the simulator makes the pointer thread local, its kits run on several threads
+#endif
+
+#define TRACE_MODE 1 //new game mode
+#define TRACE_TX_START 2 //inform_start, arg the start symbol
+#define TRACE_RX_START 3 //start symbol read on the start menu or paddle screen
+#define TRACE_TX_BALL 4 //transmit_ball, arg the column sent
+#define TRACE_RX_BALL 5 //receive_ball placed a ball, arg its column
+#define TRACE_TX_DEAD 6 //dead ball message sent
+#define TRACE_RX_DEAD 7 //dead ball message read
+#define TRACE_TX_ROUND 8 //round start sent, arg the digest
+#define TRACE_RX_ROUND 9 //round start digest read, arg the digest
+#define TRACE_TX_BALLS 10 //multi-ball frame sent, arg the number of balls
+#define TRACE_RX_BALLS 11 //multi-ball frame read, arg the number of balls
+#define TRACE_SCROLL 12 //scroll_text, arg the first character
+#define TRACE_FRAME 13 //update_display finished a frame, arg the lit LEDs
+#define TRACE_EVENTS 14
+
+
+/* Each tracepoint writes the low 16 bits of the pacer tick, an event id and
+ * one argument byte into a ring of TRACE_BUFFER_SIZE entries, overwriting the
+ * oldest. An entry is written in full before the head moves past it, and
+ * nothing is ever locked or disabled, so a tracepoint costs a few dozen
+ * cycles. Only the main loop writes to the ring.
+ *
+ * A dump is "PT", TRACE_VERSION, the varint tick at the time of the dump,
+ * the varint number of entries, then the entries oldest first, each the tick
+ * (little endian), the event id and the argument. The full tick of each entry
+ * is recovered working back from the dump tick, so the ring must be dumped
+ * less than 65536 ticks (109 s) after its newest entry.
+ *
+ * Tracing is compiled in with -DTRACE (make TRACE=1), or make TRACE=2 for
+ * display frames as well. Without it every TRACE_* macro expands to
+ * nothing. sim/trace_json.c merges the dumps from several kits into one
+ * Chrome trace. */
+
+
+/** One tracepoint hit */
+typedef struct {
+    uint16_t tick; //low 16 bits of the pacer tick
+    uint8_t event;
+    uint8_t arg;
+} TraceEntry;
+
+
+/** Trace state. The firmware has exactly one of these, the simulator gives one to each kit */
+typedef struct {
+    TraceEntry entries[TRACE_BUFFER_SIZE];
+    uint16_t head; //next entry to write
+    uint16_t count; //entries in use
+    uint32_t tick; //pacer ticks (main loop passes) since tracing started
+} Tracer;
+
+
+/** The ring tracepoints are written to */
+extern TRACE_POINTER_STORAGE Tracer* tracer;
+
+
+/** Clear the ring and restart the tick count */
+void trace_init (void);
+
+
+/** Count one pass of the main loop */
+void trace_tick (void);
+
+
+/** Add an entry for the current tick:
+    @param event one of the TRACE_* event ids
+    @param arg one byte of detail */
+void trace_event (uint8_t event, uint8_t arg);
+
+
+/** Write the ring out as a dump, oldest entry first:
+    @param write function called with each byte of the dump */
+void trace_dump (void (*write) (char));
+
+
+#ifdef TRACE
+#define TRACE_INIT() trace_init()
+#define TRACE_TICK() trace_tick()
+#define TRACE_EVENT(event, arg) trace_event((event), (arg))
+#if TRACE >= TRACE_LEVEL_DISPLAY
+#define TRACE_DISPLAY(event, arg) trace_event((event), (arg))
+#else
+#define TRACE_DISPLAY(event, arg)
+#endif
+#else
+#define TRACE_INIT()
+#define TRACE_TICK()
+#define TRACE_EVENT(event, arg)
+#define TRACE_DISPLAY(event, arg)
+#endif
+
+
+#endif